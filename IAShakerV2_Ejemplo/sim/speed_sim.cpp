@@ -0,0 +1,200 @@
+// ============================
+// Simulación del lazo de velocidad en el host
+// ============================
+// Planta: FastAccelStepper (latencia de cola, periodo de paso entero a
+// 16 MHz y rampa a aceleración fija) y los pasos contados como los cuenta el
+// PCNT. El estimador (RpmEstimator), la referencia (SCurveProfile) y el lazo
+// (SpeedLoop, SpeedPi, StepTuner) son los mismos ficheros del firmware.
+// La RPM "real" es la de los pasos emitidos con SPR_MEAS: el lazo corrige el
+// comando (SPR_CMD, cuantización del driver), no un SPR_MEAS mal calibrado.
+//
+//   pio run -e sim && .pio/build/sim/program                 resumen de escenarios
+//   .pio/build/sim/program --trace closed-tuned > traza.csv  t, ref, cmd, medida, real
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/motor_calibration.h"
+#include "../src/motion_profile.h"
+#include "../src/rpm_estimator.h"
+#include "../src/speed_controller.h"
+
+#define SIM_DT_US          100     // paso de integración de la planta
+#define DRIVER_LATENCY_MS  10      // lo que tarda un cambio de velocidad en salir de la cola del driver
+#define DRIVER_TICK_HZ     16000000.0 // reloj del periodo de paso de FastAccelStepper
+#define SETTLE_BAND        0.02f   // banda de establecimiento: ±2 % de la consigna...
+#define SETTLE_BAND_MIN    1.0f    // ...y al menos ±1 RPM
+
+// Driver: la velocidad sigue al último comando con rampa lineal
+struct Plant {
+  double accel;              // steps/s² del driver
+  double vDrv = 0.0, pos = 0.0;
+  double pending = 0.0, applied = 0.0;
+  uint32_t pendingAt = 0;
+
+  void command(double sps, uint32_t nowUs) {
+    // El driver genera un periodo entero de ticks: la velocidad real se redondea
+    pending = sps > 0.0 ? DRIVER_TICK_HZ / floor(DRIVER_TICK_HZ / sps + 0.5) : 0.0;
+    pendingAt = nowUs + DRIVER_LATENCY_MS * 1000u;
+  }
+
+  void advance(uint32_t nowUs) {
+    if ((int32_t)(nowUs - pendingAt) >= 0) applied = pending;
+    double dv = accel * SIM_DT_US * 1e-6;
+    if (vDrv < applied) vDrv = fmin(vDrv + dv, applied);
+    else if (vDrv > applied) vDrv = fmax(vDrv - dv, applied);
+    pos += vDrv * SIM_DT_US * 1e-6;
+  }
+  int32_t count() const { return (int32_t)floor(pos); }
+  double trueRpm() const { return vDrv / SPR_MEAS * 60.0; }
+};
+
+struct Scenario {
+  const char *name;
+  bool closed;
+  bool tune;           // autoajuste a la primera consigna antes del escalón
+  bool scurve;
+  float accel, jerk;   // rampas de la consigna, RPM/s y RPM/s²
+  float from, to;      // consigna inicial (ya establecida) y la del escalón medido
+};
+
+struct Result {
+  float kp, ki;
+  float overshoot;     // % del escalón
+  float settling;      // s desde el cambio de consigna, <0: no se establece
+  float steadyError;   // RPM reales - consigna, media del último segundo
+  float jitter;
+  bool tuned;
+};
+
+static float metricRpm(const Plant &plant) { return (float)plant.trueRpm(); }
+
+// Lazo abierto como motorTask: la rampa la hace el driver a maxAccel
+// (el perfil S se aproxima por tramos igual que en el firmware)
+static double openLoopSps(const SCurveProfile &profile, float t) { return rpm2sps(profile.velocity(t)); }
+
+static Result run(const Scenario &sc, FILE *trace) {
+  Plant plant;
+  plant.accel = rpm2sps(sc.closed ? SPEED_LOOP_ACCEL : sc.accel);
+  RpmEstimator estimator(SPR_MEAS);
+  SpeedLoop loop;
+  SCurveProfile openRef;
+
+  uint32_t now = 0, nextSample = 0, nextLoop = 0;
+  float target = sc.from;
+  float jerk = sc.scurve ? sc.jerk : 0.0f;
+
+  // Fase previa: arrancar hasta `from` (y autoajustar allí si toca) sin medir
+  bool stepped = false, tuningStarted = false;
+  uint32_t stepAt = 0, preEnd = 30u * 1000000u, end = 0;
+  float peak = -1e9f, trough = 1e9f;
+  uint32_t lastOutside = 0;
+  double errSum = 0.0; int errN = 0;
+  float jitterSum = 0.0f; int jitterN = 0;
+
+  estimator.reset(0, 0);
+  if (sc.closed) loop.reset(0.0f);
+  else openRef.plan(0.0f, target, sc.accel, jerk > 0.0f ? jerk : SPEED_LINEAR_JERK);
+  uint32_t refStart = 0;
+
+  while (!end || now < end) {
+    if (!stepped && now >= preEnd && (!loop.tuner().active())) {
+      stepped = true; stepAt = now; end = now + 20u * 1000000u;
+      target = sc.to;
+      if (!sc.closed) {
+        float t = (now - refStart) * 1e-6f;
+        openRef.plan(openRef.velocity(t), target, sc.accel, jerk > 0.0f ? jerk : SPEED_LINEAR_JERK, openRef.acceleration(t));
+        refStart = now;
+      }
+    }
+
+    if (now == nextSample) {
+      nextSample += RPM_SAMPLE_MS * 1000u;
+      estimator.push(plant.count(), now);
+    }
+    if (now == nextLoop) {
+      nextLoop += SPEED_LOOP_MS * 1000u;
+      float measured = estimator.reading().rpm;
+      double sps;
+      if (sc.closed) {
+        if (sc.tune && !tuningStarted && !stepped && now > 15u * 1000000u) tuningStarted = loop.startTuning(MAX_RPM);
+        float cmd = loop.step(target, measured, sc.accel, jerk);
+        sps = rpm2sps(cmd < 0.0f ? 0.0f : cmd);
+        if (trace) fprintf(trace, "%.3f,%.2f,%.2f,%.2f,%.2f\n", now * 1e-6, loop.reference(), cmd, measured, metricRpm(plant));
+      } else {
+        sps = openLoopSps(openRef, (now - refStart) * 1e-6f);
+        if (trace) fprintf(trace, "%.3f,%.2f,%.2f,%.2f,%.2f\n", now * 1e-6, openRef.velocity((now - refStart) * 1e-6f),
+                           (float)(sps * 60.0 / SPR_CMD), measured, metricRpm(plant));
+      }
+      plant.command(sps, now);
+
+      if (stepped) {
+        float rpm = metricRpm(plant);
+        float band = fmaxf(SETTLE_BAND * target, SETTLE_BAND_MIN);
+        if (fabsf(rpm - target) > band) lastOutside = now;
+        if (rpm > peak) peak = rpm;
+        if (rpm < trough) trough = rpm;
+        if (now + 1000000u >= end) {
+          errSum += rpm - target; errN++;
+          jitterSum += estimator.reading().jitter; jitterN++;
+        }
+      }
+    }
+
+    now += SIM_DT_US;
+    plant.advance(now);
+  }
+
+  Result r;
+  r.kp = loop.pi().kp(); r.ki = loop.pi().ki();
+  r.tuned = loop.tuner().phase() == StepTuner::DONE;
+  float stepSize = sc.to - sc.from;
+  float over = stepSize >= 0.0f ? peak - sc.to : sc.to - trough;
+  r.overshoot = over > 0.0f ? 100.0f * over / fabsf(stepSize) : 0.0f;
+  r.settling = (lastOutside + 1000000u >= end) ? -1.0f : (lastOutside - stepAt) * 1e-6f;
+  r.steadyError = errN ? (float)(errSum / errN) : 0.0f;
+  r.jitter = jitterN ? jitterSum / jitterN : 0.0f;
+  return r;
+}
+
+static const Scenario SCENARIOS[] = {
+  // name              closed tune   scurve accel  jerk   from    to
+  { "open-linear",     false, false, false, 200.0f, 0.0f, 150.0f, 250.0f },
+  { "closed-default",  true,  false, false, 200.0f, 0.0f, 150.0f, 250.0f },
+  { "closed-tuned",    true,  true,  false, 200.0f, 0.0f, 150.0f, 250.0f },
+  { "closed-scurve",   true,  true,  true,  20.0f, 40.0f, 150.0f, 250.0f },
+  { "closed-down",     true,  true,  false, 200.0f, 0.0f, 400.0f, 100.0f },
+};
+
+int main(int argc, char **argv) {
+  const char *traceName = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--trace") && i + 1 < argc) traceName = argv[++i];
+    else { fprintf(stderr, "uso: %s [--trace <escenario>]\n", argv[0]); return 2; }
+  }
+
+  if (traceName) {
+    for (const Scenario &sc : SCENARIOS) {
+      if (strcmp(sc.name, traceName)) continue;
+      printf("t,ref,cmd,measured,true\n");
+      run(sc, stdout);
+      return 0;
+    }
+    fprintf(stderr, "escenario desconocido: %s\n", traceName);
+    return 2;
+  }
+
+  printf("planta: SPR_CMD=%.0f SPR_MEAS=%.0f, latencia driver %d ms, lazo %d ms\n",
+         SPR_CMD, SPR_MEAS, DRIVER_LATENCY_MS, SPEED_LOOP_MS);
+  printf("%-16s %7s %7s %10s %11s %11s %8s\n", "escenario", "kp", "ki", "sobrepaso", "estab.(s)", "error(RPM)", "jitter");
+  for (const Scenario &sc : SCENARIOS) {
+    Result r = run(sc, nullptr);
+    char settling[16];
+    if (r.settling < 0.0f) snprintf(settling, sizeof(settling), "no");
+    else snprintf(settling, sizeof(settling), "%.2f", r.settling);
+    printf("%-16s %7.3f %7.3f %9.1f%% %11s %11.2f %8.2f%s\n", sc.name,
+           sc.closed ? r.kp : 0.0f, sc.closed ? r.ki : 0.0f, r.overshoot, settling, r.steadyError, r.jitter,
+           (sc.tune && !r.tuned) ? "  (autoajuste fallido)" : "");
+  }
+  return 0;
+}
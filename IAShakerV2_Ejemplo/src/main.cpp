@@ -8,12 +8,21 @@
 #include <ESP32RotaryEncoder.h>
 #include <Wire.h>
 #include <WiFi.h>
+#include <driver/pcnt.h>
+#include <rom/gpio.h>
+#include <soc/gpio_periph.h>
+#include <soc/gpio_sig_map.h>
 #include <math.h>
+#include <atomic>
+#include "motion_profile.h"
+#include "motor_calibration.h"
+#include "rpm_estimator.h"
+#include "speed_controller.h"
 
 // ============================
 // Firmware info
 // ============================
-#define FIRMWARE_VERSION "1.2.2-NO-PID-STATUSFIX-APBLINK"
+#define FIRMWARE_VERSION "1.3.0-PI-STATUSFIX-APBLINK"
 
 // ============================
 // Pines
@@ -27,16 +36,6 @@
 #define ENC_DT 18
 #define ENC_SW 19
 
-// ============================
-// Motor / Calibración
-// ============================
-// Ajuste para corregir sobrevelocidad observada (~+10%)
-const double SPR_CMD  = 3200; // steps/vuelta (comando RPM->SPS)
-const double SPR_MEAS = 3659; // steps/vuelta (medición SPS->RPM)
-const float  MAX_RPM  = 510.0f;
-
-inline double rpm2sps(double rpm) { return (rpm / 60.0) * SPR_CMD; }
-
 // ============================
 // Instancias
 // ============================
@@ -47,11 +46,62 @@ LiquidCrystal_I2C lcd(0x27, 16, 2);
 AsyncWebServer server(80);
 
 // ============================
-// Variables compartidas
+// Estado del motor compartido (seqlock)
 // ============================
-float targetRpm  = 0.0f;
-float currentRpm = 0.0f;
-SemaphoreHandle_t rpmMutex;
+// Lo leen uiTask, motorTask y los handlers web; lo escriben varios de ellos.
+// Los lectores nunca bloquean: copian el bloque y repiten si `motorSeq`
+// cambió (o era impar, escritura en curso) mientras copiaban. Los escritores
+// se serializan con un spinlock de pocas instrucciones, así que una escritura
+// nunca falla por timeout ni se pierde.
+#define MOTOR_RUNNING         0x01  // motorTask tiene el driver en marcha
+#define MOTOR_RESET_ESTIMATOR 0x02  // stopMotorHard(): rpmTask reinicia la medición
+#define MOTOR_SCURVE          0x04  // rampas con perfil en S (si no, lineales)
+#define MOTOR_CLOSED_LOOP     0x08  // lazo cerrado de velocidad (SpeedLoop)
+#define MOTOR_TUNE_REQUEST    0x10  // /tune: motorTask lanza el autoajuste cuando la referencia se asienta
+#define MOTOR_TUNING          0x20  // autoajuste en curso
+#define MOTOR_TUNE_FAILED     0x40  // el último autoajuste no dio un modelo válido
+
+struct MotorState {
+  float targetRpm;   // consigna
+  float currentRpm;  // medida (media de la ventana del estimador)
+  float rpmJitter;   // dispersión de la medida, RPM
+  float rpmAccel;    // aceleración medida, RPM/s
+  float cmdSps;      // velocidad comandada al driver (steps/s)
+  float maxAccel;    // aceleración máxima de las rampas, RPM/s
+  float maxJerk;     // jerk máximo (solo perfil S), RPM/s²
+  float kp, ki;      // ganancias del PI en uso (las publica motorTask)
+  uint32_t flags;    // MOTOR_*
+};
+static MotorState motorState = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 10.0f, 20.0f, SPEED_DEFAULT_KP, SPEED_DEFAULT_KI, 0 };
+static std::atomic<uint32_t> motorSeq(0);
+static portMUX_TYPE motorWriteMux = portMUX_INITIALIZER_UNLOCKED;
+
+MotorState readMotorState() {
+  MotorState copy;
+  uint32_t seq;
+  do {
+    seq = motorSeq.load(std::memory_order_acquire);
+    const volatile MotorState &src = motorState;
+    copy.targetRpm = src.targetRpm; copy.currentRpm = src.currentRpm;
+    copy.rpmJitter = src.rpmJitter; copy.rpmAccel = src.rpmAccel;
+    copy.cmdSps = src.cmdSps; copy.maxAccel = src.maxAccel; copy.maxJerk = src.maxJerk;
+    copy.kp = src.kp; copy.ki = src.ki; copy.flags = src.flags;
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || seq != motorSeq.load(std::memory_order_relaxed));
+  return copy;
+}
+
+// `change` corre dentro de la sección crítica: solo asignaciones, nada que bloquee
+template <typename F>
+void updateMotorState(F change) {
+  portENTER_CRITICAL(&motorWriteMux);
+  uint32_t seq = motorSeq.load(std::memory_order_relaxed);
+  motorSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  change(motorState);
+  motorSeq.store(seq + 2, std::memory_order_release);
+  portEXIT_CRITICAL(&motorWriteMux);
+}
 
 // ============================
 // UI
@@ -69,26 +119,71 @@ volatile bool uiForceRedraw = true;
 // Aux estados/calculo RPM
 // ============================
 volatile long KnobValue = 0;
-static volatile bool g_resetRpmEstimator = false;
 static volatile bool g_offlineRequested  = false;
 
 // ============================
-// Rampa 0→60 RPM en 6s (sin PID)
+// Rampas (sin PID)
 // ============================
-// a_cmd = SPR_CMD / 6 steps/s^2  (60 RPM = SPR_CMD steps/s)
-const double A_CMD   = SPR_CMD / 6.0; // ≈ 969.7 sps^2 con SPR_CMD=5818
-const double LOOP_DT = 0.04;          // motorTask ~40 ms
-static double cmdSPS = 0.0;           // velocidad comandada (steps/s)
+// Por defecto lineal, 0→60 RPM en 6 s: a_cmd = SPR_CMD / 6 steps/s^2
+// (60 RPM = SPR_CMD steps/s). /rpm puede cambiar a perfil en S
+// (?profile=scurve) y ajustar aceleración y jerk (?accel=, ?jerk=), que
+// empiezan en los valores de motorState (10 RPM/s, 20 RPM/s²).
+const double A_CMD = SPR_CMD / 6.0;
+#define RAMP_MAX_ACCEL 200.0f   // RPM/s aceptadas en ?accel=
+#define RAMP_MAX_JERK  2000.0f  // RPM/s² aceptadas en ?jerk=
+
+// motorTask duerme hasta que cambia la consigna (notifyMotor()); además se
+// despierta cada MOTOR_WATCHDOG_MS para comprobar que el driver sigue en el
+// estado que se le pidió.
+#define MOTOR_WATCHDOG_MS 500
+static TaskHandle_t motorTaskHandle = NULL;
+// Solo lo usa motorTask; estático para no cargar su pila con el registro del autoajuste
+static SpeedLoop speedLoop;
+
+// ============================
+// Medición de RPM (PCNT sobre STEP_PIN)
+// ============================
+// Una unidad PCNT cuenta los flancos de subida del propio pin STEP; rpmTask
+// la lee cada RPM_SAMPLE_MS y alimenta el RpmEstimator. Si el PCNT no se
+// puede configurar se cuenta con la posición de FastAccelStepper.
+// El pin no se toca: la entrada del PCNT se engancha por la matriz GPIO y la
+// salida sigue siendo la señal STEP del driver.
+#define RPM_PCNT_UNIT  PCNT_UNIT_7   // FastAccelStepper usa las primeras unidades
+#define RPM_PCNT_SIG   PCNT_SIG_CH0_IN7_IDX  // canal 0 de RPM_PCNT_UNIT
+#define RPM_PCNT_LIMIT 32767         // al llegar aquí el contador vuelve a 0
+static bool stepCounterReady = false;
+
+// ============================
+// Escaneo WiFi asíncrono (compartido por /scan y la pantalla WiFi)
+// ============================
+// Nadie espera a la radio: requestScan() lanza scanNetworks(true) si la caché
+// está vieja y el evento SCAN_DONE del driver rellena la caché y sube
+// `generation`, que es lo que miran los consumidores para saber que hay datos nuevos.
+#define SCAN_MAX_NETS 16
+#define SCAN_TTL_MS   10000
+struct ScanCache {
+  char ssid[SCAN_MAX_NETS][33];
+  int count;            // -1: todavía sin resultados
+  uint32_t doneAt;      // millis() del último escaneo terminado
+  uint32_t generation;  // sube con cada escaneo terminado
+};
+static ScanCache scanCache = { {}, -1, 0, 0 };
+static portMUX_TYPE scanMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool scanRunning = false;
 
 // ============================
 // PROTOTIPOS
 // ============================
 void stopMotorHard(bool fromUI = false);
+void notifyMotor();
+bool setupStepCounter();
 void startAPAlways();
 void tryConnectSavedWifi(bool asyncRetry);
 void goOffline();
 bool isStaConnected();
 void onWifiEvent(WiFiEvent_t event);
+bool requestScan(bool force);
+int copyScanResults(char (*out)[33], int max, uint32_t *generation);
 
 // ===========================================================================
 // Utilidades
@@ -128,11 +223,8 @@ void handleNormal() {
     lastLine0 = l0; lastRefresh = millis(); uiForceRedraw = false;
   }
 
-  float cur=0, tgt=0;
-  if (xSemaphoreTake(rpmMutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-    cur = currentRpm; tgt = targetRpm; xSemaphoreGive(rpmMutex);
-  }
-  char buf[17]; snprintf(buf,sizeof(buf),"A:%3.0f T:%3.0f", cur, tgt);
+  MotorState m = readMotorState();
+  char buf[17]; snprintf(buf,sizeof(buf),"A:%3.0f T:%3.0f", m.currentRpm, m.targetRpm);
   static char lastRpm[17]="";
   if (strcmp(buf,lastRpm)!=0) {
     lcd.setCursor(0,1); char l2[17]; snprintf(l2,sizeof(l2),"%-16s", buf); lcd.print(l2);
@@ -168,16 +260,16 @@ void handleMenu() {
 
 void handleAdjustRpm() {
   if (uiForceRedraw) { lcd.clear(); lcd.setCursor(0,0); lcd.print((language==0)?"Ajustar RPM":"Adjust RPM"); uiForceRedraw=false; }
-  float newTarget=0; if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE){ newTarget=targetRpm; xSemaphoreGive(rpmMutex); }
+  float newTarget = readMotorState().targetRpm;
   lcd.setCursor(0,1); char buf[17]; snprintf(buf,sizeof(buf),"RPM: %.0f      ", newTarget); lcd.print(buf);
 }
 
 // AP fijo (no se usa mucho ya, pero lo dejo por compatibilidad)
 void handleApMode() {
   if (uiForceRedraw) { lcd.clear(); uiForceRedraw=false; }
-  float cur=0,tgt=0; if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE){cur=currentRpm;tgt=targetRpm;xSemaphoreGive(rpmMutex);}
+  MotorState m = readMotorState();
   lcd.setCursor(0,0); {const char* t=(language==0)?"MODO AP":"AP MODE"; char l0[17]; snprintf(l0,sizeof(l0),"%-16s",t); lcd.print(l0);}
-  lcd.setCursor(0,1); {char l1[17]; snprintf(l1,sizeof(l1),"A:%3.0f T:%3.0f",cur,tgt); char pad[17]; snprintf(pad,sizeof(pad),"%-16s",l1); lcd.print(pad);}
+  lcd.setCursor(0,1); {char l1[17]; snprintf(l1,sizeof(l1),"A:%3.0f T:%3.0f",m.currentRpm,m.targetRpm); char pad[17]; snprintf(pad,sizeof(pad),"%-16s",l1); lcd.print(pad);}
 }
 
 void handleLanguage() {
@@ -191,41 +283,46 @@ void handleWifiDisconnected() {
   if (uiForceRedraw) { lcd.clear(); uiForceRedraw=false; }
   lcd.setCursor(0,0); { const char* t=(language==0)?(g_offlineRequested?"Sin WiFi":"WiFi Perdido"):(g_offlineRequested?"No WiFi":"WiFi Lost"); char l1[17]; snprintf(l1,sizeof(l1),"%-16s",t); lcd.print(l1); }
   if (millis()-lastRefresh>=250) {
-    float cur=0,tgt=0; if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE){cur=currentRpm;tgt=targetRpm;xSemaphoreGive(rpmMutex);}
-    lcd.setCursor(0,1); char l2[17]; snprintf(l2,sizeof(l2),"A:%3.0f T:%3.0f",cur,tgt); char pad[17]; snprintf(pad,sizeof(pad),"%-16s",l2); lcd.print(pad); lastRefresh=millis();
+    MotorState m = readMotorState();
+    lcd.setCursor(0,1); char l2[17]; snprintf(l2,sizeof(l2),"A:%3.0f T:%3.0f",m.currentRpm,m.targetRpm); char pad[17]; snprintf(pad,sizeof(pad),"%-16s",l2); lcd.print(pad); lastRefresh=millis();
   }
 }
 
 // ======== AHORA PARPADEA EN CONFIGURAR WIFI ========
 void handleWifi() {
-  static uint32_t lastScanTime=0; static int networkCount=-1; static int selectedNetworkIndex=0;
+  static uint32_t shownGeneration=0; static bool shown=false; static int selectedNetworkIndex=0;
   static bool blink=false; static uint32_t lastBlink=0;
 
-  if (uiForceRedraw) { lcd.clear(); uiForceRedraw=false; networkCount=-1; }
+  if (uiForceRedraw) { lcd.clear(); uiForceRedraw=false; shown=false; }
 
   // Línea 0: parpadeo entre "MODO AP" y la IP del AP
   if (millis()-lastBlink >= 800) { blink = !blink; lastBlink = millis(); }
   String l0 = blink ? (language==0 ? "MODO AP" : "AP MODE") : WiFi.softAPIP().toString();
   lcd.setCursor(0,0); char line0[17]; snprintf(line0,sizeof(line0),"%-16s", l0.c_str()); lcd.print(line0);
 
-  // Escaneo cada 10 s (no bloquea /status ni la UI)
-  if (networkCount<0 || millis()-lastScanTime>10000) {
-    networkCount = WiFi.scanNetworks();
-    lastScanTime = millis();
-    selectedNetworkIndex = 0;
-  }
+  // Reescanea en segundo plano cuando la caché supera SCAN_TTL_MS (no bloquea)
+  requestScan(false);
 
-  // Línea 1: muestra conteo y SSID seleccionado (simple)
+  // Línea 1: se redibuja solo cuando llega un escaneo nuevo
+  char nets[1][33]; uint32_t generation;
+  int networkCount = copyScanResults(nets, 1, &generation);
+  if (shown && generation == shownGeneration) return;
   lcd.setCursor(0,1);
-  if (networkCount > 0) {
-    char ssidLine[17];
-    snprintf(ssidLine,sizeof(ssidLine),"%d/%d %s",
-             selectedNetworkIndex+1, networkCount,
-             WiFi.SSID(selectedNetworkIndex).c_str());
+  char ssidLine[17];
+  if (networkCount < 0) {
+    snprintf(ssidLine,sizeof(ssidLine),"%-16s",(language==0)?"Buscando...":"Scanning...");
     lcd.print(ssidLine);
+    return;
+  }
+  selectedNetworkIndex = 0;
+  if (networkCount > 0) {
+    snprintf(ssidLine,sizeof(ssidLine),"%d/%d %-16s",
+             selectedNetworkIndex+1, networkCount, nets[selectedNetworkIndex]);
   } else {
-    lcd.print("No networks found");
+    snprintf(ssidLine,sizeof(ssidLine),"%-16s","No networks found");
   }
+  lcd.print(ssidLine);
+  shownGeneration = generation; shown = true;
 }
 
 // ===========================================================================
@@ -234,17 +331,17 @@ void handleWifi() {
 void IRAM_ATTR knobCallback(long value) { KnobValue = -value; rotaryEncoder.resetEncoderValue(); }
 
 void uiTask(void *parameter) {
-  static uint32_t lastRpmCalc=0; static long lastStepperPos=0; static float smoothedRpm=0.0f;
-
   while (true) {
     long delta=0; if (KnobValue!=0){ delta=KnobValue; KnobValue=0; uiForceRedraw=true; }
     if (delta!=0) {
-      if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE) {
-        if (uiState==UI_ADJUST_RPM){ targetRpm += delta; if (targetRpm<0) targetRpm=0; if (targetRpm>MAX_RPM) targetRpm=MAX_RPM; }
-        else if (uiState==UI_MENU){ const int menuCount=6; menuIndex+=delta; if (menuIndex<0) menuIndex=menuCount-1; if (menuIndex>=menuCount) menuIndex=0; }
-        else if (uiState==UI_LANGUAGE){ language=(language+delta)%2; if (language<0) language=1; }
-        xSemaphoreGive(rpmMutex);
+      if (uiState==UI_ADJUST_RPM) {
+        updateMotorState([delta](MotorState &s){
+          s.targetRpm += delta; if (s.targetRpm<0) s.targetRpm=0; if (s.targetRpm>MAX_RPM) s.targetRpm=MAX_RPM;
+        });
+        notifyMotor();
       }
+      else if (uiState==UI_MENU){ const int menuCount=6; menuIndex+=delta; if (menuIndex<0) menuIndex=menuCount-1; if (menuIndex>=menuCount) menuIndex=0; }
+      else if (uiState==UI_LANGUAGE){ language=(language+delta)%2; if (language<0) language=1; }
     }
 
     static uint32_t lastBtn=0;
@@ -281,99 +378,207 @@ void uiTask(void *parameter) {
       case UI_WIFI_DISCONNECTED: handleWifiDisconnected(); break;
     }
 
-    // --- Medición de RPM usando SPR_MEAS calibrado ---
-    if (g_resetRpmEstimator) {
-      long posNow = stepper ? stepper->getCurrentPosition() : 0;
-      lastStepperPos = posNow; smoothedRpm=0.0f;
-      if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE){ currentRpm=0.0f; xSemaphoreGive(rpmMutex); }
-      g_resetRpmEstimator=false;
-    }
-    if (millis()-lastRpmCalc >= 300) {
-      lastRpmCalc = millis();
-      long pos = stepper ? stepper->getCurrentPosition() : 0;
-      // rpm = deltaSteps / SPR_MEAS * (60/dt); con dt=0.3 => factor 200
-      float rpm = ((pos - lastStepperPos) / (float)SPR_MEAS) * 200.0f;
-      lastStepperPos = pos;
-      smoothedRpm = 0.35f * rpm + 0.65f * smoothedRpm;
-      if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE){ currentRpm = smoothedRpm; xSemaphoreGive(rpmMutex); }
-    }
-
     vTaskDelay(pdMS_TO_TICKS(20));
   }
 }
 
 // ===============================
-// Tarea del motor (rampa abierta)
+// Tarea de medición de RPM
 // ===============================
-/*void motorTask(void *parameter) {
+bool setupStepCounter() {
+  pcnt_config_t cfg = {};
+  cfg.pulse_gpio_num = PCNT_PIN_NOT_USED;  // con el pin, pcnt_unit_config() lo dejaría solo como entrada
+  cfg.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  cfg.channel = PCNT_CHANNEL_0;
+  cfg.unit = RPM_PCNT_UNIT;
+  cfg.pos_mode = PCNT_COUNT_INC;   // un paso por flanco de subida
+  cfg.neg_mode = PCNT_COUNT_DIS;
+  cfg.lctrl_mode = PCNT_MODE_KEEP;
+  cfg.hctrl_mode = PCNT_MODE_KEEP;
+  cfg.counter_h_lim = RPM_PCNT_LIMIT;
+  cfg.counter_l_lim = -RPM_PCNT_LIMIT;
+  if (pcnt_unit_config(&cfg) != ESP_OK) return false;
+  // Solo se activa la entrada del pad; la salida del driver queda como está
+  PIN_INPUT_ENABLE(GPIO_PIN_MUX_REG[STEP_PIN]);
+  gpio_matrix_in(STEP_PIN, RPM_PCNT_SIG, false);
+  pcnt_counter_pause(RPM_PCNT_UNIT);
+  pcnt_counter_clear(RPM_PCNT_UNIT);
+  pcnt_counter_resume(RPM_PCNT_UNIT);
+  return true;
+}
+
+// Pasos acumulados desde el arranque (solo se llama desde rpmTask)
+int32_t readStepCount() {
+  static int16_t lastRaw = 0; static int32_t total = 0;
+  if (!stepCounterReady) return stepper ? stepper->getCurrentPosition() : 0;
+  int16_t raw = 0; pcnt_get_counter_value(RPM_PCNT_UNIT, &raw);
+  // Entre dos lecturas (10 ms) caben como mucho unos 270 pasos a MAX_RPM
+  int32_t delta = (int32_t)raw - lastRaw; if (delta < 0) delta += RPM_PCNT_LIMIT;
+  lastRaw = raw; total += delta;
+  return total;
+}
+
+// Publica RPM media, jitter y aceleración a 1000/RPM_SAMPLE_MS Hz, sin depender de la UI
+void rpmTask(void *parameter) {
+  static RpmEstimator estimator(SPR_MEAS);
+  estimator.reset(readStepCount(), (uint32_t)micros());
+  TickType_t wake = xTaskGetTickCount();
+
   while (true) {
-    double sp_rpm;
-    if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE) {
-      sp_rpm = (double)targetRpm;
-      xSemaphoreGive(rpmMutex);
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(RPM_SAMPLE_MS));
+    int32_t count = readStepCount(); uint32_t now = (uint32_t)micros();
+
+    if (readMotorState().flags & MOTOR_RESET_ESTIMATOR) {
+      estimator.reset(count, now);
+      updateMotorState([](MotorState &s){
+        s.currentRpm = 0.0f; s.rpmJitter = 0.0f; s.rpmAccel = 0.0f;
+        s.flags &= ~MOTOR_RESET_ESTIMATOR;
+      });
+      continue;
     }
 
-    if (sp_rpm <= 1.0) {
-      cmdSPS = 0.0;
-      if (stepper){ if (stepper->isRunningContinuously()) stepper->stopMove(); stepper->disableOutputs(); }
-    } else {
-      // Rampa con aceleración A_CMD (con SPR calibrado)
-      double targetSPS = rpm2sps(sp_rpm);
-      if (cmdSPS < targetSPS)      cmdSPS = min(cmdSPS + A_CMD * LOOP_DT, targetSPS);
-      else if (cmdSPS > targetSPS) cmdSPS = max(cmdSPS - A_CMD * LOOP_DT, targetSPS);
-
-      if (stepper) {
-        // Aceleración del driver suficientemente alta para no limitar la rampa
-        stepper->setAcceleration(20000);
-        stepper->setSpeedInHz((float)cmdSPS);
-        if (!stepper->isRunningContinuously()) { stepper->enableOutputs(); stepper->runForward(); }
-        else { stepper->applySpeedAcceleration(); }
-      }
-    }
-    vTaskDelay(pdMS_TO_TICKS((int)(LOOP_DT*1000)));
+    estimator.push(count, now);
+    RpmReading r = estimator.reading();
+    updateMotorState([r](MotorState &s){ s.currentRpm = r.rpm; s.rpmJitter = r.jitter; s.rpmAccel = r.accel; });
   }
-}*/
+}
+
 // ===============================
 // Tarea del motor (rampa gestionada por la librería)
 // ===============================
+void notifyMotor() { if (motorTaskHandle) xTaskNotifyGive(motorTaskHandle); }
+
+// Lleva el driver a `sps` con la aceleración ya configurada (0: parada)
+void driveStepper(double sps, bool running) {
+  if (sps <= 0.0) {
+    stepper->stopMove();
+    stepper->disableOutputs();
+    return;
+  }
+  stepper->setSpeedInHz((float)sps);
+  if (!running) {
+    stepper->enableOutputs();
+    stepper->runForward();
+  } else {
+    // Ya en marcha: rampa desde la velocidad actual hasta la nueva
+    stepper->applySpeedAcceleration();
+  }
+}
+
+// Única tarea que toca el driver: solo llama a FastAccelStepper cuando la
+// velocidad pedida cambia de verdad (arranque, cambio de consigna, parada).
+// Con perfil en S la rampa se precalcula en tramos de aceleración constante
+// (SCurveProfile) y la tarea entrega cada tramo al driver cuando vence el
+// anterior; un cambio de consigna a mitad replanifica desde la velocidad real
+// y la aceleración que llevaba el perfil, sin salto de aceleración.
+// En lazo cerrado (MOTOR_CLOSED_LOOP con consigna > 0) se despierta cada
+// SPEED_LOOP_MS y comanda lo que diga speedLoop; las paradas van siempre en
+// lazo abierto.
 void motorTask(void *parameter) {
+  double appliedSPS = 0.0; // meta aplicada al driver (0: parado)
+  double cmdSPS = 0.0;     // velocidad pedida ahora (con perfil S, la del tramo en curso)
+  SCurveProfile profile;   // perfil en S en curso (duración 0 si no hay)
+  TickType_t profileStart = 0;
+  ProfileSegment segs[MOTION_MAX_SEGMENTS];
+  int segCount = 0, segNext = 0;
+  TickType_t segDeadline = 0;
+  bool closedActive = false;
+  TickType_t loopDeadline = 0;
+
   while (true) {
-    double sp_rpm;
-    if (xSemaphoreTake(rpmMutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-      sp_rpm = (double)targetRpm;
-      xSemaphoreGive(rpmMutex);
+    bool profiling = segNext < segCount;
+    TickType_t wait = pdMS_TO_TICKS(MOTOR_WATCHDOG_MS);
+    if (closedActive || profiling) {
+      TickType_t deadline = closedActive ? loopDeadline : segDeadline;
+      TickType_t now = xTaskGetTickCount();
+      wait = ((int32_t)(deadline - now) > 0) ? deadline - now : 0;
     }
+    bool notified = ulTaskNotifyTake(pdTRUE, wait) > 0;
+    MotorState m = readMotorState();
+    double sp_rpm = (double)m.targetRpm;
+    double targetSPS = (sp_rpm < 1.0) ? 0.0 : rpm2sps(sp_rpm);
+    bool running = false;
+    uint32_t setFlags = 0, clearFlags = 0;
 
     if (stepper) {
-      if (sp_rpm < 1.0) {
-        // << CAMBIO: Lógica de parada simplificada
-        if (stepper->isRunningContinuously()) {
-          stepper->stopMove();
-          stepper->disableOutputs();
+      running = stepper->isRunningContinuously();
+
+      if ((m.flags & MOTOR_CLOSED_LOOP) && targetSPS > 0.0) {
+        if (!closedActive) {
+          // Entra desde la velocidad medida: sin salto si ya estaba girando
+          closedActive = true; segCount = segNext = 0; profile = SCurveProfile();
+          speedLoop.reset(running ? m.currentRpm : 0.0f);
+          stepper->setAcceleration((int32_t)rpm2sps(SPEED_LOOP_ACCEL));
+          loopDeadline = xTaskGetTickCount();
+        }
+        if ((int32_t)(xTaskGetTickCount() - loopDeadline) >= 0) {
+          loopDeadline += pdMS_TO_TICKS(SPEED_LOOP_MS);
+          bool wasTuning = speedLoop.tuner().active();
+          float cmd = speedLoop.step(m.targetRpm, m.currentRpm, m.maxAccel,
+                                     (m.flags & MOTOR_SCURVE) ? m.maxJerk : 0.0f);
+
+          // La petición espera a que la referencia llegue a la consigna
+          if (m.flags & MOTOR_TUNE_REQUEST) {
+            if (speedLoop.startTuning(MAX_RPM)) { clearFlags |= MOTOR_TUNE_REQUEST | MOTOR_TUNE_FAILED; setFlags |= MOTOR_TUNING; }
+            else if (m.targetRpm < TUNE_MIN_RPM) { clearFlags |= MOTOR_TUNE_REQUEST; setFlags |= MOTOR_TUNE_FAILED; }
+          }
+          if (wasTuning && !speedLoop.tuner().active()) {
+            clearFlags |= MOTOR_TUNING;
+            if (speedLoop.tuner().phase() != StepTuner::DONE) setFlags |= MOTOR_TUNE_FAILED;
+          }
+
+          cmdSPS = rpm2sps(cmd);
+          if (cmdSPS < 1.0) cmdSPS = 1.0;
+          driveStepper(cmdSPS, running);
         }
       } else {
-        // << CAMBIO: Lógica de control delegada a la librería
-        double targetSPS = rpm2sps(sp_rpm);
-
-        // 1. Definimos la aceleración (la rampa que queremos)
-        stepper->setAcceleration((float)A_CMD);
-        
-        // 2. Definimos la velocidad objetivo
-        stepper->setSpeedInHz((float)targetSPS);
-
-        // 3. Nos aseguramos de que el motor esté encendido y aplicando los cambios
-        if (!stepper->isRunningContinuously()) {
-          stepper->enableOutputs();
-          stepper->runForward();
-        } else {
-          // Si ya se está moviendo, aplica la nueva velocidad/aceleración
-          stepper->applySpeedAcceleration(); 
+        if (closedActive) {
+          // Vuelta a lazo abierto (o parada): se reaplica la consigna desde la velocidad real
+          closedActive = false; appliedSPS = -1.0;
+          if (speedLoop.tuner().active()) { speedLoop.stopTuning(); clearFlags |= MOTOR_TUNING; setFlags |= MOTOR_TUNE_FAILED; }
+        }
+        if (m.flags & MOTOR_TUNE_REQUEST) { clearFlags |= MOTOR_TUNE_REQUEST; setFlags |= MOTOR_TUNE_FAILED; }
+        // Watchdog: si el driver no está como lo dejamos, se vuelve a aplicar
+        if (!notified && !profiling && (appliedSPS > 0.0) != running) appliedSPS = -1.0;
+
+        if (targetSPS != appliedSPS) {
+          segCount = segNext = 0;
+          TickType_t now = xTaskGetTickCount();
+          float fromAccel = running ? profile.acceleration((now - profileStart) * portTICK_PERIOD_MS / 1000.0f) : 0.0f;
+          profile = SCurveProfile();
+          if (m.flags & MOTOR_SCURVE) {
+            double fromSPS = running ? stepper->getCurrentSpeedInMilliHz() / 1000.0 : 0.0;
+            profile.plan((float)fromSPS, (float)targetSPS, (float)rpm2sps(m.maxAccel), (float)rpm2sps(m.maxJerk), fromAccel);
+            segCount = profile.segments(segs);
+            profileStart = segDeadline = now;
+          }
+          if (segCount == 0) {
+            // Rampa lineal (o ya estaba a esa velocidad): la hace el driver entera
+            stepper->setAcceleration((int32_t)rpm2sps(m.maxAccel));
+            driveStepper(targetSPS, running);
+            cmdSPS = targetSPS;
+          }
+          appliedSPS = targetSPS;
+        }
+
+        if (segNext < segCount && (int32_t)(xTaskGetTickCount() - segDeadline) >= 0) {
+          const ProfileSegment &seg = segs[segNext++];
+          stepper->setAcceleration(seg.accel < 1.0f ? 1 : (int32_t)seg.accel);
+          // El último tramo va exactamente a la meta; los intermedios nunca por debajo de 1 step/s
+          cmdSPS = (segNext == segCount) ? targetSPS : (seg.speed < 1.0f ? 1.0 : (double)seg.speed);
+          driveStepper(cmdSPS, stepper->isRunningContinuously());
+          segDeadline += pdMS_TO_TICKS(seg.ms);
         }
       }
+      running = stepper->isRunningContinuously();
     }
-    
-    // El delay puede ser un poco más largo, ya que no calculamos la rampa manualmente
-    vTaskDelay(pdMS_TO_TICKS(50)); 
+
+    float sps = (float)cmdSPS, kp = speedLoop.pi().kp(), ki = speedLoop.pi().ki();
+    if (running) setFlags |= MOTOR_RUNNING; else clearFlags |= MOTOR_RUNNING;
+    updateMotorState([sps, kp, ki, setFlags, clearFlags](MotorState &s){
+      s.cmdSps = sps; s.kp = kp; s.ki = ki;
+      s.flags = (s.flags & ~clearFlags) | setFlags;
+    });
   }
 }
 
@@ -404,11 +609,7 @@ void setupServer() {
     const bool sta = (WiFi.status() == WL_CONNECTED);
     const bool ap  = (WiFi.getMode() & WIFI_AP);
 
-    float cur = 0.0f;
-    if (xSemaphoreTake(rpmMutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-      cur = currentRpm;
-      xSemaphoreGive(rpmMutex);
-    }
+    MotorState m = readMotorState();
 
     if (sta) {
       // STA conectado
@@ -419,7 +620,14 @@ void setupServer() {
       String ssid = WiFi.SSID();  // seguro en STA
       doc["ssid"] = ssid;
       doc["rssi"] = WiFi.RSSI();
-      doc["currentRpm"] = cur;
+      doc["currentRpm"] = m.currentRpm;
+      doc["rpmJitter"]  = m.rpmJitter;
+      doc["rpmAccel"]   = m.rpmAccel;
+      doc["loop"]       = (m.flags & MOTOR_CLOSED_LOOP) ? "closed" : "open";
+      doc["tuning"]     = (m.flags & (MOTOR_TUNE_REQUEST | MOTOR_TUNING)) != 0;
+      doc["tuneFailed"] = (m.flags & MOTOR_TUNE_FAILED) != 0;
+      doc["kp"]         = m.kp;
+      doc["ki"]         = m.ki;
     } else {
       // AP o desconectado
       doc["wifi"] = false;
@@ -434,11 +642,45 @@ void setupServer() {
     request->send(200, "application/json", json);
   });
 
+  // ?profile=linear|scurve, ?accel= (RPM/s), ?jerk= (RPM/s²) y ?loop=open|closed
+  // son opcionales y se quedan para las siguientes rampas (también las del encoder)
   server.on("/rpm", HTTP_GET, [](AsyncWebServerRequest *request){
     if (request->hasParam("value")) {
       float val = request->getParam("value")->value().toFloat();
       if (val < 0) val = 0; if (val > MAX_RPM) val = MAX_RPM;
-      if (xSemaphoreTake(rpmMutex,pdMS_TO_TICKS(5))==pdTRUE){ targetRpm=val; xSemaphoreGive(rpmMutex); }
+
+      int scurve = -1; // -1: sin cambio
+      if (request->hasParam("profile")) {
+        String p = request->getParam("profile")->value();
+        if (p == "scurve") scurve = 1;
+        else if (p == "linear") scurve = 0;
+        else { request->send(400, "text/plain", "Bad profile"); return; }
+      }
+      int closed = -1; // -1: sin cambio
+      if (request->hasParam("loop")) {
+        String l = request->getParam("loop")->value();
+        if (l == "closed") closed = 1;
+        else if (l == "open") closed = 0;
+        else { request->send(400, "text/plain", "Bad loop"); return; }
+      }
+      float accel = 0.0f, jerk = 0.0f;
+      if (request->hasParam("accel")) {
+        accel = request->getParam("accel")->value().toFloat();
+        if (!(accel > 0.0f && accel <= RAMP_MAX_ACCEL)) { request->send(400, "text/plain", "Bad accel"); return; }
+      }
+      if (request->hasParam("jerk")) {
+        jerk = request->getParam("jerk")->value().toFloat();
+        if (!(jerk > 0.0f && jerk <= RAMP_MAX_JERK)) { request->send(400, "text/plain", "Bad jerk"); return; }
+      }
+
+      updateMotorState([val, scurve, closed, accel, jerk](MotorState &s){
+        s.targetRpm = val;
+        if (scurve == 1) s.flags |= MOTOR_SCURVE; else if (scurve == 0) s.flags &= ~MOTOR_SCURVE;
+        if (closed == 1) s.flags |= MOTOR_CLOSED_LOOP; else if (closed == 0) s.flags &= ~MOTOR_CLOSED_LOOP;
+        if (accel > 0.0f) s.maxAccel = accel;
+        if (jerk > 0.0f) s.maxJerk = jerk;
+      });
+      notifyMotor();
       if (val <= 1.0f) stopMotorHard(false);
       request->send(200, "text/plain", "OK");
     } else request->send(400, "text/plain", "Missing value");
@@ -449,11 +691,36 @@ void setupServer() {
     request->send(200, "application/json", "{\"status\":\"stopped\"}");
   });
 
+  // Autoajuste del PI: ensayo en escalón de unos 5 s alrededor de la consigna.
+  // El resultado (o tuneFailed) se ve en /status.
+  server.on("/tune", HTTP_POST, [](AsyncWebServerRequest *request){
+    MotorState m = readMotorState();
+    if (!(m.flags & MOTOR_CLOSED_LOOP) || m.targetRpm < TUNE_MIN_RPM) {
+      char body[80];
+      snprintf(body, sizeof(body), "{\"status\":\"error\",\"msg\":\"closed loop and target >= %.0f RPM required\"}", TUNE_MIN_RPM);
+      request->send(409, "application/json", body);
+      return;
+    }
+    updateMotorState([](MotorState &s){ s.flags |= MOTOR_TUNE_REQUEST; s.flags &= ~MOTOR_TUNE_FAILED; });
+    notifyMotor();
+    request->send(202, "application/json", "{\"status\":\"tuning\"}");
+  });
+
+  // Nunca bloquea: responde con la caché; si estaba vieja (o ?force=1) lanza
+  // un escaneo en segundo plano y responde 202 con los resultados previos.
   server.on("/scan", HTTP_GET, [](AsyncWebServerRequest *request){
-    int n = WiFi.scanNetworks(); StaticJsonDocument<1024> doc; JsonArray redes = doc.to<JsonArray>();
-    for (int i=0;i<n;++i) redes.add(WiFi.SSID(i));
+    bool force = false;
+    if (request->hasParam("force")) {
+      String f = request->getParam("force")->value();
+      force = f == "1" || f == "true";
+    }
+    bool scanning = requestScan(force);
+    char nets[SCAN_MAX_NETS][33]; int n = copyScanResults(nets, SCAN_MAX_NETS, nullptr);
+    if (n > SCAN_MAX_NETS) n = SCAN_MAX_NETS;
+    StaticJsonDocument<1024> doc; JsonArray redes = doc.to<JsonArray>();
+    for (int i=0;i<n;++i) redes.add(nets[i]);
     String response; serializeJson(redes, response);
-    request->send(200, "application/json", response);
+    request->send(scanning ? 202 : 200, "application/json", response);
   });
 
   server.on("/saveWifi", HTTP_POST, [](AsyncWebServerRequest *request){
@@ -474,6 +741,21 @@ void setupServer() {
 // WiFi
 // ===========================================================================
 void onWifiEvent(WiFiEvent_t event) {
+  if (event == SYSTEM_EVENT_SCAN_DONE) {
+    // Termina un scanNetworks(true): copia a la caché y avisa
+    int n = WiFi.scanComplete();
+    if (n >= 0) {
+      char nets[SCAN_MAX_NETS][33]; int count = n < SCAN_MAX_NETS ? n : SCAN_MAX_NETS;
+      for (int i=0;i<count;++i) { strncpy(nets[i], WiFi.SSID(i).c_str(), 32); nets[i][32]='\0'; }
+      portENTER_CRITICAL(&scanMux);
+      memcpy(scanCache.ssid, nets, sizeof(nets[0]) * count);
+      scanCache.count = count; scanCache.doneAt = millis(); scanCache.generation++;
+      portEXIT_CRITICAL(&scanMux);
+    }
+    WiFi.scanDelete();
+    scanRunning = false;
+    return;
+  }
   uiForceRedraw = true;
   switch (event) {
     case SYSTEM_EVENT_STA_GOT_IP:
@@ -486,6 +768,33 @@ void onWifiEvent(WiFiEvent_t event) {
   }
 }
 
+// Devuelve true si hay un escaneo en curso (recién lanzado o previo)
+bool requestScan(bool force) {
+  portENTER_CRITICAL(&scanMux);
+  bool fresh = scanCache.count >= 0 && (millis() - scanCache.doneAt) < SCAN_TTL_MS;
+  bool start = !scanRunning && (force || !fresh);
+  if (start) scanRunning = true;
+  bool running = scanRunning;
+  portEXIT_CRITICAL(&scanMux);
+
+  if (start) {
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) { scanRunning = false; return false; }
+  }
+  return running;
+}
+
+// Copia hasta `max` SSIDs de la caché; devuelve cuántas redes hay en total,
+// aunque no quepan en `out` (-1 sin resultados)
+int copyScanResults(char (*out)[33], int max, uint32_t *generation) {
+  portENTER_CRITICAL(&scanMux);
+  int total = scanCache.count;
+  int n = total < max ? total : max;
+  if (n > 0) memcpy(out, scanCache.ssid, sizeof(out[0]) * n);
+  if (generation) *generation = scanCache.generation;
+  portEXIT_CRITICAL(&scanMux);
+  return total;
+}
+
 void startAPAlways() {
   WiFi.mode(WIFI_AP_STA);
   String ssid = String("BioShaker_") + String((uint32_t)ESP.getEfuseMac(), HEX).substring(4);
@@ -526,18 +835,13 @@ void goOffline() {
   if (fromUI) uiForceRedraw=true;
 }*/
 void stopMotorHard(bool fromUI) {
-  if (xSemaphoreTake(rpmMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    targetRpm = 0.0f;
-    currentRpm = 0.0f;
-    xSemaphoreGive(rpmMutex);
-  }
-  cmdSPS = 0.0;
-  if (stepper) {
-    stepper->stopMove();
-    stepper->disableOutputs();
-    // stepper->forceStopAndNewPosition(stepper->getCurrentPosition()); // << CAMBIO: Eliminada esta línea problemática
-  }
-  g_resetRpmEstimator = true;
+  // Consigna, medida y estimador se reinician en una sola escritura
+  updateMotorState([](MotorState &s){
+    s.targetRpm = 0.0f; s.currentRpm = 0.0f; s.rpmJitter = 0.0f; s.rpmAccel = 0.0f; s.cmdSps = 0.0f;
+    s.flags |= MOTOR_RESET_ESTIMATOR;
+  });
+  // motorTask (prioridad 2) se despierta enseguida y hace stopMove()/disableOutputs()
+  notifyMotor();
   if (fromUI) uiForceRedraw = true;
 }
 
@@ -558,11 +862,12 @@ void setup() {
     stepper->setDirectionPin(DIR_PIN);
     stepper->setEnablePin(ENABLE_PIN);
     stepper->setAutoEnable(true);
-    // Aceleración del driver >> A_CMD (≈ 970) para no limitar la rampa
-    stepper->setAcceleration(20000);
+    // Rampa lineal por defecto; motorTask la reajusta en cada cambio de consigna
+    stepper->setAcceleration((float)A_CMD);
   }
-
-  rpmMutex = xSemaphoreCreateMutex();
+  // Después de conectar el driver: el PCNT escucha el mismo pin STEP
+  stepCounterReady = setupStepCounter();
+  if (!stepCounterReady) Serial.println("PCNT no disponible: RPM desde la posicion del driver");
 
   // WiFi
   WiFi.onEvent(onWifiEvent);
@@ -572,7 +877,8 @@ void setup() {
   setupServer();
 
   xTaskCreatePinnedToCore(uiTask, "uiTask", 4096, NULL, 1, NULL, 0);
-  xTaskCreatePinnedToCore(motorTask, "motorTask", 4096, NULL, 2, NULL, 1);
+  xTaskCreatePinnedToCore(motorTask, "motorTask", 4096, NULL, 2, &motorTaskHandle, 1);
+  xTaskCreatePinnedToCore(rpmTask, "rpmTask", 3072, NULL, 3, NULL, 1);
 }
 
 void loop() {
@@ -0,0 +1,86 @@
+#include "motion_profile.h"
+
+#include <math.h>
+
+void SCurveProfile::plan(float v0, float v1, float maxAccel, float maxJerk, float a0) {
+  _v0 = v0; _v1 = v1;
+  _jerk = maxJerk;
+  // El sentido lo da lo que falta tras llevar a0 a cero: a0·|a0|/(2J)
+  float rest = (v1 - v0) - a0 * fabsf(a0) / (2.0f * maxJerk);
+  _dir = (rest > 0.0f || (rest == 0.0f && a0 >= 0.0f)) ? 1.0f : -1.0f;
+  float dv = _dir * (v1 - v0);
+  _a0 = _dir * a0;
+
+  // Pico sin fase constante: (2·ap² - a0²)/(2J) = Δv
+  float ap = sqrtf(fmaxf(0.0f, maxJerk * dv + 0.5f * _a0 * _a0));
+  _ap = ap < maxAccel ? ap : maxAccel;
+  _t1 = fabsf(_ap - _a0) / maxJerk;
+  _t3 = _ap / maxJerk;
+  _ta = 0.0f;
+  if (_ap > 0.0f) {
+    float jerkDv = 0.5f * (_a0 + _ap) * _t1 + 0.5f * _ap * _t3;
+    _ta = fmaxf(0.0f, (dv - jerkDv) / _ap);
+  }
+}
+
+float SCurveProfile::peakAccel() const {
+  return fabsf(_a0) > _ap ? fabsf(_a0) : _ap;
+}
+
+float SCurveProfile::velocity(float t) const {
+  float total = duration();
+  if (t <= 0.0f) return _v0;
+  if (t >= total) return _v1;
+  if (t < _t1) {
+    float j = _ap >= _a0 ? _jerk : -_jerk;
+    return _v0 + _dir * (_a0 * t + 0.5f * j * t * t);
+  }
+  if (t < _t1 + _ta) return _v0 + _dir * (0.5f * (_a0 + _ap) * _t1 + _ap * (t - _t1));
+  float r = total - t;
+  return _v1 - _dir * 0.5f * _jerk * r * r;
+}
+
+float SCurveProfile::acceleration(float t) const {
+  float total = duration();
+  if (t <= 0.0f || t >= total) return 0.0f;
+  if (t < _t1) return _dir * (_ap >= _a0 ? _a0 + _jerk * t : _a0 - _jerk * t);
+  if (t < _t1 + _ta) return _dir * _ap;
+  return _dir * _jerk * (total - t);
+}
+
+// Cortes que parten `len` s (desde `from`) en tramos de al menos
+// MOTION_MIN_SEGMENT_MS, hasta MOTION_JERK_SEGMENTS
+static int splitPhase(float from, float len, float *cuts) {
+  if (len <= 0.0f) return 0;
+  int pieces = (int)(len * 1000.0f / MOTION_MIN_SEGMENT_MS);
+  if (pieces < 1) pieces = 1;
+  if (pieces > MOTION_JERK_SEGMENTS) pieces = MOTION_JERK_SEGMENTS;
+  for (int i = 1; i <= pieces; ++i) cuts[i - 1] = from + len * i / pieces;
+  return pieces;
+}
+
+int SCurveProfile::segments(ProfileSegment *out) const {
+  if (duration() <= 0.0f) return 0;
+
+  // Instantes de corte: fase de jerk hacia el pico, constante, jerk hacia cero
+  float cuts[MOTION_MAX_SEGMENTS + 1];
+  int n = 0;
+  cuts[n++] = 0.0f;
+  n += splitPhase(0.0f, _t1, cuts + n);
+  if (_ta > 0.0f) cuts[n++] = _t1 + _ta;
+  n += splitPhase(_t1 + _ta, _t3, cuts + n);
+
+  int count = 0;
+  uint32_t elapsedMs = 0;
+  for (int i = 1; i < n; ++i) {
+    // Redondeo acumulado: la suma de los tramos es la duración total
+    uint32_t endMs = (uint32_t)lroundf(cuts[i] * 1000.0f);
+    float dt = cuts[i] - cuts[i - 1];
+    ProfileSegment &s = out[count++];
+    s.speed = velocity(cuts[i]);
+    s.accel = dt > 0.0f ? fabsf(s.speed - velocity(cuts[i - 1])) / dt : 0.0f;
+    s.ms = endMs - elapsedMs;
+    elapsedMs = endMs;
+  }
+  return count;
+}
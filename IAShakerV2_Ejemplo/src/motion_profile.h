@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================
+// Perfil de velocidad en S (jerk limitado)
+// ============================
+// Lleva la velocidad de v0 a v1 sin saltos de aceleración: la aceleración
+// sube con jerk constante, se mantiene (si da tiempo) en maxAccel y baja
+// otra vez con jerk constante. Con Δv = |v1 - v0|, A = maxAccel, J = maxJerk
+// y partiendo de aceleración 0:
+//  - Δv >= A²/J: tj = A/J, ta = Δv/A - A/J  (aceleración trapezoidal)
+//  - Δv <  A²/J: tj = sqrt(Δv/J), ta = 0     (triangular, pico J·tj < A)
+// y dura 2·tj + ta. Si se replanifica a mitad de una rampa se pasa la
+// aceleración actual a0: la primera fase de jerk lleva a0 al pico (dura
+// |pico - a0|/J) y el pico sale de (2·pico² - a0²)/(2J) = Δv, así que la
+// aceleración sigue sin saltos. Las unidades son libres (steps/s, RPM...),
+// siempre que maxAccel y maxJerk usen las mismas.
+// No depende de Arduino ni de FreeRTOS: se puede compilar en el host.
+#define MOTION_JERK_SEGMENTS   8    // tramos por cada fase de jerk
+#define MOTION_MIN_SEGMENT_MS  20   // tramo más corto que se genera
+#define MOTION_MAX_SEGMENTS    (2 * MOTION_JERK_SEGMENTS + 1)
+
+// Tramo para el driver: rampa lineal con `accel` hasta `speed`, durante `ms`
+struct ProfileSegment {
+  float speed;   // velocidad al final del tramo
+  float accel;   // aceleración (valor absoluto) del tramo
+  uint32_t ms;
+};
+
+class SCurveProfile {
+public:
+  SCurveProfile() { plan(0.0f, 0.0f, 1.0f, 1.0f); }
+
+  // a0: aceleración (con signo) en el instante de planificar
+  void plan(float v0, float v1, float maxAccel, float maxJerk, float a0 = 0.0f);
+
+  float duration() const { return _t1 + _ta + _t3; }       // s
+  float peakAccel() const;                                  // <= maxAccel si |a0| <= maxAccel
+  float velocity(float t) const;
+  float acceleration(float t) const;                        // con signo
+
+  // Aproxima el perfil con tramos de aceleración constante: cada fase de
+  // jerk se parte en hasta MOTION_JERK_SEGMENTS tramos y la fase de
+  // aceleración constante va en uno solo (ahí el tramo lineal es exacto).
+  // Devuelve cuántos tramos escribió en `out` (hasta MOTION_MAX_SEGMENTS).
+  int segments(ProfileSegment *out) const;
+
+private:
+  float _v0, _v1;
+  float _dir;   // +1 acelera, -1 frena
+  float _jerk;
+  float _a0;    // aceleración inicial, en el sentido de _dir
+  float _ap;    // aceleración de la fase constante, en el sentido de _dir (>= 0)
+  float _t1;    // fase de jerk de _a0 a _ap, s
+  float _ta;    // fase de aceleración constante, s
+  float _t3;    // fase de jerk de _ap a 0, s
+};
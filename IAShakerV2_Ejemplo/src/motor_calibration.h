@@ -0,0 +1,14 @@
+#pragma once
+
+// ============================
+// Motor / Calibración
+// ============================
+// Compartido por el firmware y la simulación del lazo en el host (sim/).
+// Ajuste para corregir sobrevelocidad observada (~+10%). SPR_MEAS es la
+// calibración real: también en lazo cerrado, que mide los pulsos STEP con
+// ella, la velocidad del eje solo es tan buena como este valor.
+const double SPR_CMD  = 3200; // steps/vuelta (comando RPM->SPS)
+const double SPR_MEAS = 3659; // steps/vuelta (medición SPS->RPM)
+const float  MAX_RPM  = 510.0f;
+
+inline double rpm2sps(double rpm) { return (rpm / 60.0) * SPR_CMD; }
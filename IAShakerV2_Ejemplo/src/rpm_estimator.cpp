@@ -0,0 +1,64 @@
+#include "rpm_estimator.h"
+
+#include <math.h>
+
+void RpmEstimator::reset(int32_t count, uint32_t nowUs) {
+  _head = 0; _count = 1;
+  _ring[0] = { count, nowUs };
+  _reading = { 0.0f, 0.0f, 0.0f, 0 };
+}
+
+void RpmEstimator::push(int32_t count, uint32_t nowUs) {
+  _head = (_head + 1) % RPM_RING_SIZE;
+  _ring[_head] = { count, nowUs };
+  if (_count < RPM_RING_SIZE) _count++;
+  estimate();
+}
+
+float RpmEstimator::rpmOver(int from, int to) const {
+  uint32_t dt = back(from).us - back(to).us; // resta sin signo: aguanta el desbordamiento de micros()
+  if (dt == 0) return 0.0f;
+  return (float)((back(from).count - back(to).count) / _stepsPerRev * 60e6 / dt);
+}
+
+void RpmEstimator::estimate() {
+  int available = _count - 1;
+  if (available < 1) return;
+
+  // Ventana larga: crece hasta RPM_MIN_STEPS pulsos o RPM_MAX_WINDOW_MS
+  int shortN = available < RPM_MIN_INTERVALS ? available : RPM_MIN_INTERVALS;
+  int longN = shortN;
+  while (longN < available &&
+         back(0).count - back(longN).count < RPM_MIN_STEPS &&
+         back(0).us - back(longN + 1).us <= (uint32_t)RPM_MAX_WINDOW_MS * 1000u) longN++;
+
+  float rpmShort = rpmOver(0, shortN);
+  float rpmLong = rpmOver(0, longN);
+
+  // Un pulso de diferencia en la ventana mínima, en RPM
+  uint32_t shortUs = back(0).us - back(shortN).us;
+  float quantum = shortUs ? (float)(60e6 / (_stepsPerRev * shortUs)) : 0.0f;
+  bool ramp = fabsf(rpmShort - rpmLong) > RPM_RAMP_QUANTA * quantum;
+  int n = ramp ? shortN : longN;
+
+  // Recta de mínimos cuadrados de la RPM por intervalo
+  int fitN = longN > RPM_FIT_INTERVALS ? longN : (available < RPM_FIT_INTERVALS ? available : RPM_FIT_INTERVALS);
+  float sx = 0, sy = 0, sxx = 0, sxy = 0;
+  float x[RPM_RING_SIZE], y[RPM_RING_SIZE];
+  for (int i = 0; i < fitN; ++i) {
+    // Centro del intervalo, en segundos respecto a la lectura más reciente
+    x[i] = -0.5e-6f * (float)((back(0).us - back(i).us) + (back(0).us - back(i + 1).us));
+    y[i] = rpmOver(i, i + 1);
+    sx += x[i]; sy += y[i]; sxx += x[i] * x[i]; sxy += x[i] * y[i];
+  }
+  float den = fitN * sxx - sx * sx;
+  float slope = (fitN > 1 && den > 0.0f) ? (fitN * sxy - sx * sy) / den : 0.0f;
+  float intercept = (sy - slope * sx) / fitN;
+  float sq = 0;
+  for (int i = 0; i < fitN; ++i) { float r = y[i] - (intercept + slope * x[i]); sq += r * r; }
+
+  _reading.rpm = ramp ? rpmShort : rpmLong;
+  _reading.jitter = fitN > 2 ? sqrtf(sq / (fitN - 2)) : 0.0f;
+  _reading.accel = slope;
+  _reading.windowMs = (uint16_t)((back(0).us - back(n).us) / 1000u);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================
+// Estimador de RPM a partir de pulsos STEP
+// ============================
+// Se alimenta con el contador acumulado de pulsos STEP (PCNT) y el instante
+// de la lectura, a ritmo fijo (RPM_SAMPLE_MS). Guarda las últimas lecturas en
+// un anillo y calcula la RPM sobre una ventana adaptativa:
+//  - a baja velocidad la ventana crece hasta reunir RPM_MIN_STEPS pulsos
+//    (resolución), sin pasar de RPM_MAX_WINDOW_MS;
+//  - si la RPM de la ventana mínima (RPM_MIN_INTERVALS intervalos) se aleja
+//    de la de la ventana larga más de lo que explica la cuantización, es una
+//    rampa y se usa la mínima para no ir con retraso.
+// La aceleración es la pendiente (mínimos cuadrados) de la RPM por intervalo
+// en al menos RPM_FIT_INTERVALS intervalos; el jitter, la dispersión alrededor de esa recta, así
+// que una rampa limpia no cuenta como jitter.
+// No depende de Arduino ni de FreeRTOS: se puede compilar en el host.
+#define RPM_SAMPLE_MS      10    // periodo de lectura del contador (100 Hz)
+#define RPM_RING_SIZE      64    // lecturas guardadas (640 ms)
+#define RPM_MIN_INTERVALS  4     // ventana mínima: 4 intervalos (40 ms)
+#define RPM_FIT_INTERVALS  20    // intervalos mínimos para la recta de aceleración/jitter
+#define RPM_MIN_STEPS      64    // pulsos que se intentan reunir por ventana
+#define RPM_MAX_WINDOW_MS  500
+#define RPM_RAMP_QUANTA    4     // diferencia (en pulsos de la ventana mínima) que indica rampa
+
+struct RpmReading {
+  float rpm;        // media en la ventana
+  float jitter;     // desviación típica respecto a la recta (incluye cuantización)
+  float accel;      // RPM/s
+  uint16_t windowMs;
+};
+
+class RpmEstimator {
+public:
+  explicit RpmEstimator(double stepsPerRev) : _stepsPerRev(stepsPerRev) { reset(0, 0); }
+
+  // Vacía el anillo; la siguiente medida parte de (count, nowUs)
+  void reset(int32_t count, uint32_t nowUs);
+  // Añade una lectura y recalcula la estimación
+  void push(int32_t count, uint32_t nowUs);
+  const RpmReading &reading() const { return _reading; }
+
+private:
+  struct Sample { int32_t count; uint32_t us; };
+
+  const Sample &back(int i) const { return _ring[(_head + RPM_RING_SIZE - i) % RPM_RING_SIZE]; }
+  float rpmOver(int from, int to) const; // RPM media entre back(to) y back(from), from < to
+  void estimate();
+
+  double _stepsPerRev;
+  Sample _ring[RPM_RING_SIZE];
+  int _head;   // índice de la lectura más reciente
+  int _count;  // lecturas válidas en el anillo
+  RpmReading _reading;
+};
@@ -0,0 +1,159 @@
+#include "speed_controller.h"
+
+#include <math.h>
+
+static int32_t toQ16(float v) { return (int32_t)lroundf(v * 65536.0f); }
+
+static int32_t toMilli(float rpm) {
+  // ±2000 RPM de sobra para MAX_RPM; evita desbordar los productos
+  if (rpm > 2000.0f) rpm = 2000.0f; else if (rpm < -2000.0f) rpm = -2000.0f;
+  return (int32_t)lroundf(rpm * 1000.0f);
+}
+
+// ===========================================================================
+// SpeedPi
+// ===========================================================================
+void SpeedPi::setGains(float kp, float ki) {
+  _kp = toQ16(kp);
+  _kiDt = toQ16(ki * SPEED_LOOP_MS / 1000.0f);
+}
+
+void SpeedPi::setLimit(float maxRpm) {
+  _limit = toMilli(maxRpm);
+  if (_integral > _limit) _integral = _limit; else if (_integral < -_limit) _integral = -_limit;
+}
+
+void SpeedPi::shiftIntegral(float rpm) {
+  _integral += toMilli(rpm);
+  if (_integral > _limit) _integral = _limit; else if (_integral < -_limit) _integral = -_limit;
+}
+
+float SpeedPi::update(float refRpm, float measuredRpm, bool integrate) {
+  int32_t e = toMilli(refRpm - measuredRpm);
+  int32_t p = (int32_t)(((int64_t)_kp * e) >> 16);
+  int32_t integral = _integral;
+  if (integrate) integral += (int32_t)(((int64_t)_kiDt * e) >> 16);
+  if (integral > _limit) integral = _limit; else if (integral < -_limit) integral = -_limit;
+
+  // Integración condicional: si la salida satura hacia donde empuja el error, no se integra
+  int32_t u = p + integral;
+  bool windup = (u > _limit && e > 0) || (u < -_limit && e < 0);
+  if (!windup) _integral = integral;
+
+  u = p + _integral;
+  _saturated = (u > _limit) || (u < -_limit);
+  if (u > _limit) u = _limit; else if (u < -_limit) u = -_limit;
+  return u / 1000.0f;
+}
+
+// ===========================================================================
+// StepTuner
+// ===========================================================================
+void StepTuner::begin(float u0Rpm, float maxRpm) {
+  _u0 = u0Rpm;
+  _du = u0Rpm * TUNE_STEP_FRACTION;
+  if (_du < TUNE_STEP_MIN_RPM) _du = TUNE_STEP_MIN_RPM;
+  if (_u0 + _du > maxRpm) _du = -_du;   // sin margen por arriba: escalón hacia abajo
+  _tick = 0; _y0Sum = 0;
+  _phase = SETTLE;
+}
+
+float StepTuner::update(float measuredRpm) {
+  switch (_phase) {
+    case SETTLE:
+      if (++_tick > SETTLE_TICKS - AVG_TICKS) _y0Sum += measuredRpm;
+      if (_tick < SETTLE_TICKS) return _u0;
+      _y0 = _y0Sum / AVG_TICKS;
+      _tick = 0; _phase = STEP;
+      return _u0 + _du;
+    case STEP:
+      _y[_tick++] = measuredRpm;
+      if (_tick < STEP_TICKS) return _u0 + _du;
+      fit();
+      return _u0;
+    default:
+      return _u0;
+  }
+}
+
+float StepTuner::crossing(float level) const {
+  const float dt = SPEED_LOOP_MS / 1000.0f;
+  float dy = _y1 - _y0;
+  float prevN = 0.0f, prevT = 0.0f;
+  for (int i = 0; i < STEP_TICKS; ++i) {
+    // La muestra i se mide (i + 1) periodos después de aplicar el escalón
+    float n = (_y[i] - _y0) / dy, t = (i + 1) * dt;
+    if (n >= level) return (n > prevN) ? prevT + (t - prevT) * (level - prevN) / (n - prevN) : t;
+    prevN = n; prevT = t;
+  }
+  return -1.0f;
+}
+
+void StepTuner::fit() {
+  float sum = 0;
+  for (int i = STEP_TICKS - AVG_TICKS; i < STEP_TICKS; ++i) sum += _y[i];
+  _y1 = sum / AVG_TICKS;
+  _k = (_y1 - _y0) / _du;
+  float t28 = crossing(0.283f), t63 = crossing(0.632f);
+  if (!(_k > 0.2f && _k < 5.0f) || t28 < 0.0f || t63 < t28) { _phase = FAILED; return; }
+
+  // Primer orden con retardo (Smith) y reglas SIMC
+  _t = 1.5f * (t63 - t28);
+  _l = t63 - _t; if (_l < 0.0f) _l = 0.0f;
+  float tc = _l > TUNE_MIN_TC ? _l : TUNE_MIN_TC;
+  float ti = _t < 4.0f * (tc + _l) ? _t : 4.0f * (tc + _l);
+  _kp = _t / (_k * (tc + _l));
+  _ki = ti > 1e-3f ? _kp / ti : 1.0f / (_k * (tc + _l));
+  _phase = DONE;
+}
+
+// ===========================================================================
+// SpeedLoop
+// ===========================================================================
+void SpeedLoop::reset(float fromRpm) {
+  _pi.reset();
+  _tuner.abort();
+  _refTarget = -1.0f;
+  _refNow = _lastCmd = fromRpm;
+  _refTicks = 0;
+  for (int i = 0; i <= SPEED_MAX_LAG; ++i) _refHistory[i] = fromRpm;
+}
+
+float SpeedLoop::step(float targetRpm, float measuredRpm, float maxAccel, float maxJerk) {
+  if (targetRpm != _refTarget) {
+    // Nueva consigna: la referencia parte de donde estaba, con la aceleración
+    // que llevaba (un ensayo en curso se cancela)
+    float refAccel = _ref.acceleration(_refTicks * (SPEED_LOOP_MS / 1000.0f));
+    _ref.plan(_refNow, targetRpm, maxAccel, maxJerk > 0.0f ? maxJerk : SPEED_LINEAR_JERK, refAccel);
+    _refTarget = targetRpm; _refTicks = 0;
+    _tuner.abort();
+  }
+  _refNow = _ref.velocity(++_refTicks * (SPEED_LOOP_MS / 1000.0f));
+  _refHead = (_refHead + 1) % (SPEED_MAX_LAG + 1);
+  _refHistory[_refHead] = _refNow;
+  float delayedRef = _refHistory[(_refHead + SPEED_MAX_LAG + 1 - _lag) % (SPEED_MAX_LAG + 1)];
+
+  if (_tuner.active()) {
+    _lastCmd = _tuner.update(measuredRpm);
+    if (_tuner.phase() == StepTuner::DONE) {
+      // La prealimentación absorbe ahora el error de ganancia: el integrador,
+      // que lo estaba corrigiendo, se pasa a la nueva prealimentación sin salto
+      float ffBefore = _refNow / _plantGain;
+      _plantGain = _tuner.gain();
+      _pi.setGains(_tuner.kp(), _tuner.ki());
+      _pi.shiftIntegral(ffBefore - _refNow / _plantGain);
+      _lag = (int)lroundf((_tuner.timeConstant() + _tuner.deadTime()) * 1000.0f / SPEED_LOOP_MS);
+      if (_lag > SPEED_MAX_LAG) _lag = SPEED_MAX_LAG;
+    }
+    return _lastCmd;
+  }
+  bool settled = (delayedRef == _refTarget);
+  _lastCmd = _refNow / _plantGain + _pi.update(delayedRef, measuredRpm, settled);
+  return _lastCmd;
+}
+
+bool SpeedLoop::startTuning(float maxRpm) {
+  if (_tuner.active() || _refNow != _refTarget || _refTarget < TUNE_MIN_RPM) return false;
+  _tuner.begin(_lastCmd, maxRpm);
+  return true;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <stdint.h>
+#include "motion_profile.h"
+
+// ============================
+// Control de velocidad en lazo cerrado
+// ============================
+// Opcional (/rpm?loop=closed). Cada SPEED_LOOP_MS la RPM comandada es la
+// referencia (rampa lineal o en S hacia la consigna) dividida por la ganancia
+// estática de la planta, más una corrección PI sobre el error referencia -
+// RPM medida retrasada lo que tarda la planta en responder (modelo de
+// referencia: retardo + constante de tiempo), así el PI no empuja contra el
+// retraso normal del driver y del estimador. La prealimentación hace casi
+// todo el trabajo: tras el autoajuste ya lleva corregida la diferencia
+// SPR_CMD/SPR_MEAS, y el PI se queda con el resto.
+// La RPM medida son los pulsos STEP del propio driver divididos por
+// SPR_MEAS, no un sensor en el eje: el lazo solo corrige la temporización
+// del driver y de su cola, y la "ganancia de la planta" del autoajuste es en
+// la práctica SPR_CMD/SPR_MEAS. La velocidad real sigue dependiendo de que
+// SPR_MEAS esté bien calibrado. Mientras la referencia está en rampa el
+// integrador no acumula: lo que quede de error de seguimiento en la rampa no
+// es un error de calibración y daría sobrepaso.
+// No depende de Arduino ni de FreeRTOS: la simulación del host (sim/) usa
+// exactamente este código.
+#define SPEED_LOOP_MS        20      // periodo fijo del lazo (50 Hz)
+#define SPEED_TRIM_MAX_RPM   60.0f   // corrección máxima del PI, ±RPM
+#define SPEED_LOOP_ACCEL     200.0f  // RPM/s del driver en lazo cerrado: sigue cada periodo sin limitar
+#define SPEED_LINEAR_JERK    1e6f    // "jerk" de la referencia lineal (rampa de aceleración casi instantánea)
+#define SPEED_DEFAULT_KP     0.2f    // hasta que se autoajuste
+#define SPEED_DEFAULT_KI     1.0f    // 1/s
+#define SPEED_DEFAULT_LAG    3       // retardo de la referencia, periodos (60 ms)
+#define SPEED_MAX_LAG        16      // tope del retardo de la referencia
+
+// Autoajuste: ensayo en escalón en lazo abierto alrededor de la consigna
+#define TUNE_MIN_RPM         30.0f   // consigna mínima para ensayar (por debajo la medida es gruesa)
+#define TUNE_SETTLE_MS       2000    // espera con el comando fijo antes del escalón
+#define TUNE_STEP_MS         3000    // registro de la respuesta al escalón
+#define TUNE_AVG_MS          500     // promedio para los niveles inicial y final
+#define TUNE_STEP_FRACTION   0.1f    // tamaño del escalón respecto a la consigna...
+#define TUNE_STEP_MIN_RPM    10.0f   // ...con este mínimo
+#define TUNE_MIN_TC          0.15f   // constante de tiempo mínima pedida al lazo (SIMC), s
+
+// PI en coma fija: ganancias Q16.16, error, integrador y salida en mRPM.
+// Anti-windup por integración condicional: el integrador no crece mientras
+// la salida está saturada en el mismo sentido que el error, y nunca pasa
+// del límite de la salida.
+class SpeedPi {
+public:
+  SpeedPi() { setGains(SPEED_DEFAULT_KP, SPEED_DEFAULT_KI); setLimit(SPEED_TRIM_MAX_RPM); reset(); }
+
+  void setGains(float kp, float ki);   // kp en RPM/RPM, ki en 1/s
+  void setLimit(float maxRpm);
+  void reset() { _integral = 0; }
+  // Suma `rpm` al integrador (cambio de prealimentación sin salto en la salida)
+  void shiftIntegral(float rpm);
+  // Un periodo: devuelve la corrección en RPM, saturada a ±límite
+  float update(float refRpm, float measuredRpm, bool integrate = true);
+
+  float kp() const { return _kp / 65536.0f; }
+  float ki() const { return _kiDt / 65536.0f * 1000.0f / SPEED_LOOP_MS; }
+  bool saturated() const { return _saturated; }
+
+private:
+  int32_t _kp;        // Q16.16
+  int32_t _kiDt;      // ki · SPEED_LOOP_MS, Q16.16
+  int32_t _limit;     // mRPM
+  int32_t _integral = 0;  // mRPM
+  bool _saturated = false;
+};
+
+// Ensayo en escalón: mantiene el comando en u0, salta a u0 ± du, ajusta un
+// modelo de primer orden con retardo (método de dos puntos de Smith: 28,3 %
+// y 63,2 %) y calcula kp/ki con las reglas SIMC.
+class StepTuner {
+public:
+  enum Phase { IDLE, SETTLE, STEP, DONE, FAILED };
+
+  void begin(float u0Rpm, float maxRpm);
+  void abort() { if (active()) _phase = IDLE; }   // un resultado DONE/FAILED se conserva
+  // Un periodo de lazo: devuelve la RPM a comandar en lazo abierto
+  float update(float measuredRpm);
+
+  Phase phase() const { return _phase; }
+  bool active() const { return _phase == SETTLE || _phase == STEP; }
+  // Resultado (válido en DONE)
+  float gain() const { return _k; }        // RPM medida / RPM comandada
+  float timeConstant() const { return _t; }
+  float deadTime() const { return _l; }
+  float kp() const { return _kp; }
+  float ki() const { return _ki; }
+
+private:
+  static const int SETTLE_TICKS = TUNE_SETTLE_MS / SPEED_LOOP_MS;
+  static const int STEP_TICKS = TUNE_STEP_MS / SPEED_LOOP_MS;
+  static const int AVG_TICKS = TUNE_AVG_MS / SPEED_LOOP_MS;
+
+  float crossing(float level) const;   // instante (s) en que la respuesta normalizada pasa `level`
+  void fit();
+
+  Phase _phase = IDLE;
+  float _u0 = 0, _du = 0;
+  int _tick = 0;
+  float _y0Sum = 0, _y0 = 0, _y1 = 0;
+  float _y[STEP_TICKS];
+  float _k = 0, _t = 0, _l = 0, _kp = 0, _ki = 0;
+};
+
+// Lazo completo, un paso por periodo: referencia + PI, o el ensayo de
+// autoajuste si está en marcha (al terminar bien carga las ganancias nuevas
+// y la ganancia de la planta para la prealimentación).
+class SpeedLoop {
+public:
+  SpeedLoop() { reset(0.0f); }
+
+  // Entra en lazo cerrado con la referencia en `fromRpm` (la velocidad actual)
+  void reset(float fromRpm);
+  // maxJerk <= 0: referencia lineal
+  float step(float targetRpm, float measuredRpm, float maxAccel, float maxJerk);
+
+  // Solo con la referencia ya en la consigna y consigna >= TUNE_MIN_RPM
+  bool startTuning(float maxRpm);
+  void stopTuning() { _tuner.abort(); }
+
+  float reference() const { return _refNow; }
+  float plantGain() const { return _plantGain; }
+  int lagTicks() const { return _lag; }
+  const SpeedPi &pi() const { return _pi; }
+  SpeedPi &pi() { return _pi; }
+  const StepTuner &tuner() const { return _tuner; }
+
+private:
+  SpeedPi _pi;
+  StepTuner _tuner;
+  SCurveProfile _ref;
+  uint32_t _refTicks = 0;   // periodos desde que se planificó la referencia
+  float _refTarget = -1.0f;
+  float _refNow = 0.0f;
+  float _refHistory[SPEED_MAX_LAG + 1];  // referencia de los últimos periodos (anillo)
+  int _refHead = 0;
+  int _lag = SPEED_DEFAULT_LAG;          // periodos que la planta va detrás de la referencia
+  float _lastCmd = 0.0f;    // última RPM comandada (punto de partida del ensayo)
+  float _plantGain = 1.0f;  // RPM medida / RPM comandada; la estima el autoajuste
+};
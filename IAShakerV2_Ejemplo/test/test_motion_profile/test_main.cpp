@@ -0,0 +1,136 @@
+// Pruebas del perfil en S en el host: pio test -e test
+#include <math.h>
+#include <unity.h>
+
+#include "../../src/motion_profile.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Trapezoidal: Δv = 100 >= A²/J = 10 → tj = 0,5 s, ta = 4,5 s, dura 5,5 s
+static void test_trapezoidal_closed_form() {
+  const float A = 20.0f, J = 40.0f;
+  SCurveProfile p;
+  p.plan(0.0f, 100.0f, A, J);
+
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 5.5f, p.duration());
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, A, p.peakAccel());
+  // Jerk subiendo: v = J·t²/2, a = J·t
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f * J * 0.25f * 0.25f, p.velocity(0.25f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, J * 0.25f, p.acceleration(0.25f));
+  // Aceleración constante: v = J·tj²/2 + A·(t - tj)
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f * J * 0.25f + A * 2.5f, p.velocity(3.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, A, p.acceleration(3.0f));
+  // Jerk bajando: v = v1 - J·r²/2, a = J·r con r = T - t
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 100.0f - 0.5f * J * 0.25f * 0.25f, p.velocity(5.25f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, J * 0.25f, p.acceleration(5.25f));
+  // Fuera del perfil
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, p.velocity(-1.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 100.0f, p.velocity(10.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, p.acceleration(10.0f));
+}
+
+// Triangular frenando: Δv = 5 < A²/J → tj = sqrt(Δv/J), pico J·tj < A
+static void test_triangular_closed_form() {
+  const float A = 20.0f, J = 40.0f;
+  SCurveProfile p;
+  p.plan(100.0f, 95.0f, A, J);
+
+  float tj = sqrtf(5.0f / J);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.0f * tj, p.duration());
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, J * tj, p.peakAccel());
+  TEST_ASSERT_TRUE(p.peakAccel() < A);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 100.0f - 0.5f * J * 0.04f, p.velocity(0.2f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, -J * 0.2f, p.acceleration(0.2f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 97.5f, p.velocity(tj));
+  float r = 0.1f;
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 95.0f + 0.5f * J * r * r, p.velocity(2.0f * tj - r));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, -J * r, p.acceleration(2.0f * tj - r));
+}
+
+// La velocidad es la integral de la aceleración, también con a0 != 0
+static void checkIntegral(const SCurveProfile &p, float v0) {
+  const float dt = 1e-4f;
+  double v = v0;
+  for (float t = 0.0f; t < p.duration(); t += dt) {
+    v += 0.5 * (p.acceleration(t) + p.acceleration(t + dt)) * dt;
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, p.velocity(t + dt), (float)v);
+  }
+}
+
+static void test_velocity_is_integral_of_acceleration() {
+  SCurveProfile p;
+  p.plan(0.0f, 100.0f, 20.0f, 40.0f);        checkIntegral(p, 0.0f);
+  p.plan(100.0f, 95.0f, 20.0f, 40.0f);       checkIntegral(p, 100.0f);
+  p.plan(50.0f, 120.0f, 20.0f, 40.0f, 15.0f); checkIntegral(p, 50.0f);
+  p.plan(50.0f, 20.0f, 20.0f, 40.0f, 15.0f);  checkIntegral(p, 50.0f);
+  p.plan(50.0f, 52.0f, 20.0f, 40.0f, 15.0f);  checkIntegral(p, 50.0f);  // se pasa y vuelve
+}
+
+// Los tramos suman la duración (redondeada a ms) y terminan en v1
+static void test_segments_sum_to_duration() {
+  struct Case { float v0, v1, a, j, a0; };
+  static const Case CASES[] = {
+    { 0.0f, 100.0f, 20.0f, 40.0f, 0.0f },
+    { 100.0f, 95.0f, 20.0f, 40.0f, 0.0f },
+    { 0.0f, 3000.0f, 500.0f, 200.0f, 0.0f },
+    { 10.0f, 10.5f, 20.0f, 1e6f, 0.0f },
+    { 50.0f, 120.0f, 20.0f, 40.0f, 15.0f },
+    { 50.0f, 20.0f, 20.0f, 40.0f, -20.0f },
+  };
+  for (const Case &c : CASES) {
+    SCurveProfile p;
+    p.plan(c.v0, c.v1, c.a, c.j, c.a0);
+    ProfileSegment segs[MOTION_MAX_SEGMENTS];
+    int n = p.segments(segs);
+    TEST_ASSERT_TRUE(n > 0 && n <= MOTION_MAX_SEGMENTS);
+    uint32_t total = 0;
+    for (int i = 0; i < n; ++i) total += segs[i].ms;
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)lroundf(p.duration() * 1000.0f), total);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, c.v1, segs[n - 1].speed);
+  }
+}
+
+static void test_peak_accel_within_limit() {
+  for (float dv = 0.5f; dv < 2000.0f; dv *= 1.7f) {
+    for (float a = 1.0f; a < 1000.0f; a *= 3.0f) {
+      for (float j = 1.0f; j < 10000.0f; j *= 5.0f) {
+        SCurveProfile p;
+        p.plan(0.0f, dv, a, j);
+        TEST_ASSERT_TRUE(p.peakAccel() <= a * (1.0f + 1e-5f));
+        p.plan(dv, 0.0f, a, j, -0.5f * a);
+        TEST_ASSERT_TRUE(p.peakAccel() <= a * (1.0f + 1e-5f));
+        for (float t = 0.0f; t < p.duration(); t += p.duration() / 50.0f) {
+          TEST_ASSERT_TRUE(fabsf(p.acceleration(t)) <= a * (1.0f + 1e-5f));
+        }
+      }
+    }
+  }
+}
+
+// Replanificar a mitad de rampa con la aceleración actual no da salto
+static void test_replan_keeps_acceleration() {
+  SCurveProfile p;
+  p.plan(0.0f, 100.0f, 20.0f, 40.0f);
+  float t = 2.0f;
+  float a0 = p.acceleration(t);
+  SCurveProfile q;
+  q.plan(p.velocity(t), 20.0f, 20.0f, 40.0f, a0);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, a0, q.acceleration(1e-6f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, p.velocity(t), q.velocity(0.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 20.0f, q.velocity(q.duration()));
+  // De +20 a -20 con jerk 40 (1 s), 0,5 s a -20 y 0,5 s de vuelta a 0
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.0f, q.duration());
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, -20.0f, q.acceleration(1.25f));
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_trapezoidal_closed_form);
+  RUN_TEST(test_triangular_closed_form);
+  RUN_TEST(test_velocity_is_integral_of_acceleration);
+  RUN_TEST(test_segments_sum_to_duration);
+  RUN_TEST(test_peak_accel_within_limit);
+  RUN_TEST(test_replan_keeps_acceleration);
+  return UNITY_END();
+}
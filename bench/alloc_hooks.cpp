@@ -0,0 +1,48 @@
+#include "benchmark.h"
+
+#include <stdlib.h>
+
+// Heap accounting for allocs_per_op/bytes_per_op. malloc, calloc and realloc
+// are interposed (operator new goes through malloc in libstdc++) and counted
+// only on a thread whose timing loop is running, so the render thread and
+// the harness itself stay out of the figures.
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+namespace benchmark {
+namespace internal {
+
+static thread_local bool tracking = false;
+static thread_local uint64_t allocations = 0;
+static thread_local uint64_t allocatedBytes = 0;
+
+void setTracking(bool on) { tracking = on; }
+
+void noteAllocation(size_t size) {
+    if (!tracking) return;
+    allocations++;
+    allocatedBytes += size;
+}
+
+uint64_t allocationCount() { return allocations; }
+uint64_t allocationBytes() { return allocatedBytes; }
+
+} // namespace internal
+} // namespace benchmark
+
+extern "C" void* malloc(size_t size) {
+    benchmark::internal::noteAllocation(size);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    benchmark::internal::noteAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    benchmark::internal::noteAllocation(size);
+    return __libc_realloc(ptr, size);
+}
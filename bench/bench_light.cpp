@@ -0,0 +1,119 @@
+// Stages of POST /api/light, from the request body to the pixels and NVS.
+
+#include "benchmark.h"
+#include "fixture.h"
+
+#include <ArduinoJson.h>
+#include <FastLED.h>
+#include <Preferences.h>
+#include "../src/drivers/led_driver.h"
+#include "../src/drivers/led_timing.h"
+#include "../src/drivers/light_store.h"
+#include "../src/web/rest.h"
+
+extern LedDriver ledDriver;
+extern LightStore lightStore;
+extern RestApi restApi;
+
+static const char LIGHT_BODY[] = "{\"r\":12,\"g\":200,\"b\":34,\"intensity\":80}";
+static const char LIGHT_BODY_ALT[] = "{\"r\":200,\"g\":12,\"b\":34,\"intensity\":60}";
+static const char LIGHT_BODY_BAD[] = "{\"r\":12,\"g\":300,\"b\":34,\"intensity\":80}";
+
+// deserializeJson() of a typical body, as AsyncCallbackJsonWebHandler does
+static void BM_PostLight_Parse(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, LIGHT_BODY);
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(doc);
+    }
+}
+BENCHMARK(BM_PostLight_Parse);
+
+// Parse + field validation + 400 reply: nothing is applied
+static void BM_PostLight_Rejected(benchmark::State& state) {
+    bench::server();
+    for (auto _ : state) {
+        AsyncWebServerRequest request(HTTP_POST, "/api/light", LIGHT_BODY_BAD, "application/json");
+        if (!bench::handle(state, request, 400)) break;
+    }
+}
+BENCHMARK(BM_PostLight_Rejected);
+
+// applyLight(): globals, render mailbox and LightStore RAM record
+static void BM_PostLight_Apply(benchmark::State& state) {
+    bench::boot();
+    uint8_t i = 0;
+    for (auto _ : state) {
+        restApi.applyLight(i, 255 - i, 34, 80, 0);
+        i++;
+    }
+    ledDriver.renderOnce();
+}
+BENCHMARK(BM_PostLight_Apply);
+
+// setColor() + one render frame (pixel fill, FastLED.show) for an N-pixel strip.
+// wire_us is what the WS2811 transfer of that frame takes on the device.
+static void BM_PostLight_Render(benchmark::State& state) {
+    bench::boot();
+    SegmentLayout saved;
+    ledDriver.getLayout(saved);
+
+    SegmentLayout layout = {};
+    layout.count = 1;
+    layout.segments[0] = { 0, (uint16_t)state.range(0), ORDER_GRB, 0 };
+    ledDriver.setLayout(layout);
+    ledDriver.renderOnce();
+
+    uint32_t shows = FastLED.hostShowCount();
+    uint8_t i = 0;
+    for (auto _ : state) {
+        ledDriver.setColor(i, 255 - i, 34, 80);
+        ledDriver.renderOnce();
+        i++;
+    }
+    state.counters["shows_per_op"] = (double)(FastLED.hostShowCount() - shows) / state.iterations();
+    state.counters["wire_us"] = parallelFrameUs(layout);
+
+    ledDriver.setLayout(saved);
+    ledDriver.renderOnce();
+}
+BENCHMARK(BM_PostLight_Render)->Arg(DEFAULT_NUM_LEDS)->Arg(150)->Arg(MAX_LEDS);
+
+// A changed state committed to NVS (update + flush, i.e. without coalescing)
+static void BM_PostLight_Persist(benchmark::State& state) {
+    bench::boot();
+    uint32_t writes = Preferences::hostWriteCount();
+    uint8_t i = 0;
+    for (auto _ : state) {
+        lightStore.update(i, 255 - i, 34, 80);
+        lightStore.flush();
+        i++;
+    }
+    state.counters["nvs_writes_per_op"] = (double)(Preferences::hostWriteCount() - writes) / state.iterations();
+}
+BENCHMARK(BM_PostLight_Persist);
+
+// The whole request through the server, the next render frame included.
+// NVS is left to the quiet period, as on the device.
+static void BM_PostLight_EndToEnd(benchmark::State& state) {
+    bench::server();
+    bool alt = false;
+    for (auto _ : state) {
+        AsyncWebServerRequest request(HTTP_POST, "/api/light", alt ? LIGHT_BODY_ALT : LIGHT_BODY, "application/json");
+        if (!bench::handle(state, request, 200)) break;
+        ledDriver.renderOnce();
+        alt = !alt;
+    }
+    lightStore.flush();
+}
+BENCHMARK(BM_PostLight_EndToEnd);
+
+static void BM_GetLight(benchmark::State& state) {
+    bench::server();
+    for (auto _ : state) {
+        AsyncWebServerRequest request(HTTP_GET, "/api/light");
+        if (!bench::handle(state, request, 200)) break;
+    }
+}
+BENCHMARK(BM_GetLight);
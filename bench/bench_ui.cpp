@@ -0,0 +1,53 @@
+// LCD translations and WiFi scan result serialization.
+
+#include "benchmark.h"
+#include "fixture.h"
+
+#include <Arduino.h>
+#include "../src/i18n.h"
+#include "../src/web/wifi_scan.h"
+
+extern WifiScanService wifiScan;
+
+// Keys looked up by one home screen redraw
+static const TrKey HOME_KEYS[] = { TR_HOME_RED, TR_HOME_GREEN, TR_HOME_BLUE, TR_HOME_LIGHT };
+
+static void BM_Tr(benchmark::State& state) {
+    bench::boot();
+    Lang saved = currentLang;
+    currentLang = (Lang)state.range(0);
+    for (auto _ : state) {
+        for (TrKey key : HOME_KEYS) {
+            const char* s = tr(key);
+            benchmark::DoNotOptimize(s);
+        }
+    }
+    currentLang = saved;
+    state.SetLabel("4 keys per op");
+}
+BENCHMARK(BM_Tr)->Arg(ES)->Arg(EN);
+
+// GET /api/wifi/results with a full cache
+static void BM_ScanResults_Http(benchmark::State& state) {
+    bench::server();
+    bench::fillScanResults();
+    for (auto _ : state) {
+        AsyncWebServerRequest request(HTTP_GET, "/api/wifi/results");
+        if (!bench::handle(state, request, 200)) break;
+        state.counters["bytes"] = request.hostResponseBody().length();
+    }
+}
+BENCHMARK(BM_ScanResults_Http);
+
+// The same list as pushed to /events clients
+static void BM_ScanResults_Sse(benchmark::State& state) {
+    bench::fillScanResults();
+    char buf[1536]; // WebServer::SCAN_JSON_LEN
+    size_t len = 0;
+    for (auto _ : state) {
+        len = wifiScan.writeJson(buf, sizeof(buf));
+        benchmark::DoNotOptimize(buf);
+    }
+    state.counters["bytes"] = len;
+}
+BENCHMARK(BM_ScanResults_Sse);
@@ -0,0 +1,278 @@
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <regex>
+
+namespace benchmark {
+
+static uint64_t realNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t cpuNowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void State::startTiming() {
+    _running = true;
+    _realStart = realNowNs();
+    _cpuStart = cpuNowNs();
+    internal::setTracking(true);
+}
+
+void State::PauseTiming() {
+    if (!_running) return;
+    internal::setTracking(false);
+    _cpuNs += cpuNowNs() - _cpuStart;
+    _realNs += realNowNs() - _realStart;
+    _running = false;
+}
+
+void State::ResumeTiming() {
+    if (_running) return;
+    startTiming();
+}
+
+void State::finishTiming() {
+    PauseTiming();
+    _finished = true;
+}
+
+// ---------------------------------------------------------------------------
+// Registry and runner
+// ---------------------------------------------------------------------------
+static std::vector<Registration*>& registry() {
+    static std::vector<Registration*> list;
+    return list;
+}
+
+Registration::Registration(const char* name, Function fn) : _name(name), _fn(fn) {
+    registry().push_back(this);
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double realNs;
+    double cpuNs;
+    double allocs;
+    double allocBytes;
+    std::string label;
+    std::string error;
+    std::map<std::string, double> counters;
+};
+
+class Runner {
+public:
+    static constexpr uint64_t MAX_ITERATIONS = 1000000000ull;
+
+    explicit Runner(double minTimeS) : _minTimeNs(minTimeS * 1e9) {}
+
+    Result run(Registration& reg, const std::vector<int64_t>& args, const std::string& name) {
+        // Same growth rule as Google Benchmark: aim 40% past min_time, at
+        // most 10x per round.
+        uint64_t iterations = 1;
+        for (;;) {
+            State state(iterations, args);
+            uint64_t allocs0 = internal::allocationCount();
+            uint64_t bytes0 = internal::allocationBytes();
+            reg._fn(state);
+            state._allocs = internal::allocationCount() - allocs0;
+            state._allocBytes = internal::allocationBytes() - bytes0;
+
+            double elapsed = (double)state._realNs;
+            if (!state._error.empty() || elapsed >= _minTimeNs || iterations >= MAX_ITERATIONS) {
+                return collect(state, name);
+            }
+            double multiplier = elapsed > 0 ? _minTimeNs * 1.4 / elapsed : 10.0;
+            if (multiplier > 10.0) multiplier = 10.0;
+            uint64_t next = (uint64_t)(iterations * multiplier);
+            iterations = next > iterations ? next : iterations + 1;
+        }
+    }
+
+private:
+    double _minTimeNs;
+
+    static Result collect(const State& state, const std::string& name) {
+        Result r;
+        r.name = name;
+        r.iterations = state._iterations;
+        double n = state._iterations ? (double)state._iterations : 1.0;
+        r.realNs = state._realNs / n;
+        r.cpuNs = state._cpuNs / n;
+        r.allocs = state._allocs / n;
+        r.allocBytes = state._allocBytes / n;
+        r.label = state._label;
+        r.error = state._error;
+        if (!state._finished && r.error.empty()) r.error = "benchmark did not run its timing loop";
+        r.counters = state.counters;
+        return r;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+static void writeJsonString(FILE* out, const std::string& s) {
+    fputc('"', out);
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            fputc('\\', out);
+            fputc(c, out);
+        } else if ((unsigned char)c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void writeJson(FILE* out, const std::vector<Result>& results) {
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+    char host[64] = "";
+    gethostname(host, sizeof(host) - 1);
+
+    fprintf(out, "{\n  \"context\": {\n    \"date\": ");
+    writeJsonString(out, date);
+    fprintf(out, ",\n    \"host_name\": ");
+    writeJsonString(out, host);
+    fprintf(out, ",\n    \"executable\": \"biolighting-bench\",\n    \"num_cpus\": %ld,\n",
+            sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef NDEBUG
+    fprintf(out, "    \"library_build_type\": \"release\"\n  },\n");
+#else
+    fprintf(out, "    \"library_build_type\": \"debug\"\n  },\n");
+#endif
+    fprintf(out, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(out, "    {\n      \"name\": ");
+        writeJsonString(out, r.name);
+        fprintf(out, ",\n      \"run_name\": ");
+        writeJsonString(out, r.name);
+        fprintf(out, ",\n      \"run_type\": \"iteration\",\n");
+        if (!r.error.empty()) {
+            fprintf(out, "      \"error_occurred\": true,\n      \"error_message\": ");
+            writeJsonString(out, r.error);
+            fprintf(out, ",\n");
+        }
+        fprintf(out, "      \"iterations\": %llu,\n", (unsigned long long)r.iterations);
+        fprintf(out, "      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\",\n",
+                r.realNs, r.cpuNs);
+        fprintf(out, "      \"allocs_per_op\": %.3f,\n      \"bytes_per_op\": %.1f", r.allocs, r.allocBytes);
+        for (const auto& c : r.counters) {
+            fprintf(out, ",\n      ");
+            writeJsonString(out, c.first);
+            fprintf(out, ": %.6g", c.second);
+        }
+        if (!r.label.empty()) {
+            fprintf(out, ",\n      \"label\": ");
+            writeJsonString(out, r.label);
+        }
+        fprintf(out, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void writeRow(const Result& r) {
+    if (!r.error.empty()) {
+        fprintf(stderr, "%-40s ERROR: %s\n", r.name.c_str(), r.error.c_str());
+        return;
+    }
+    fprintf(stderr, "%-40s %12.1f ns %12.1f ns %10llu %8.2f allocs %9.1f B", r.name.c_str(), r.realNs, r.cpuNs,
+            (unsigned long long)r.iterations, r.allocs, r.allocBytes);
+    for (const auto& c : r.counters) fprintf(stderr, " %s=%g", c.first.c_str(), c.second);
+    if (!r.label.empty()) fprintf(stderr, " %s", r.label.c_str());
+    fputc('\n', stderr);
+}
+
+static const char* flagValue(const char* arg, const char* name) {
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len) != 0 || arg[len] != '=') return nullptr;
+    return arg + len + 1;
+}
+
+int runAll(int argc, char** argv) {
+    std::string filter = ".";
+    double minTime = 0.5;
+    const char* outPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* v;
+        if ((v = flagValue(argv[i], "--benchmark_filter"))) {
+            filter = v;
+        } else if ((v = flagValue(argv[i], "--benchmark_min_time"))) {
+            minTime = atof(v); // "0.5" and "0.5s" both parse
+        } else if ((v = flagValue(argv[i], "--benchmark_out"))) {
+            outPath = v;
+        } else if (strcmp(argv[i], "--benchmark_list_tests") == 0) {
+            for (Registration* reg : registry()) printf("%s\n", reg->_name.c_str());
+            return 0;
+        } else {
+            fprintf(stderr, "usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<s>] "
+                    "[--benchmark_out=<file>] [--benchmark_list_tests]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::regex pattern;
+    try {
+        pattern = std::regex(filter);
+    } catch (const std::regex_error&) {
+        fprintf(stderr, "invalid --benchmark_filter: %s\n", filter.c_str());
+        return 1;
+    }
+
+    Runner runner(minTime);
+    std::vector<Result> results;
+    fprintf(stderr, "%-40s %15s %15s %10s\n", "Benchmark", "Time", "CPU", "Iterations");
+    for (Registration* reg : registry()) {
+        std::vector<std::vector<int64_t>> argSets;
+        if (reg->_args.empty()) {
+            argSets.push_back({});
+        } else {
+            for (int64_t a : reg->_args) argSets.push_back({ a });
+        }
+        for (const auto& args : argSets) {
+            std::string name = reg->_name;
+            for (int64_t a : args) name += "/" + std::to_string(a);
+            if (!std::regex_search(name, pattern)) continue;
+            results.push_back(runner.run(*reg, args, name));
+            writeRow(results.back());
+        }
+    }
+
+    FILE* out = stdout;
+    if (outPath) {
+        out = fopen(outPath, "w");
+        if (!out) {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            return 1;
+        }
+    }
+    writeJson(out, results);
+    if (out != stdout) fclose(out);
+
+    for (const Result& r : results) {
+        if (!r.error.empty()) return 1;
+    }
+    return 0;
+}
+
+} // namespace benchmark
+
+int main(int argc, char** argv) {
+    return benchmark::runAll(argc, argv);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// The subset of the Google Benchmark API the BioLighting benchmarks use,
+// small enough to build with the rest of the native environment:
+//
+//   static void BM_Thing(benchmark::State& state) {
+//       for (auto _ : state) { ... }
+//       state.counters["widgets"] = 3;
+//   }
+//   BENCHMARK(BM_Thing)->Arg(4)->Arg(600);
+//
+// Every run also reports the heap allocations made by the benchmark thread
+// while timing was running (allocs_per_op, bytes_per_op). Output is the
+// Google Benchmark JSON format, so its compare.py can diff two builds.
+namespace benchmark {
+
+class State {
+public:
+    struct __attribute__((unused)) Value {};
+
+    class Iterator {
+    public:
+        Iterator(State* state, uint64_t left) : _state(state), _left(left) {}
+        Value operator*() const { return Value(); }
+        Iterator& operator++() { --_left; return *this; }
+        bool operator!=(const Iterator&) {
+            if (_left != 0 && _state->_error.empty()) return true;
+            _state->finishTiming();
+            return false;
+        }
+
+    private:
+        State* _state;
+        uint64_t _left;
+    };
+
+    State(uint64_t iterations, const std::vector<int64_t>& args) : _iterations(iterations), _args(args) {}
+
+    Iterator begin() { startTiming(); return Iterator(this, _iterations); }
+    Iterator end() { return Iterator(this, 0); }
+
+    void PauseTiming();
+    void ResumeTiming();
+    void SetLabel(const std::string& label) { _label = label; }
+    // Ends the timing loop and reports the run as failed
+    void SkipWithError(const char* message) { _error = message; }
+
+    int64_t range(size_t index = 0) const { return index < _args.size() ? _args[index] : 0; }
+    uint64_t iterations() const { return _iterations; }
+
+    std::map<std::string, double> counters;
+
+private:
+    friend class Runner;
+
+    uint64_t _iterations;
+    std::vector<int64_t> _args;
+    std::string _label;
+    std::string _error;
+    bool _running = false;
+    bool _finished = false;
+    uint64_t _realNs = 0;
+    uint64_t _cpuNs = 0;
+    uint64_t _realStart = 0;
+    uint64_t _cpuStart = 0;
+    uint64_t _allocs = 0;
+    uint64_t _allocBytes = 0;
+
+    void startTiming();
+    void finishTiming();
+};
+
+typedef void (*Function)(State&);
+
+// Parses the --benchmark_* flags, runs the selected benchmarks and writes the
+// JSON report. Returns the process exit code.
+int runAll(int argc, char** argv);
+
+class Registration {
+public:
+    Registration(const char* name, Function fn);
+    Registration* Arg(int64_t value) { _args.push_back(value); return this; }
+
+private:
+    friend class Runner;
+    friend int runAll(int argc, char** argv);
+    std::string _name;
+    Function _fn;
+    std::vector<int64_t> _args;
+};
+
+// Keeps `value` (and whatever produced it) from being optimised away
+template <typename T>
+inline void DoNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void ClobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+// Heap accounting for the calling thread (see alloc_hooks.cpp)
+namespace internal {
+void setTracking(bool on);
+void noteAllocation(size_t size);
+uint64_t allocationCount();
+uint64_t allocationBytes();
+}
+
+} // namespace benchmark
+
+#define BENCHMARK_CONCAT2(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT2(a, b)
+#define BENCHMARK(fn) \
+    static ::benchmark::Registration* BENCHMARK_CONCAT(bench_reg_, __LINE__) __attribute__((unused)) = \
+        (new ::benchmark::Registration(#fn, fn))
@@ -0,0 +1,66 @@
+#include "benchmark.h"
+#include "fixture.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "../src/config.h"
+#include "../src/web/rest.h"
+#include "../src/web/wifi_scan.h"
+
+extern RestApi restApi;
+extern WifiScanService wifiScan;
+
+namespace bench {
+
+void boot() {
+    static bool booted = false;
+    if (booted) return;
+    booted = true;
+    Serial.setQuiet(true);
+    setup();
+}
+
+AsyncWebServer& server() {
+    static AsyncWebServer* instance = nullptr;
+    if (!instance) {
+        boot();
+        instance = new AsyncWebServer(80);
+        restApi.registerHandlers(*instance);
+    }
+    return *instance;
+}
+
+void fillScanResults() {
+    static bool filled = false;
+    boot();
+    if (filled) return;
+    filled = true;
+
+    static char ssids[WIFI_SCAN_MAX_RESULTS + 4][33];
+    static HostNetwork networks[WIFI_SCAN_MAX_RESULTS + 4];
+    for (int i = 0; i < WIFI_SCAN_MAX_RESULTS + 4; i++) {
+        // Long SSIDs with characters that need escaping, to hit the worst case
+        snprintf(ssids[i], sizeof(ssids[i]), "Invernadero \"Nave %02d\" \\ 2.4GHz", i);
+        networks[i] = { ssids[i], (int8_t)(-40 - i), (uint8_t)(1 + i % 13),
+                        i % 3 ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN };
+    }
+    WiFi.hostSetNetworks(networks, WIFI_SCAN_MAX_RESULTS + 4);
+    WiFi.hostSetScanDuration(0);
+    wifiScan.request(true);
+    while (!wifiScan.hasResults()) {
+        wifiScan.loop();
+        delay(1);
+    }
+}
+
+bool handle(benchmark::State& state, AsyncWebServerRequest& request, int expectedCode) {
+    server().hostHandle(request);
+    if (request.hostResponseCode() == expectedCode) return true;
+    char message[96];
+    snprintf(message, sizeof(message), "%s answered %d, expected %d", request.url().c_str(),
+             request.hostResponseCode(), expectedCode);
+    state.SkipWithError(message);
+    return false;
+}
+
+} // namespace bench
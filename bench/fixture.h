@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include "benchmark.h"
+
+// Shared state for the benchmarks: the firmware globals from main.cpp, set up
+// once as on boot (hardware fakes, NVS and LittleFS empty), plus a server with
+// only the REST handlers registered.
+namespace bench {
+
+void boot();
+AsyncWebServer& server();
+
+// Completes one WiFi scan of WIFI_SCAN_MAX_RESULTS + 4 networks so the
+// results cache is full.
+void fillScanResults();
+
+// Runs `request` through server() and fails the benchmark on an unexpected
+// status code.
+bool handle(benchmark::State& state, AsyncWebServerRequest& request, int expectedCode);
+
+} // namespace bench
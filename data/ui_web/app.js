@@ -3,7 +3,7 @@
 let lang;
 let translations;
 let dom;
-let testModeInterval = null;
+let testModeActive = false;
 let previewState = { r: 0, g: 0, b: 0, intensity: 100 };
 
 const stages = {
@@ -22,8 +22,16 @@ const AURORA_KEYFRAMES = [
     { r: 120, g: 80,  b: 255 },   // violeta
     { r: 0,   g: 160, b: 255 },   // azul eléctrico
 ];
-const FRAME_MS = 100;              // 0.1 s por paso
-const STEPS_PER_TRANSITION = 5;    // 5 * 100 ms = 0.5 s de transición
+const TRANSITION_MS = 500;         // 0.5 s de transición (interpolada en el dispositivo)
+const AURORA_PROGRAM = 'aurora';   // nombre del programa guardado en el dispositivo
+
+// Canal en vivo: tramas binarias de 5 bytes (r, g, b, intensidad, flags) por /ws
+const WS_FLAG_FADE = 0x01;         // el dispositivo interpola en vez de saltar
+const WS_FLAG_PREVIEW = 0x02;      // se muestra pero no se guarda
+const WS_ECHO_GUARD_MS = 300;      // ignora ecos mientras el usuario arrastra
+let socket = null;
+let lastFrameSentAt = 0;
+let previewFrameQueued = false;
 
 document.addEventListener('DOMContentLoaded', () => {
     // --- i18n Translations ---
@@ -172,6 +180,7 @@ document.addEventListener('DOMContentLoaded', () => {
             stopTestMode();
             const value = parseInt(e.target.value, 10);
             updatePreviewControls({ [key]: isNaN(value) ? 0 : value });
+            streamPreview();
         });
     });
 
@@ -184,6 +193,7 @@ document.addEventListener('DOMContentLoaded', () => {
             if (value > 255) value = 255;
             if (value < 0) value = 0;
             updatePreviewControls({ [key]: value });
+            streamPreview();
         });
     });
 
@@ -193,6 +203,7 @@ document.addEventListener('DOMContentLoaded', () => {
         const rgb = hexToRgb(e.target.value);
         if (rgb) {
             updatePreviewControls(rgb);
+            streamPreview();
         }
     });
 
@@ -234,7 +245,7 @@ function setLang(l) {
     dom.buttons.apply.textContent = t.applyButton;
     dom.wifiStatusLabel.textContent = t.wifiStatusLabel;
     dom.ipLabel.textContent = t.ipLabel;
-    if (dom.buttons.testMode) dom.buttons.testMode.textContent = testModeInterval ? t.stopTestMode : t.testMode;
+    if (dom.buttons.testMode) dom.buttons.testMode.textContent = testModeActive ? t.stopTestMode : t.testMode;
 
     // Update stage buttons
     if (dom.buttons.off) dom.buttons.off.textContent = t.btnOff;
@@ -283,6 +294,10 @@ const confirmAndSetColor = (state, text = null) => {
 
 const setColor = async (state) => {
     stopTestMode();
+    if (sendLightFrame(state, WS_FLAG_FADE)) {
+        updateUi(state);
+        return;
+    }
     try {
         const response = await fetch('/api/light', {
             method: 'POST',
@@ -322,6 +337,41 @@ const fetchWifiState = async () => {
     }
 };
 
+// --- Canal en vivo (WebSocket) ---
+const connectSocket = () => {
+    socket = new WebSocket(`ws://${window.location.host}/ws`);
+    socket.binaryType = 'arraybuffer';
+    socket.onmessage = (event) => {
+        if (typeof event.data === 'string') {
+            updateWifiUi(JSON.parse(event.data));
+        } else if (Date.now() - lastFrameSentAt > WS_ECHO_GUARD_MS) {
+            const [r, g, b, intensity] = new Uint8Array(event.data);
+            updateUi({ r, g, b, intensity });
+        }
+    };
+    socket.onclose = () => {
+        socket = null;
+        setTimeout(connectSocket, 2000);
+    };
+};
+
+const sendLightFrame = (state, flags) => {
+    if (!socket || socket.readyState !== WebSocket.OPEN) return false;
+    socket.send(new Uint8Array([state.r, state.g, state.b, state.intensity, flags]));
+    lastFrameSentAt = Date.now();
+    return true;
+};
+
+// Envía la vista previa como mucho una vez por cuadro de pantalla
+const streamPreview = () => {
+    if (previewFrameQueued) return;
+    previewFrameQueued = true;
+    requestAnimationFrame(() => {
+        previewFrameQueued = false;
+        sendLightFrame(previewState, WS_FLAG_PREVIEW);
+    });
+};
+
 const toHex = (c) => `0${(c || 0).toString(16)}`.slice(-2);
 
 // This function updates ONLY the UI controls from a state object
@@ -350,7 +400,7 @@ const updateUi = (state) => {
 
 const updateWifiUi = (state) => {
     const t = translations[lang];
-    if (dom.wifiStatusValue) dom.wifiStatusValue.textContent = state.wifi ? `${t.connected} (${state.ssid})` : t.disconnected;
+    if (dom.wifiStatusValue) dom.wifiStatusValue.textContent = state.status === 'connected' ? `${t.connected} (${state.ssid})` : t.disconnected;
     if (dom.ipValue) dom.ipValue.textContent = state.ip;
 };
 
@@ -364,54 +414,55 @@ const hexToRgb = (hex) => {
 };
 
 // --- Modal Cambiar Wi-Fi ---
-window.openWifiModal = async () => {
+window.openWifiModal = async (forceScan = false) => {
+    // Espera un evento de /api/events que cumpla `accept`; el servidor envía el
+    // estado actual al conectar, así no se pierde un cambio ya ocurrido.
+    const waitForEvent = (name, accept, timeoutMs, pollController) => new Promise((resolve, reject) => {
+        const source = new EventSource('/api/events');
+        const finish = (fn, value) => {
+            clearTimeout(timer);
+            source.close();
+            pollController.signal.removeEventListener('abort', onAbort);
+            fn(value);
+        };
+        const onAbort = () => finish(reject, new Error('Polling aborted'));
+        const timer = setTimeout(() => finish(reject, new Error(`Polling for ${name} timed out`)), timeoutMs);
+        pollController.signal.addEventListener('abort', onAbort);
+        source.addEventListener(name, (event) => {
+            const data = JSON.parse(event.data);
+            if (accept(data)) finish(resolve, data);
+        });
+    });
+
     const pollForScanResults = async (pollController) => {
-        let attempts = 0;
-        const maxAttempts = 15; // ~30s
-        while (attempts < maxAttempts) {
-            if (pollController.signal.aborted) throw new Error('Polling for scan results aborted');
-            try {
-                const response = await fetchWithTimeout('/api/wifi/results', { signal: pollController.signal, timeout: 5000 });
-                if (response.status === 200) {
-                    const networks = await response.json();
-                    return networks;
-                } else if (response.status === 202) {
-                    await new Promise(resolve => setTimeout(resolve, 2000));
-                    attempts++;
-                } else {
-                    throw new Error(`Unexpected status: ${response.status}`);
-                }
-            } catch (error) {
-                console.error(`Scan poll attempt ${attempts + 1} failed:`, error);
-                throw new Error("Polling for scan results failed");
+        // Se abre el stream antes de consultar, por si el escaneo termina entre medias
+        const streamController = new AbortController();
+        pollController.signal.addEventListener('abort', () => streamController.abort());
+        const scanEvent = waitForEvent('scan', () => true, 30000, streamController);
+        scanEvent.catch(() => { /* se gestiona abajo */ });
+        try {
+            const response = await fetchWithTimeout('/api/wifi/results', { signal: pollController.signal, timeout: 5000 });
+            if (response.status === 200) {
+                streamController.abort();
+                return response.json();
             }
+            if (response.status !== 202) throw new Error(`Unexpected status: ${response.status}`);
+            return await scanEvent;
+        } catch (error) {
+            streamController.abort();
+            console.error('Waiting for scan results failed:', error);
+            throw new Error("Polling for scan results failed");
         }
-        throw new Error("Polling for scan results timed out");
     };
 
     const pollForConnectionStatus = async (pollController) => {
-        let attempts = 0;
-        const backoff = [2000, 5000, 10000];
-        const checkStatus = async () => {
-            if (pollController.signal.aborted) throw new Error('Polling aborted');
-            try {
-                const response = await fetchWithTimeout('/api/wifi/status', { signal: pollController.signal });
-                const data = await response.json();
-                if (data.mode === 'STA' && data.status === 'connected') return true;
-                attempts++;
-                const delay = backoff[Math.min(attempts - 1, backoff.length - 1)] || 30000;
-                await new Promise(resolve => setTimeout(resolve, delay));
-                return checkStatus();
-            } catch (error) {
-                console.error(`Connection poll attempt ${attempts + 1} failed:`, error);
-                attempts++;
-                if (attempts >= 3) throw new Error("Polling failed after 3 attempts");
-                const delay = backoff[Math.min(attempts - 1, backoff.length - 1)] || 30000;
-                await new Promise(resolve => setTimeout(resolve, delay));
-                return checkStatus();
-            }
-        };
-        return checkStatus();
+        try {
+            await waitForEvent('wifi', data => data.mode === 'STA' && data.status === 'connected', 30000, pollController);
+            return true;
+        } catch (error) {
+            console.error('Waiting for connection failed:', error);
+            throw new Error("Polling failed");
+        }
     };
 
     const unreachableStep = () => {
@@ -444,8 +495,9 @@ window.openWifiModal = async () => {
             Swal.showLoading();
             let pollScanController = new AbortController();
             try {
-                const scanInitiateResponse = await fetchWithTimeout('/api/wifi/scan');
-                if (scanInitiateResponse.status !== 202) throw new Error("Failed to initiate scan");
+                // 200: resultados recientes en caché; 202: escaneo en curso
+                const scanInitiateResponse = await fetchWithTimeout(`/api/wifi/scan?force=${forceScan ? 1 : 0}`);
+                if (scanInitiateResponse.status !== 200 && scanInitiateResponse.status !== 202) throw new Error("Failed to initiate scan");
                 const networks = await pollForScanResults(pollScanController);
 
                 if (networks && networks.length > 0) {
@@ -512,7 +564,7 @@ window.openWifiModal = async () => {
     }).then((result) => {
         if (result.isDenied) {
             // Re-escaneo: abrimos nuevamente el modal para forzar un nuevo scan
-            openWifiModal();
+            openWifiModal(true);
             return;
         }
         if (result.isConfirmed) {
@@ -530,7 +582,7 @@ window.openWifiModal = async () => {
 
 // --- Botones principales ---
 window.handleTestModeClick = () => {
-    if (testModeInterval) {
+    if (testModeActive) {
         stopTestMode();
     } else {
         const t = translations[lang];
@@ -554,53 +606,39 @@ window.handleResetClick = () => {
 };
 
 // --- Modo de Prueba (Aurora Boreal) ---
+// La animación se sube una vez como programa de keyframes y se reproduce en el
+// dispositivo, sin tráfico de red mientras corre.
 const stopTestMode = () => {
-    if (testModeInterval) {
-        clearInterval(testModeInterval);
-        testModeInterval = null;
+    if (testModeActive) {
+        testModeActive = false;
+        fetch('/api/program/stop', { method: 'POST' }).catch(() => { /* silencioso en demo */ });
         if (dom.buttons.testMode) dom.buttons.testMode.textContent = translations[lang].testMode;
     }
 };
 
-function lerp(a, b, t) {
-    return Math.round(a + (b - a) * t);
-}
-
 const startAuroraTestMode = () => {
-    if (testModeInterval) return;
+    if (testModeActive) return;
 
+    testModeActive = true;
     if (dom.buttons.testMode) dom.buttons.testMode.textContent = translations[lang].stopTestMode;
 
-    let idx = 0;
-    let step = 0;
-
-    testModeInterval = setInterval(() => {
-        if (step > STEPS_PER_TRANSITION) {
-            step = 0;
-            idx = (idx + 1) % AURORA_KEYFRAMES.length;
-        }
-
-        const from = AURORA_KEYFRAMES[idx];
-        const to   = AURORA_KEYFRAMES[(idx + 1) % AURORA_KEYFRAMES.length];
-        const t    = step / STEPS_PER_TRANSITION;
-
-        const state = {
-            r: lerp(from.r, to.r, t),
-            g: lerp(from.g, to.g, t),
-            b: lerp(from.b, to.b, t),
-            intensity: previewState.intensity  // respeta la intensidad elegida
-        };
-
-        // Actualiza backend y UI
-        fetch('/api/light', {
-            method: 'POST',
-            headers: { 'Content-Type': 'application/json' },
-            body: JSON.stringify(state)
-        }).catch(() => { /* silencioso en demo */ });
-
-        updateUi(state);
-        step++;
-    }, FRAME_MS);
+    const frames = AURORA_KEYFRAMES.map(k => ({
+        r: k.r,
+        g: k.g,
+        b: k.b,
+        intensity: previewState.intensity,  // respeta la intensidad elegida
+        fade_ms: TRANSITION_MS,
+        hold_ms: 0,
+        easing: 'in_out'
+    }));
+
+    fetch('/api/program', {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({ name: AURORA_PROGRAM, loop: true, play: true, frames })
+    }).catch(() => { /* silencioso en demo */ });
+
+    updatePreviewControls({ r: frames[0].r, g: frames[0].g, b: frames[0].b });
 };
 
 // --- Initialization ---
@@ -608,11 +646,10 @@ const init = () => {
     setLang(lang);
     if (window.location.protocol.startsWith('http')) {
         fetchLightState();
-        fetchWifiState();
-        setInterval(fetchWifiState, 5000);
+        connectSocket(); // envía el estado WiFi al conectar y en cada cambio
     } else {
         console.log("Running in local file mode. Skipping initial API calls.");
         updateUi({ r: 128, g: 128, b: 128, intensity: 50 });
-        updateWifiUi({ wifi: false, ip: 'N/A' });
+        updateWifiUi({ status: 'disconnected', ip: 'N/A' });
     }
 };
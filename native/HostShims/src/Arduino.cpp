@@ -0,0 +1,183 @@
+#include "Arduino.h"
+#include "esp_timer.h"
+#include <chrono>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static const auto bootTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+int64_t esp_timer_get_time(void) {
+    return (int64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - bootTime).count() * 240 / 1000);
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    const long dividend = out_max - out_min;
+    const long divisor = in_max - in_min;
+    const long delta = x - in_min;
+    if (divisor == 0) return -1; // Same guard as the ESP32 core
+    return (delta * dividend + (divisor / 2)) / divisor + out_min;
+}
+
+// ---------------------------------------------------------------------------
+// GPIO
+// ---------------------------------------------------------------------------
+#define HOST_PIN_COUNT 64
+
+struct HostPin {
+    uint8_t mode;
+    uint8_t level;
+    int irqMode;
+    void (*handler)(void);
+    void (*argHandler)(void*);
+    void* arg;
+};
+
+static HostPin pins[HOST_PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= HOST_PIN_COUNT) return;
+    pins[pin].mode = mode;
+    if ((mode & PULLUP) == PULLUP) pins[pin].level = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < HOST_PIN_COUNT) pins[pin].level = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PIN_COUNT ? pins[pin].level : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    return digitalRead(pin) ? 4095 : 0;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    if (pin >= HOST_PIN_COUNT) return;
+    pins[pin].irqMode = mode;
+    pins[pin].handler = handler;
+    pins[pin].argHandler = nullptr;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= HOST_PIN_COUNT) return;
+    pins[pin].irqMode = mode;
+    pins[pin].handler = nullptr;
+    pins[pin].argHandler = handler;
+    pins[pin].arg = arg;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin >= HOST_PIN_COUNT) return;
+    pins[pin].irqMode = 0;
+    pins[pin].handler = nullptr;
+    pins[pin].argHandler = nullptr;
+}
+
+void hostSetPin(uint8_t pin, uint8_t level) {
+    if (pin >= HOST_PIN_COUNT) return;
+    HostPin& p = pins[pin];
+    uint8_t old = p.level;
+    p.level = level ? HIGH : LOW;
+    if (old == p.level) return;
+
+    bool rising = p.level == HIGH;
+    bool fire = p.irqMode == CHANGE || (p.irqMode == RISING && rising) || (p.irqMode == FALLING && !rising);
+    if (!fire) return;
+    if (p.handler) p.handler();
+    if (p.argHandler) p.argHandler(p.arg);
+}
+
+// ---------------------------------------------------------------------------
+// Random
+// ---------------------------------------------------------------------------
+static std::mt19937 rng(0);
+
+long random(long max) {
+    return max > 0 ? (long)(rng() % (unsigned long)max) : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    rng.seed((std::mt19937::result_type)seed);
+}
+
+// ---------------------------------------------------------------------------
+// Print / Serial
+// ---------------------------------------------------------------------------
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char stackBuf[128];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(stackBuf, sizeof(stackBuf), format, copy);
+    va_end(copy);
+    if (len < 0) {
+        va_end(args);
+        return 0;
+    }
+    if ((size_t)len < sizeof(stackBuf)) {
+        va_end(args);
+        return write((const uint8_t*)stackBuf, len);
+    }
+    std::string big((size_t)len + 1, '\0');
+    vsnprintf(&big[0], big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (_quiet) return size;
+    return fwrite(buffer, 1, size, stdout);
+}
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+    return String(buf);
+}
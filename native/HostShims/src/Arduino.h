@@ -0,0 +1,160 @@
+#pragma once
+
+// Host (Linux) stand-in for the Arduino-ESP32 core. Timing is wall-clock,
+// GPIOs are plain variables and Serial writes to stdout.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "WString.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+
+using std::min;
+using std::max;
+
+#define LOW  0x0
+#define HIGH 0x1
+
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define PULLUP         0x04
+#define INPUT_PULLUP   0x05
+#define PULLDOWN       0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define PI 3.1415926535897932384626433832795
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// Host controls: drive an input pin (runs attached interrupt handlers on a
+// matching edge), as if the signal changed on the board.
+void hostSetPin(uint8_t pin, uint8_t level);
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return print(String((long)n, base)); }
+    size_t print(unsigned int n, int base = DEC) { return print(String((unsigned long)n, base)); }
+    size_t print(long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(unsigned long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(unsigned char n, int base = DEC) { return print(String((unsigned long)n, base)); }
+    size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    operator bool() const { return true; }
+
+    // Host controls: drop all output (benchmarks)
+    void setQuiet(bool quiet) { _quiet = quiet; }
+
+private:
+    bool _quiet = false;
+};
+
+extern HardwareSerial Serial;
+
+class IPAddress {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{ a, b, c, d } {}
+    explicit IPAddress(uint32_t address) { memcpy(_bytes, &address, sizeof(_bytes)); }
+
+    uint8_t operator[](int index) const { return _bytes[index]; }
+    uint8_t& operator[](int index) { return _bytes[index]; }
+    operator uint32_t() const { uint32_t v; memcpy(&v, _bytes, sizeof(v)); return v; }
+    bool operator==(const IPAddress& other) const { return memcmp(_bytes, other._bytes, sizeof(_bytes)) == 0; }
+    String toString() const;
+
+private:
+    uint8_t _bytes[4] = {};
+};
+
+class EspClass {
+public:
+    [[noreturn]] void restart() { esp_restart(); }
+    uint32_t getFreeHeap() { return 300 * 1024; }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getMinFreeHeap() { return 280 * 1024; }
+    uint32_t getMaxAllocHeap() { return 110 * 1024; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    // CCOUNT at 240 MHz, derived from the monotonic clock
+    static uint32_t getCycleCount();
+    const char* getChipModel() { return "host"; }
+};
+
+extern EspClass ESP;
+
+#define ARDUHAL_LOG_FORMAT(letter, format) "[" #letter "][%s:%u] %s(): " format "\r\n", __FILE__, __LINE__, __FUNCTION__
+#define log_e(format, ...) Serial.printf(ARDUHAL_LOG_FORMAT(E, format), ##__VA_ARGS__)
+#define log_w(format, ...) Serial.printf(ARDUHAL_LOG_FORMAT(W, format), ##__VA_ARGS__)
+#define log_i(format, ...) Serial.printf(ARDUHAL_LOG_FORMAT(I, format), ##__VA_ARGS__)
+#define log_d(format, ...) do {} while (0)
+#define log_v(format, ...) do {} while (0)
+
+// Sketch entry points, called by the host main()
+void setup();
+void loop();
@@ -0,0 +1,35 @@
+#include "AsyncEventSource.h"
+
+void AsyncEventSourceClient::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+    (void)reconnect;
+    if (!_connected) return;
+    if (id) _lastId = id;
+    _sent.push_back(Event{ String(event ? event : ""), String(message ? message : ""), id });
+}
+
+void AsyncEventSource::close() {
+    for (const auto& c : _clients) c->close();
+}
+
+void AsyncEventSource::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+    for (const auto& c : _clients) c->send(message, event, id, reconnect);
+}
+
+size_t AsyncEventSource::count() const {
+    size_t n = 0;
+    for (const auto& c : _clients) {
+        if (c->connected()) n++;
+    }
+    return n;
+}
+
+AsyncEventSourceClient* AsyncEventSource::hostConnect() {
+    _clients.push_back(std::unique_ptr<AsyncEventSourceClient>(new AsyncEventSourceClient(this)));
+    AsyncEventSourceClient* c = _clients.back().get();
+    if (_connectCb) _connectCb(c);
+    return c;
+}
+
+void AsyncEventSource::hostDisconnect(AsyncEventSourceClient* client) {
+    client->close();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ESPAsyncWebServer.h"
+
+class AsyncEventSource;
+
+class AsyncEventSourceClient {
+public:
+    struct Event {
+        String event;
+        String data;
+        uint32_t id;
+    };
+
+    AsyncEventSourceClient(AsyncEventSource* server) : _server(server) {}
+
+    void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+    void close() { _connected = false; }
+    bool connected() const { return _connected; }
+    uint32_t lastId() const { return _lastId; }
+    AsyncEventSource* server() { return _server; }
+
+    // Host controls: events the server sent to this client
+    const std::vector<Event>& hostSent() const { return _sent; }
+    void hostClearSent() { _sent.clear(); }
+
+private:
+    AsyncEventSource* _server;
+    bool _connected = true;
+    uint32_t _lastId = 0;
+    std::vector<Event> _sent;
+};
+
+typedef std::function<void(AsyncEventSourceClient* client)> ArEventHandlerFunction;
+
+// Clients connect through the host controls; the GET request never reaches
+// this handler.
+class AsyncEventSource : public AsyncWebHandler {
+public:
+    explicit AsyncEventSource(const String& url) : _url(url) {}
+
+    const char* url() const { return _url.c_str(); }
+    void onConnect(ArEventHandlerFunction cb) { _connectCb = cb; }
+    void close();
+    void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+    size_t count() const;
+
+    bool canHandle(AsyncWebServerRequest* request) override { (void)request; return false; }
+
+    // Host controls
+    AsyncEventSourceClient* hostConnect();
+    void hostDisconnect(AsyncEventSourceClient* client);
+
+private:
+    String _url;
+    ArEventHandlerFunction _connectCb;
+    std::vector<std::unique_ptr<AsyncEventSourceClient>> _clients;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "ESPAsyncWebServer.h"
+
+#define JSON_MIMETYPE "application/json"
+
+typedef std::function<void(AsyncWebServerRequest* request, JsonVariant& json)> ArJsonRequestHandlerFunction;
+
+// Same flow as the library's handler for ArduinoJson 7: the body is
+// buffered in request->_tempObject, parsed into a JsonDocument when the
+// request completes and handed to the callback; a body that cannot be parsed
+// gets 400 (413 if it exceeded the limit).
+class AsyncCallbackJsonWebHandler : public AsyncWebHandler {
+public:
+    AsyncCallbackJsonWebHandler(const String& uri, ArJsonRequestHandlerFunction onRequest = nullptr) :
+        _uri(uri), _onRequest(onRequest) {}
+
+    void setMethod(WebRequestMethodComposite method) { _method = method; }
+    void setMaxContentLength(int maxContentLength) { _maxContentLength = maxContentLength; }
+    void onRequest(ArJsonRequestHandlerFunction fn) { _onRequest = fn; }
+
+    bool canHandle(AsyncWebServerRequest* request) override {
+        if (!_onRequest) return false;
+        if (!(_method & request->method())) return false;
+        if (_uri.length() && (_uri != request->url() && !request->url().startsWith(_uri + "/"))) return false;
+        if (!request->contentType().equalsIgnoreCase(JSON_MIMETYPE)) return false;
+        request->addInterestingHeader("ANY");
+        return true;
+    }
+
+    void handleRequest(AsyncWebServerRequest* request) override {
+        if (!_onRequest) {
+            request->send(500);
+            return;
+        }
+        if (request->_tempObject != nullptr) {
+            JsonDocument doc;
+            DeserializationError error = deserializeJson(doc, (const char*)request->_tempObject);
+            if (!error) {
+                JsonVariant json = doc.as<JsonVariant>();
+                _onRequest(request, json);
+                return;
+            }
+        }
+        request->send(_contentLength > _maxContentLength ? 413 : 400);
+    }
+
+    void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override {
+        if (!_onRequest) return;
+        _contentLength = total;
+        if (total > 0 && request->_tempObject == nullptr && total < _maxContentLength) {
+            // One extra byte keeps the buffer NUL-terminated for the parser
+            request->_tempObject = calloc(total + 1, 1);
+        }
+        if (request->_tempObject != nullptr) {
+            memcpy((uint8_t*)request->_tempObject + index, data, len);
+        }
+    }
+
+    bool isRequestHandlerTrivial() override { return !_onRequest; }
+
+private:
+    String _uri;
+    WebRequestMethodComposite _method = HTTP_POST | HTTP_PUT | HTTP_PATCH;
+    ArJsonRequestHandlerFunction _onRequest;
+    size_t _contentLength = 0;
+    size_t _maxContentLength = 16384;
+};
@@ -0,0 +1,80 @@
+#include "AsyncWebSocket.h"
+
+void AsyncWebSocketClient::close(uint16_t code, const char* message) {
+    (void)code;
+    (void)message;
+    if (_status != WS_CONNECTED) return;
+    _status = WS_DISCONNECTED;
+    _server->event(this, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+}
+
+void AsyncWebSocket::event(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    if (_eventHandler) _eventHandler(this, client, type, arg, data, len);
+}
+
+size_t AsyncWebSocket::count() const {
+    size_t n = 0;
+    for (const auto& c : _clients) {
+        if (c->status() == WS_CONNECTED) n++;
+    }
+    return n;
+}
+
+AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id) {
+    for (const auto& c : _clients) {
+        if (c->id() == id && c->status() == WS_CONNECTED) return c.get();
+    }
+    return nullptr;
+}
+
+void AsyncWebSocket::cleanupClients(uint16_t maxClients) {
+    // Forget closed clients, then close the oldest ones beyond the limit
+    for (auto it = _clients.begin(); it != _clients.end();) {
+        if ((*it)->status() == WS_DISCONNECTED) {
+            it = _clients.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    while (_clients.size() > maxClients) {
+        _clients.front()->close();
+        _clients.erase(_clients.begin());
+    }
+}
+
+void AsyncWebSocket::closeAll(uint16_t code, const char* message) {
+    for (const auto& c : _clients) c->close(code, message);
+}
+
+void AsyncWebSocket::textAll(const char* message, size_t len) {
+    for (const auto& c : _clients) c->text(message, len);
+}
+
+void AsyncWebSocket::binaryAll(const uint8_t* message, size_t len) {
+    for (const auto& c : _clients) c->binary(message, len);
+}
+
+AsyncWebSocketClient* AsyncWebSocket::hostConnect() {
+    _clients.push_back(std::unique_ptr<AsyncWebSocketClient>(new AsyncWebSocketClient(this, _nextId++)));
+    AsyncWebSocketClient* c = _clients.back().get();
+    event(c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+    return c;
+}
+
+void AsyncWebSocket::hostDisconnect(AsyncWebSocketClient* client) {
+    client->close();
+}
+
+void AsyncWebSocket::hostReceive(AsyncWebSocketClient* client, AwsFrameType type, const uint8_t* data, size_t len) {
+    if (client->status() != WS_CONNECTED) return;
+    AwsFrameInfo info = {};
+    info.message_opcode = type;
+    info.final = 1;
+    info.masked = 1;
+    info.opcode = type;
+    info.len = len;
+    info.index = 0;
+    // Handlers get a writable copy, as the library hands out its RX buffer
+    std::string copy((const char*)data, len);
+    event(client, WS_EVT_DATA, &info, (uint8_t*)&copy[0], len);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ESPAsyncWebServer.h"
+
+#define DEFAULT_MAX_WS_CLIENTS 8
+
+class AsyncWebSocket;
+
+typedef enum {
+    WS_EVT_CONNECT,
+    WS_EVT_DISCONNECT,
+    WS_EVT_PONG,
+    WS_EVT_ERROR,
+    WS_EVT_DATA
+} AwsEventType;
+
+typedef enum {
+    WS_CONTINUATION,
+    WS_TEXT,
+    WS_BINARY,
+    WS_DISCONNECT = 0x08,
+    WS_PING,
+    WS_PONG
+} AwsFrameType;
+
+typedef enum {
+    WS_DISCONNECTED,
+    WS_CONNECTED,
+    WS_DISCONNECTING
+} AwsClientStatus;
+
+typedef struct {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+
+typedef std::function<void(AsyncWebSocket* server, class AsyncWebSocketClient* client, AwsEventType type, void* arg,
+                           uint8_t* data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocketClient {
+public:
+    struct Message {
+        AwsFrameType type;
+        std::string data;
+    };
+
+    AsyncWebSocketClient(AsyncWebSocket* server, uint32_t id) : _server(server), _id(id) {}
+
+    uint32_t id() const { return _id; }
+    AsyncWebSocket* server() { return _server; }
+    AwsClientStatus status() const { return _status; }
+    bool canSend() const { return _status == WS_CONNECTED; }
+
+    void close(uint16_t code = 0, const char* message = nullptr);
+    void ping(const uint8_t* data = nullptr, size_t len = 0) { (void)data; (void)len; }
+
+    void text(const char* message, size_t len) { queue(WS_TEXT, message, len); }
+    void text(const char* message) { text(message, strlen(message)); }
+    void text(const String& message) { text(message.c_str(), message.length()); }
+    void binary(const uint8_t* message, size_t len) { queue(WS_BINARY, (const char*)message, len); }
+    void binary(const char* message, size_t len) { queue(WS_BINARY, message, len); }
+
+    // Host controls: messages the server sent to this client
+    const std::vector<Message>& hostSent() const { return _sent; }
+    void hostClearSent() { _sent.clear(); }
+
+private:
+    friend class AsyncWebSocket;
+
+    AsyncWebSocket* _server;
+    uint32_t _id;
+    AwsClientStatus _status = WS_CONNECTED;
+    std::vector<Message> _sent;
+
+    void queue(AwsFrameType type, const char* data, size_t len) {
+        if (_status == WS_CONNECTED) _sent.push_back(Message{ type, std::string(data, len) });
+    }
+};
+
+// Clients connect and send frames through the host controls; the upgrade
+// request never reaches this handler.
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+    explicit AsyncWebSocket(const String& url) : _url(url) {}
+
+    const char* url() const { return _url.c_str(); }
+    void onEvent(AwsEventHandler handler) { _eventHandler = handler; }
+
+    size_t count() const;
+    AsyncWebSocketClient* client(uint32_t id);
+    void cleanupClients(uint16_t maxClients = DEFAULT_MAX_WS_CLIENTS);
+    void closeAll(uint16_t code = 0, const char* message = nullptr);
+
+    void textAll(const char* message, size_t len);
+    void textAll(const char* message) { textAll(message, strlen(message)); }
+    void textAll(const String& message) { textAll(message.c_str(), message.length()); }
+    void binaryAll(const uint8_t* message, size_t len);
+    void binaryAll(const char* message, size_t len) { binaryAll((const uint8_t*)message, len); }
+
+    bool canHandle(AsyncWebServerRequest* request) override { (void)request; return false; }
+
+    // Host controls
+    AsyncWebSocketClient* hostConnect();
+    void hostDisconnect(AsyncWebSocketClient* client);
+    // Delivers one whole, unfragmented frame from `client`
+    void hostReceive(AsyncWebSocketClient* client, AwsFrameType type, const uint8_t* data, size_t len);
+
+private:
+    friend class AsyncWebSocketClient;
+
+    String _url;
+    AwsEventHandler _eventHandler;
+    std::vector<std::unique_ptr<AsyncWebSocketClient>> _clients;
+    uint32_t _nextId = 1;
+
+    void event(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+};
@@ -0,0 +1,430 @@
+#include "ESPAsyncWebServer.h"
+#include <string>
+
+// ---------------------------------------------------------------------------
+// AsyncWebServerRequest
+// ---------------------------------------------------------------------------
+static const String EMPTY_STRING;
+
+AsyncWebServerRequest::AsyncWebServerRequest(WebRequestMethodComposite method, const String& url, const String& body,
+                                             const String& contentType) :
+    _method(method),
+    _hostName("192.168.4.1"),
+    _body(body),
+    _contentType(contentType) {
+    // Split and decode the query string like the library does
+    int query = url.indexOf('?');
+    _url = query < 0 ? url : url.substring(0, query);
+    if (query < 0) return;
+
+    String rest = url.substring(query + 1);
+    while (rest.length()) {
+        int amp = rest.indexOf('&');
+        String pair = amp < 0 ? rest : rest.substring(0, amp);
+        rest = amp < 0 ? String() : rest.substring(amp + 1);
+        int eq = pair.indexOf('=');
+        hostAddParam(eq < 0 ? pair : pair.substring(0, eq), eq < 0 ? String() : pair.substring(eq + 1));
+    }
+}
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+    for (AsyncWebHeader* h : _headers) delete h;
+    for (AsyncWebParameter* p : _params) delete p;
+    if (_tempObject) free(_tempObject);
+}
+
+AsyncWebServerRequest& AsyncWebServerRequest::hostAddParam(const String& name, const String& value, bool post) {
+    _params.push_back(new AsyncWebParameter(name, value, post));
+    return *this;
+}
+
+AsyncWebServerRequest& AsyncWebServerRequest::hostAddHeader(const String& name, const String& value) {
+    _headers.push_back(new AsyncWebHeader(name, value));
+    if (name.equalsIgnoreCase("Content-Type")) _contentType = value;
+    return *this;
+}
+
+const String& AsyncWebServerRequest::hostResponseHeader(const String& name) const {
+    for (const AsyncWebHeader& h : _responseHeaders) {
+        if (h.name().equalsIgnoreCase(name)) return h.value();
+    }
+    return EMPTY_STRING;
+}
+
+const char* AsyncWebServerRequest::methodToString() const {
+    switch (_method) {
+        case HTTP_GET: return "GET";
+        case HTTP_POST: return "POST";
+        case HTTP_DELETE: return "DELETE";
+        case HTTP_PUT: return "PUT";
+        case HTTP_PATCH: return "PATCH";
+        case HTTP_HEAD: return "HEAD";
+        case HTTP_OPTIONS: return "OPTIONS";
+    }
+    return "UNKNOWN";
+}
+
+bool AsyncWebServerRequest::hasHeader(const String& name) const {
+    return getHeader(name) != nullptr;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name) const {
+    for (AsyncWebHeader* h : _headers) {
+        if (h->name().equalsIgnoreCase(name)) return h;
+    }
+    return nullptr;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(size_t num) const {
+    return num < _headers.size() ? _headers[num] : nullptr;
+}
+
+const String& AsyncWebServerRequest::header(const char* name) const {
+    AsyncWebHeader* h = getHeader(String(name));
+    return h ? h->value() : EMPTY_STRING;
+}
+
+bool AsyncWebServerRequest::hasParam(const String& name, bool post, bool file) const {
+    return getParam(name, post, file) != nullptr;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post, bool file) const {
+    for (AsyncWebParameter* p : _params) {
+        if (p->name() == name && p->isPost() == post && p->isFile() == file) return p;
+    }
+    return nullptr;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(size_t num) const {
+    return num < _params.size() ? _params[num] : nullptr;
+}
+
+bool AsyncWebServerRequest::hasArg(const char* name) const {
+    for (AsyncWebParameter* p : _params) {
+        if (p->name() == name) return true;
+    }
+    return false;
+}
+
+const String& AsyncWebServerRequest::arg(const String& name) const {
+    for (AsyncWebParameter* p : _params) {
+        if (p->name() == name) return p->value();
+    }
+    return EMPTY_STRING;
+}
+
+const String& AsyncWebServerRequest::pathArg(size_t i) const {
+    return i < _pathParams.size() ? _pathParams[i] : EMPTY_STRING;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+    if (response == nullptr) return;
+    if (!response->_sourceValid()) {
+        delete response;
+        send(500);
+        return;
+    }
+    response->_respond(this);
+    delete response;
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+    send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::send_P(int code, const String& contentType, const uint8_t* content, size_t len) {
+    send(beginResponse_P(code, contentType, content, len));
+}
+
+void AsyncWebServerRequest::send_P(int code, const String& contentType, const char* content) {
+    send(beginResponse_P(code, contentType, content));
+}
+
+void AsyncWebServerRequest::redirect(const String& url) {
+    AsyncWebServerResponse* response = beginResponse(302);
+    response->addHeader("Location", url);
+    send(response);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType,
+                                                             const String& content) {
+    return new AsyncBasicResponse(code, contentType, content);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
+                                                               const uint8_t* content, size_t len) {
+    return new AsyncProgmemResponse(code, contentType, content, len);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
+                                                               const char* content) {
+    return beginResponse_P(code, contentType, (const uint8_t*)content, strlen(content));
+}
+
+void AsyncWebServerRequest::record(AsyncWebServerResponse* response, const String& body, uint32_t fillCalls) {
+    (void)response;
+    _responses++;
+    _responseBody = body;
+    _fillCalls = fillCalls;
+}
+
+// ---------------------------------------------------------------------------
+// Responses
+// ---------------------------------------------------------------------------
+AsyncWebServerResponse::AsyncWebServerResponse() {}
+
+const char* AsyncWebServerResponse::responseCodeToString(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 413: return "Request Entity Too Large";
+        case 500: return "Internal Server Error";
+        default: return "";
+    }
+}
+
+void AsyncWebServerResponse::_respond(AsyncWebServerRequest* request) {
+    _started_ = true;
+    request->_responseCode = _code;
+    request->_responseContentType = _contentType;
+    request->_responseHeaders = _headers;
+    request->record(this, String(), 0);
+    _finished_ = true;
+}
+
+AsyncBasicResponse::AsyncBasicResponse(int code, const String& contentType, const String& content) :
+    _content(content) {
+    _code = code;
+    _contentType = contentType;
+    if (_content.length()) {
+        _contentLength = _content.length();
+        if (!_contentType.length()) _contentType = "text/plain";
+    }
+}
+
+void AsyncBasicResponse::_respond(AsyncWebServerRequest* request) {
+    AsyncWebServerResponse::_respond(request);
+    request->_responseBody = _content;
+}
+
+void AsyncAbstractResponse::_respond(AsyncWebServerRequest* request) {
+    _started_ = true;
+    request->_responseCode = _code;
+    request->_responseContentType = _contentType;
+    request->_responseHeaders = _headers;
+
+    std::string body;
+    uint8_t chunk[HOST_CHUNK_SIZE];
+    uint32_t calls = 0;
+    while (!_sendContentLength || body.size() < _contentLength) {
+        size_t want = sizeof(chunk);
+        if (_sendContentLength && _contentLength - body.size() < want) {
+            want = _contentLength - body.size();
+        }
+        size_t n = _fillBuffer(chunk, want);
+        calls++;
+        if (n == 0) break;
+        body.append((const char*)chunk, n);
+    }
+    request->record(this, String(body), calls);
+    _finished_ = true;
+}
+
+AsyncProgmemResponse::AsyncProgmemResponse(int code, const String& contentType, const uint8_t* content, size_t len) :
+    _content(content) {
+    _code = code;
+    _contentType = contentType;
+    _contentLength = len;
+}
+
+size_t AsyncProgmemResponse::_fillBuffer(uint8_t* buf, size_t maxLen) {
+    size_t left = _contentLength - _readLength;
+    size_t n = left < maxLen ? left : maxLen;
+    memcpy(buf, _content + _readLength, n);
+    _readLength += n;
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Handlers
+// ---------------------------------------------------------------------------
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) {
+    if (!_onRequest) return false;
+    if (!(_method & request->method())) return false;
+
+    // Same rules as the library built without ASYNCWEBSERVER_REGEX
+    if (_uri.length() && _uri.startsWith("/*.")) {
+        String suffix = _uri.substring(_uri.lastIndexOf("."));
+        if (!request->url().endsWith(suffix)) return false;
+    } else if (_uri.length() && _uri.endsWith("*")) {
+        String prefix = _uri.substring(0, _uri.length() - 1);
+        if (!request->url().startsWith(prefix)) return false;
+    } else if (_uri.length() && (_uri != request->url() && !request->url().startsWith(_uri + "/"))) {
+        return false;
+    }
+    request->addInterestingHeader("ANY");
+    return true;
+}
+
+void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest* request) {
+    if (_onRequest) {
+        _onRequest(request);
+    } else {
+        request->send(500);
+    }
+}
+
+void AsyncCallbackWebHandler::handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index,
+                                         size_t total) {
+    if (_onBody) _onBody(request, data, len, index, total);
+}
+
+static const char* contentTypeFor(const String& path) {
+    if (path.endsWith(".html") || path.endsWith(".htm")) return "text/html";
+    if (path.endsWith(".css")) return "text/css";
+    if (path.endsWith(".js")) return "application/javascript";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".png")) return "image/png";
+    if (path.endsWith(".svg")) return "image/svg+xml";
+    if (path.endsWith(".ico")) return "image/x-icon";
+    return "text/plain";
+}
+
+AsyncStaticWebHandler::AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cacheControl) :
+    _fs(fs),
+    _uri(uri),
+    _path(path),
+    _cacheControl(cacheControl ? cacheControl : "") {}
+
+bool AsyncStaticWebHandler::resolve(const String& url, String& path, bool& gzipped) {
+    if (!url.startsWith(_uri)) return false;
+    path = _path + url.substring(_uri.length());
+    if (path.endsWith("/")) path += _defaultFile;
+    path.replace("//", "/");
+    gzipped = false;
+    if (_fs.exists(path)) return true;
+    if (_fs.exists(path + ".gz")) {
+        gzipped = true;
+        return true;
+    }
+    return false;
+}
+
+bool AsyncStaticWebHandler::canHandle(AsyncWebServerRequest* request) {
+    String path;
+    bool gzipped;
+    return (request->method() & (HTTP_GET | HTTP_HEAD)) && resolve(request->url(), path, gzipped);
+}
+
+void AsyncStaticWebHandler::handleRequest(AsyncWebServerRequest* request) {
+    String path;
+    bool gzipped;
+    if (!resolve(request->url(), path, gzipped)) {
+        request->send(404);
+        return;
+    }
+    File f = _fs.open(gzipped ? path + ".gz" : path, "r");
+    String content;
+    uint8_t buf[256];
+    size_t n;
+    while ((n = f.read(buf, sizeof(buf))) > 0) content.concat((const char*)buf, n);
+    f.close();
+
+    AsyncWebServerResponse* response = request->beginResponse(200, contentTypeFor(path), content);
+    if (gzipped) response->addHeader("Content-Encoding", "gzip");
+    if (_cacheControl.length()) response->addHeader("Cache-Control", _cacheControl);
+    request->send(response);
+}
+
+// ---------------------------------------------------------------------------
+// AsyncWebServer
+// ---------------------------------------------------------------------------
+AsyncWebServer::AsyncWebServer(uint16_t port) : _port(port) {}
+
+AsyncWebServer::~AsyncWebServer() {
+    reset();
+}
+
+void AsyncWebServer::reset() {
+    for (AsyncWebHandler* h : _owned) delete h;
+    _owned.clear();
+    _handlers.clear();
+    _notFound = nullptr;
+    _notFoundBody = nullptr;
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler) {
+    _handlers.push_back(handler);
+    return *handler;
+}
+
+bool AsyncWebServer::removeHandler(AsyncWebHandler* handler) {
+    for (auto it = _handlers.begin(); it != _handlers.end(); ++it) {
+        if (*it == handler) {
+            _handlers.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, ArRequestHandlerFunction onRequest) {
+    return on(uri, HTTP_ANY, onRequest);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest) {
+    return on(uri, method, onRequest, nullptr, nullptr);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload) {
+    return on(uri, method, onRequest, onUpload, nullptr);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload,
+                                            ArBodyHandlerFunction onBody) {
+    AsyncCallbackWebHandler* handler = new AsyncCallbackWebHandler();
+    handler->setUri(uri);
+    handler->setMethod(method);
+    handler->onRequest(onRequest);
+    handler->onUpload(onUpload);
+    handler->onBody(onBody);
+    _owned.push_back(handler);
+    addHandler(handler);
+    return *handler;
+}
+
+AsyncStaticWebHandler& AsyncWebServer::serveStatic(const char* uri, fs::FS& fs, const char* path,
+                                                   const char* cacheControl) {
+    AsyncStaticWebHandler* handler = new AsyncStaticWebHandler(uri, fs, path, cacheControl);
+    _owned.push_back(handler);
+    addHandler(handler);
+    return *handler;
+}
+
+void AsyncWebServer::hostHandle(AsyncWebServerRequest& request) {
+    uint8_t* body = (uint8_t*)request._body.c_str();
+    size_t len = request._body.length();
+
+    for (AsyncWebHandler* handler : _handlers) {
+        if (handler->filter(&request) && handler->canHandle(&request)) {
+            if (len) handler->handleBody(&request, body, len, 0, len);
+            handler->handleRequest(&request);
+            return;
+        }
+    }
+
+    if (len && _notFoundBody) _notFoundBody(&request, body, len, 0, len);
+    if (_notFound) {
+        _notFound(&request);
+    } else {
+        request.send(404);
+    }
+}
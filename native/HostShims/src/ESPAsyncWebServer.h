@@ -0,0 +1,318 @@
+#pragma once
+
+// Host stand-in for ESPAsyncWebServer. There is no TCP: requests are built in
+// memory and dispatched synchronously with AsyncWebServer::handle(), which
+// runs the same handler matching as the library. Responses are rendered into
+// the request (AsyncAbstractResponse is drained through _fillBuffer in
+// TCP-sized chunks) so they can be inspected afterwards.
+
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+#include "FS.h"
+
+typedef enum {
+    HTTP_GET     = 0b00000001,
+    HTTP_POST    = 0b00000010,
+    HTTP_DELETE  = 0b00000100,
+    HTTP_PUT     = 0b00001000,
+    HTTP_PATCH   = 0b00010000,
+    HTTP_HEAD    = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY     = 0b01111111,
+} WebRequestMethod;
+
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+class AsyncWebHandler;
+class AsyncStaticWebHandler;
+class AsyncCallbackWebHandler;
+
+class AsyncWebParameter {
+public:
+    AsyncWebParameter(const String& name, const String& value, bool form = false, bool file = false, size_t size = 0) :
+        _name(name), _value(value), _size(size), _isForm(form), _isFile(file) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+    size_t size() const { return _size; }
+    bool isPost() const { return _isForm; }
+    bool isFile() const { return _isFile; }
+
+private:
+    String _name;
+    String _value;
+    size_t _size;
+    bool _isForm;
+    bool _isFile;
+};
+
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name, const String& value) : _name(name), _value(value) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+
+private:
+    String _name;
+    String _value;
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data,
+                           size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index,
+                           size_t total)> ArBodyHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest* request)> ArRequestFilterFunction;
+
+class AsyncWebServerRequest {
+public:
+    AsyncWebServerRequest(WebRequestMethodComposite method, const String& url, const String& body = String(),
+                          const String& contentType = String());
+    ~AsyncWebServerRequest();
+    AsyncWebServerRequest(const AsyncWebServerRequest&) = delete;
+    AsyncWebServerRequest& operator=(const AsyncWebServerRequest&) = delete;
+
+    // Host controls: build the request
+    AsyncWebServerRequest& hostAddParam(const String& name, const String& value, bool post = false);
+    AsyncWebServerRequest& hostAddHeader(const String& name, const String& value);
+
+    // Host controls: inspect the response
+    bool hostResponded() const { return _responses > 0; }
+    uint32_t hostResponseCount() const { return _responses; }
+    int hostResponseCode() const { return _responseCode; }
+    const String& hostResponseContentType() const { return _responseContentType; }
+    const String& hostResponseBody() const { return _responseBody; }
+    const String& hostResponseHeader(const String& name) const;
+    uint32_t hostFillCalls() const { return _fillCalls; } // _fillBuffer calls for the last response
+
+    WebRequestMethodComposite method() const { return _method; }
+    const char* methodToString() const;
+    const String& url() const { return _url; }
+    const String& host() const { return _hostName; }
+    const String& contentType() const { return _contentType; }
+    size_t contentLength() const { return _body.length(); }
+    bool multipart() const { return false; }
+
+    size_t headers() const { return _headers.size(); }
+    bool hasHeader(const String& name) const;
+    AsyncWebHeader* getHeader(const String& name) const;
+    AsyncWebHeader* getHeader(size_t num) const;
+    const String& header(const char* name) const;
+    void addInterestingHeader(const String& name) { (void)name; } // Every header is kept
+
+    size_t params() const { return _params.size(); }
+    bool hasParam(const String& name, bool post = false, bool file = false) const;
+    AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const;
+    AsyncWebParameter* getParam(size_t num) const;
+    bool hasArg(const char* name) const;
+    const String& arg(const String& name) const;
+    const String& pathArg(size_t i) const;
+
+    void send(AsyncWebServerResponse* response);
+    void send(int code, const String& contentType = String(), const String& content = String());
+    void send_P(int code, const String& contentType, const uint8_t* content, size_t len);
+    void send_P(int code, const String& contentType, const char* content);
+    void redirect(const String& url);
+
+    AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(),
+                                          const String& content = String());
+    AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, const uint8_t* content, size_t len);
+    AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, const char* content);
+
+    void* _tempObject = nullptr;
+
+private:
+    friend class AsyncWebServer;
+    friend class AsyncWebServerResponse;
+    friend class AsyncBasicResponse;
+    friend class AsyncAbstractResponse;
+
+    WebRequestMethodComposite _method;
+    String _url;
+    String _hostName;
+    String _body;
+    String _contentType;
+    std::vector<AsyncWebHeader*> _headers;
+    std::vector<AsyncWebParameter*> _params;
+    std::vector<String> _pathParams;
+
+    uint32_t _responses = 0;
+    int _responseCode = 0;
+    String _responseContentType;
+    String _responseBody;
+    std::vector<AsyncWebHeader> _responseHeaders;
+    uint32_t _fillCalls = 0;
+
+    void record(AsyncWebServerResponse* response, const String& body, uint32_t fillCalls);
+};
+
+class AsyncWebServerResponse {
+public:
+    AsyncWebServerResponse();
+    virtual ~AsyncWebServerResponse() {}
+
+    void setCode(int code) { _code = code; }
+    void setContentLength(size_t len) { _contentLength = len; }
+    void setContentType(const String& type) { _contentType = type; }
+    void addHeader(const String& name, const String& value) { _headers.push_back(AsyncWebHeader(name, value)); }
+
+    virtual bool _started() const { return _started_; }
+    virtual bool _finished() const { return _finished_; }
+    virtual bool _failed() const { return false; }
+    virtual bool _sourceValid() const { return false; }
+    virtual void _respond(AsyncWebServerRequest* request);
+
+    static const char* responseCodeToString(int code);
+
+protected:
+    int _code = 0;
+    std::vector<AsyncWebHeader> _headers;
+    String _contentType;
+    size_t _contentLength = 0;
+    bool _sendContentLength = true;
+    bool _chunked = false;
+    bool _started_ = false;
+    bool _finished_ = false;
+};
+
+class AsyncBasicResponse : public AsyncWebServerResponse {
+public:
+    AsyncBasicResponse(int code, const String& contentType = String(), const String& content = String());
+    bool _sourceValid() const override { return true; }
+    void _respond(AsyncWebServerRequest* request) override;
+
+private:
+    String _content;
+};
+
+class AsyncAbstractResponse : public AsyncWebServerResponse {
+public:
+    // Window offered to _fillBuffer per call, like one TCP send buffer
+    static constexpr size_t HOST_CHUNK_SIZE = 1436;
+
+    void _respond(AsyncWebServerRequest* request) override;
+    bool _sourceValid() const override { return false; }
+    virtual size_t _fillBuffer(uint8_t* buf, size_t maxLen) { (void)buf; (void)maxLen; return 0; }
+};
+
+class AsyncProgmemResponse : public AsyncAbstractResponse {
+public:
+    AsyncProgmemResponse(int code, const String& contentType, const uint8_t* content, size_t len);
+    bool _sourceValid() const override { return true; }
+    size_t _fillBuffer(uint8_t* buf, size_t maxLen) override;
+
+private:
+    const uint8_t* _content;
+    size_t _readLength = 0;
+};
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+    AsyncWebHandler& setFilter(ArRequestFilterFunction fn) { _filter = fn; return *this; }
+    AsyncWebHandler& setAuthentication(const char* username, const char* password) {
+        (void)username;
+        (void)password;
+        return *this;
+    }
+    bool filter(AsyncWebServerRequest* request) { return !_filter || _filter(request); }
+    virtual bool canHandle(AsyncWebServerRequest* request) { (void)request; return false; }
+    virtual void handleRequest(AsyncWebServerRequest* request) { (void)request; }
+    virtual void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data,
+                              size_t len, bool final) {
+        (void)request; (void)filename; (void)index; (void)data; (void)len; (void)final;
+    }
+    virtual void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+        (void)request; (void)data; (void)len; (void)index; (void)total;
+    }
+    virtual bool isRequestHandlerTrivial() { return true; }
+
+protected:
+    ArRequestFilterFunction _filter;
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+    void setUri(const String& uri) { _uri = uri; }
+    void setMethod(WebRequestMethodComposite method) { _method = method; }
+    void onRequest(ArRequestHandlerFunction fn) { _onRequest = fn; }
+    void onUpload(ArUploadHandlerFunction fn) { _onUpload = fn; }
+    void onBody(ArBodyHandlerFunction fn) { _onBody = fn; }
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override;
+    bool isRequestHandlerTrivial() override { return !_onBody; }
+
+private:
+    String _uri;
+    WebRequestMethodComposite _method = HTTP_ANY;
+    ArRequestHandlerFunction _onRequest;
+    ArUploadHandlerFunction _onUpload;
+    ArBodyHandlerFunction _onBody;
+};
+
+class AsyncStaticWebHandler : public AsyncWebHandler {
+public:
+    AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cacheControl);
+    AsyncStaticWebHandler& setDefaultFile(const char* filename) { _defaultFile = filename; return *this; }
+    AsyncStaticWebHandler& setCacheControl(const char* cacheControl) { _cacheControl = cacheControl; return *this; }
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+
+private:
+    FS _fs;
+    String _uri;
+    String _path;
+    String _defaultFile = "index.htm";
+    String _cacheControl;
+
+    bool resolve(const String& url, String& path, bool& gzipped);
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port);
+    // Handlers created by on()/serveStatic() are owned by the server; ones
+    // passed to addHandler() stay owned by the caller.
+    ~AsyncWebServer();
+
+    void begin() { _running = true; }
+    void end() { _running = false; }
+    void reset();
+
+    AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+    bool removeHandler(AsyncWebHandler* handler);
+
+    AsyncCallbackWebHandler& on(const char* uri, ArRequestHandlerFunction onRequest);
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                                ArUploadHandlerFunction onUpload);
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                                ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody);
+    AsyncStaticWebHandler& serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheControl = nullptr);
+
+    void onNotFound(ArRequestHandlerFunction fn) { _notFound = fn; }
+    void onFileUpload(ArUploadHandlerFunction fn) { (void)fn; }
+    void onRequestBody(ArBodyHandlerFunction fn) { _notFoundBody = fn; }
+
+    // Host controls: runs `request` through the handlers as a client would.
+    // The body is delivered in one handleBody() call before handleRequest().
+    void hostHandle(AsyncWebServerRequest& request);
+    bool hostRunning() const { return _running; }
+
+private:
+    uint16_t _port;
+    bool _running = false;
+    std::vector<AsyncWebHandler*> _handlers;
+    std::vector<AsyncWebHandler*> _owned;
+    ArRequestHandlerFunction _notFound;
+    ArBodyHandlerFunction _notFoundBody;
+};
+
+#include "AsyncWebSocket.h"
+#include "AsyncEventSource.h"
@@ -0,0 +1,193 @@
+#include "FS.h"
+#include "FSImpl.h"
+#include <string.h>
+
+namespace fs {
+
+// ---------------------------------------------------------------------------
+// FSImpl
+// ---------------------------------------------------------------------------
+bool FSImpl::parentExists(const std::string& path) const {
+    size_t slash = path.rfind('/');
+    if (slash == 0 || slash == std::string::npos) return true;
+    return dirs.count(path.substr(0, slash)) > 0;
+}
+
+// ---------------------------------------------------------------------------
+// File
+// ---------------------------------------------------------------------------
+size_t File::write(const uint8_t* buf, size_t size) {
+    if (!_impl || !_impl->writable) return 0;
+    std::vector<uint8_t>& data = _impl->data;
+    if (_impl->pos + size > data.size()) data.resize(_impl->pos + size);
+    memcpy(data.data() + _impl->pos, buf, size);
+    _impl->pos += size;
+    _impl->dirty = true;
+    return size;
+}
+
+size_t File::print(const char* s) {
+    return write((const uint8_t*)s, strlen(s));
+}
+
+int File::available() {
+    if (!_impl) return 0;
+    return (int)(_impl->data.size() - _impl->pos);
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    if (!_impl || !_impl->readable) return 0;
+    size_t left = _impl->data.size() - _impl->pos;
+    if (size > left) size = left;
+    memcpy(buf, _impl->data.data() + _impl->pos, size);
+    _impl->pos += size;
+    return size;
+}
+
+String File::readString() {
+    String s;
+    int c;
+    while ((c = read()) >= 0) s.concat((char)c);
+    return s;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!_impl) return false;
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? _impl->pos : _impl->data.size();
+    size_t target = base + pos;
+    if (target > _impl->data.size()) return false;
+    _impl->pos = target;
+    return true;
+}
+
+size_t File::position() const {
+    return _impl ? _impl->pos : 0;
+}
+
+size_t File::size() const {
+    return _impl ? _impl->data.size() : 0;
+}
+
+void File::flush() {
+    if (!_impl || !_impl->dirty) return;
+    std::lock_guard<std::mutex> lock(_impl->fs->mutex);
+    _impl->fs->files[_impl->path] = _impl->data;
+    _impl->dirty = false;
+}
+
+void File::close() {
+    flush();
+    _impl.reset();
+}
+
+bool File::isDirectory() const {
+    return _impl && _impl->directory;
+}
+
+const char* File::path() const {
+    return _impl ? _impl->path.c_str() : "";
+}
+
+const char* File::name() const {
+    if (!_impl) return "";
+    size_t slash = _impl->path.rfind('/');
+    return _impl->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+File::operator bool() const {
+    return (bool)_impl;
+}
+
+// ---------------------------------------------------------------------------
+// FS
+// ---------------------------------------------------------------------------
+File FS::open(const char* path, const char* mode, bool create) {
+    (void)create;
+    if (!_impl->mounted || !path || path[0] != '/') return File();
+
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    std::shared_ptr<FileImpl> file = std::make_shared<FileImpl>();
+    file->fs = _impl;
+    file->path = path;
+
+    if (_impl->dirs.count(path) || strcmp(path, "/") == 0) {
+        file->directory = true;
+        return File(file);
+    }
+
+    auto it = _impl->files.find(path);
+    bool append = mode[0] == 'a';
+    bool write = mode[0] == 'w' || append;
+    file->readable = mode[0] == 'r' || strchr(mode, '+') != nullptr;
+    file->writable = write || strchr(mode, '+') != nullptr;
+
+    if (!write) {
+        if (it == _impl->files.end()) return File();
+        file->data = it->second;
+    } else {
+        if (!_impl->parentExists(path)) return File();
+        if (append && it != _impl->files.end()) file->data = it->second;
+        file->pos = append ? file->data.size() : 0;
+        file->dirty = true; // Creates (or truncates) the file on close
+    }
+    return File(file);
+}
+
+bool FS::exists(const char* path) {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    return _impl->mounted && (_impl->files.count(path) || _impl->dirs.count(path) || strcmp(path, "/") == 0);
+}
+
+bool FS::remove(const char* path) {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    return _impl->mounted && _impl->files.erase(path) > 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    auto it = _impl->files.find(from);
+    if (!_impl->mounted || it == _impl->files.end()) return false;
+    _impl->files[to] = it->second;
+    _impl->files.erase(from);
+    return true;
+}
+
+bool FS::mkdir(const char* path) {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    if (!_impl->mounted || !path || path[0] != '/') return false;
+    _impl->dirs.insert(path);
+    return true;
+}
+
+bool FS::rmdir(const char* path) {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    return _impl->mounted && _impl->dirs.erase(path) > 0;
+}
+
+void FS::hostWriteFile(const char* path, const void* data, size_t len) {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    std::string p(path);
+    for (size_t slash = p.find('/', 1); slash != std::string::npos; slash = p.find('/', slash + 1)) {
+        _impl->dirs.insert(p.substr(0, slash));
+    }
+    const uint8_t* bytes = (const uint8_t*)data;
+    _impl->files[p].assign(bytes, bytes + len);
+}
+
+void FS::hostFormat() {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    _impl->files.clear();
+    _impl->dirs.clear();
+}
+
+size_t FS::hostFileCount() {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    return _impl->files.size();
+}
+
+} // namespace fs
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include "WString.h"
+
+namespace fs {
+
+class FileImpl;
+class FSImpl;
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+// File handle over an in-memory file. Writes become visible to other
+// handles when the file is closed (or flushed), like on LittleFS.
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : _impl(impl) {}
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size);
+    size_t print(const char* s);
+    int available();
+    int read();
+    size_t read(uint8_t* buf, size_t size);
+    String readString();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void flush();
+    void close();
+    bool isDirectory() const;
+    const char* path() const;
+    const char* name() const;
+    operator bool() const;
+
+private:
+    std::shared_ptr<FileImpl> _impl;
+};
+
+class FS {
+public:
+    explicit FS(std::shared_ptr<FSImpl> impl) : _impl(impl) {}
+
+    File open(const char* path, const char* mode = "r", bool create = false);
+    File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+
+    // Host controls
+    void hostWriteFile(const char* path, const void* data, size_t len);
+    void hostFormat();
+    size_t hostFileCount();
+
+protected:
+    std::shared_ptr<FSImpl> _impl;
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
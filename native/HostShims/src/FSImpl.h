@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace fs {
+
+// Shared state of one in-memory filesystem
+struct FSImpl {
+    std::mutex mutex;
+    std::map<std::string, std::vector<uint8_t>> files;
+    std::set<std::string> dirs;
+    bool mounted = false;
+    bool mountable = true;
+
+    bool parentExists(const std::string& path) const;
+};
+
+// One open file; reads and writes go to a private copy
+struct FileImpl {
+    std::shared_ptr<FSImpl> fs;
+    std::string path;
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+    bool readable = false;
+    bool writable = false;
+    bool dirty = false;
+    bool directory = false;
+};
+
+} // namespace fs
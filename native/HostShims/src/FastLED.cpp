@@ -0,0 +1,31 @@
+#include "FastLED.h"
+#include <string.h>
+
+CFastLED FastLED;
+
+CLEDController& CFastLED::addController(uint8_t pin, CRGB* data, int nLeds) {
+    // Registration happens once at boot; extra controllers reuse the last slot
+    int index = _controllerCount < HOST_MAX_CONTROLLERS ? _controllerCount++ : HOST_MAX_CONTROLLERS - 1;
+    if (!_controllers[index]) _controllers[index] = new CLEDController();
+    _controllers[index]->_pin = pin;
+    _controllers[index]->setLeds(data, nLeds);
+    return *_controllers[index];
+}
+
+void CFastLED::show() {
+    uint64_t bytes = 0;
+    for (int i = 0; i < _controllerCount; i++) {
+        bytes += (uint64_t)_controllers[i]->size() * sizeof(CRGB);
+    }
+    _bytesSent = _bytesSent + bytes;
+    _shows = _shows + 1;
+}
+
+void CFastLED::clear(bool writeData) {
+    for (int i = 0; i < _controllerCount; i++) {
+        if (_controllers[i]->leds()) {
+            memset((void*)_controllers[i]->leds(), 0, sizeof(CRGB) * _controllers[i]->size());
+        }
+    }
+    if (writeData) show();
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// Host stand-in for FastLED: pixels stay in memory and show() only counts
+// frames (and the bytes a real strip would be sent).
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Arduino.h"
+
+struct CRGB {
+    union {
+        struct {
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+        };
+        uint8_t raw[3];
+    };
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+
+    uint8_t& operator[](uint8_t x) { return raw[x]; }
+    const uint8_t& operator[](uint8_t x) const { return raw[x]; }
+
+    // Same rounding as FastLED: a non-zero channel never scales down to zero
+    CRGB& nscale8_video(uint8_t scale) {
+        uint8_t nonzero = scale != 0 ? 1 : 0;
+        r = r == 0 ? 0 : (uint8_t)((((int)r * (int)scale) >> 8) + nonzero);
+        g = g == 0 ? 0 : (uint8_t)((((int)g * (int)scale) >> 8) + nonzero);
+        b = b == 0 ? 0 : (uint8_t)((((int)b * (int)scale) >> 8) + nonzero);
+        return *this;
+    }
+
+    CRGB& nscale8(uint8_t scale) {
+        r = (uint8_t)(((uint16_t)r * (1 + scale)) >> 8);
+        g = (uint8_t)(((uint16_t)g * (1 + scale)) >> 8);
+        b = (uint8_t)(((uint16_t)b * (1 + scale)) >> 8);
+        return *this;
+    }
+
+    bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+    bool operator!=(const CRGB& o) const { return !(*this == o); }
+
+    enum HTMLColorCode {
+        Black = 0x000000,
+        White = 0xFFFFFF,
+        Red = 0xFF0000,
+        Green = 0x008000,
+        Blue = 0x0000FF,
+    };
+};
+
+enum EOrder {
+    RGB = 0012,
+    RBG = 0021,
+    GRB = 0102,
+    GBR = 0120,
+    BRG = 0201,
+    BGR = 0210
+};
+
+class CLEDController {
+public:
+    CLEDController& setLeds(CRGB* data, int nLeds) {
+        _leds = data;
+        _count = nLeds;
+        return *this;
+    }
+    CRGB* leds() { return _leds; }
+    int size() const { return _count; }
+    uint8_t pin() const { return _pin; }
+
+private:
+    friend class CFastLED;
+    CRGB* _leds = nullptr;
+    int _count = 0;
+    uint8_t _pin = 0;
+};
+
+// Chipset tags; only the pin is used on the host
+template <uint8_t PIN, EOrder ORDER = RGB> class WS2811 {};
+template <uint8_t PIN, EOrder ORDER = RGB> class WS2812 {};
+template <uint8_t PIN, EOrder ORDER = RGB> class WS2812B {};
+template <uint8_t PIN, EOrder ORDER = RGB> class SK6812 {};
+template <uint8_t PIN, EOrder ORDER = GRB> class NEOPIXEL {};
+
+#define HOST_MAX_CONTROLLERS 8
+
+class CFastLED {
+public:
+    template <template <uint8_t, EOrder> class CHIPSET, uint8_t PIN, EOrder ORDER = RGB>
+    CLEDController& addLeds(CRGB* data, int nLeds) {
+        return addController(PIN, data, nLeds);
+    }
+
+    void setBrightness(uint8_t scale) { _brightness = scale; }
+    uint8_t getBrightness() const { return _brightness; }
+    void setDither(uint8_t ditherMode) { _dither = ditherMode; }
+    void setMaxRefreshRate(uint16_t refresh, bool constrain = false) { (void)refresh; (void)constrain; }
+
+    void show();
+    void clear(bool writeData = false);
+
+    int count() const { return _controllerCount; }
+    CLEDController& operator[](int x) { return *_controllers[x]; }
+
+    // Host controls
+    uint32_t hostShowCount() const { return _shows; }
+    uint64_t hostBytesSent() const { return _bytesSent; }
+
+private:
+    CLEDController* _controllers[HOST_MAX_CONTROLLERS] = {};
+    int _controllerCount = 0;
+    uint8_t _brightness = 255;
+    uint8_t _dither = 1;
+    volatile uint32_t _shows = 0;
+    volatile uint64_t _bytesSent = 0;
+
+    CLEDController& addController(uint8_t pin, CRGB* data, int nLeds);
+};
+
+extern CFastLED FastLED;
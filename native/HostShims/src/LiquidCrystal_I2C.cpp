@@ -0,0 +1,52 @@
+#include "LiquidCrystal_I2C.h"
+#include <string.h>
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows) :
+    _addr(addr),
+    _cols(cols < MAX_COLS ? cols : MAX_COLS),
+    _rows(rows < MAX_ROWS ? rows : MAX_ROWS) {
+    memset(_text, 0, sizeof(_text));
+}
+
+void LiquidCrystal_I2C::init() {
+    _busBytes += 4; // Function set, display control, clear, entry mode
+    clear();
+}
+
+void LiquidCrystal_I2C::clear() {
+    for (uint8_t row = 0; row < MAX_ROWS; row++) {
+        memset(_text[row], ' ', _cols);
+        _text[row][_cols] = '\0';
+    }
+    _col = 0;
+    _row = 0;
+    _busBytes++;
+}
+
+void LiquidCrystal_I2C::home() {
+    _col = 0;
+    _row = 0;
+    _busBytes++;
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row) {
+    _row = row < _rows ? row : _rows - 1;
+    _col = col;
+    _busBytes++;
+}
+
+void LiquidCrystal_I2C::createChar(uint8_t location, uint8_t charmap[]) {
+    (void)location;
+    (void)charmap;
+    _busBytes += 9;
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t value) {
+    _busBytes++;
+    // Characters past the visible width land in DDRAM the host does not show
+    if (_col < _cols) {
+        _text[_row][_col] = (char)value;
+    }
+    _col++;
+    return 1;
+}
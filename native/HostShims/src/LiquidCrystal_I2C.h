@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include "Arduino.h"
+
+// Host stand-in for the HD44780 I2C backpack: the display is a character
+// buffer that can be read back, and every byte that would cross the I2C bus
+// is counted.
+class LiquidCrystal_I2C : public Print {
+public:
+    static constexpr uint8_t MAX_COLS = 40;
+    static constexpr uint8_t MAX_ROWS = 4;
+
+    LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows);
+
+    void init();
+    void begin(uint8_t cols, uint8_t rows, uint8_t charsize = 0) { (void)charsize; _cols = cols; _rows = rows; init(); }
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void backlight() { _backlight = true; _busBytes++; }
+    void noBacklight() { _backlight = false; _busBytes++; }
+    void display() { _busBytes++; }
+    void noDisplay() { _busBytes++; }
+    void cursor() { _busBytes++; }
+    void noCursor() { _busBytes++; }
+    void blink() { _busBytes++; }
+    void noBlink() { _busBytes++; }
+    void createChar(uint8_t location, uint8_t charmap[]);
+
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+    // Host controls
+    const char* hostRow(uint8_t row) const { return row < MAX_ROWS ? _text[row] : ""; }
+    uint8_t hostCursorCol() const { return _col; }
+    uint8_t hostCursorRow() const { return _row; }
+    bool hostBacklight() const { return _backlight; }
+    uint32_t hostBusBytes() const { return _busBytes; } // One per command or character
+    void hostResetCounters() { _busBytes = 0; }
+
+private:
+    uint8_t _addr;
+    uint8_t _cols;
+    uint8_t _rows;
+    uint8_t _col = 0;
+    uint8_t _row = 0;
+    bool _backlight = false;
+    uint32_t _busBytes = 0;
+    char _text[MAX_ROWS][MAX_COLS + 1];
+};
@@ -0,0 +1,44 @@
+#include "LittleFS.h"
+#include "FSImpl.h"
+
+namespace fs {
+
+LittleFSFS::LittleFSFS() : FS(std::make_shared<FSImpl>()) {}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    _impl->mounted = _impl->mountable;
+    return _impl->mounted;
+}
+
+void LittleFSFS::end() {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    _impl->mounted = false;
+}
+
+bool LittleFSFS::format() {
+    hostFormat();
+    return true;
+}
+
+size_t LittleFSFS::usedBytes() {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    size_t used = 0;
+    for (const auto& file : _impl->files) {
+        used += (file.second.size() + 4095) / 4096 * 4096;
+    }
+    return used;
+}
+
+void LittleFSFS::hostSetMountable(bool mountable) {
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    _impl->mountable = mountable;
+}
+
+} // namespace fs
+
+fs::LittleFSFS LittleFS;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+    LittleFSFS();
+
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end();
+    bool format();
+    size_t totalBytes() { return 1408 * 1024; }
+    size_t usedBytes();
+
+    // Host controls: make the next begin() fail, as with no partition
+    void hostSetMountable(bool mountable);
+};
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,145 @@
+#include "Preferences.h"
+#include <string.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define NVS_KEY_NAME_MAX 15
+#define NVS_HOST_ENTRIES 504 // Entries in the default 20 KB nvs partition
+
+typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+static std::map<std::string, Namespace> store;
+static std::mutex storeMutex;
+static uint32_t writes = 0;
+
+static bool validKey(const char* key) {
+    return key && key[0] && strlen(key) <= NVS_KEY_NAME_MAX;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (_started) return false;
+    if (!validKey(name)) return false;
+    strncpy(_name, name, sizeof(_name) - 1);
+    _readOnly = readOnly;
+    _started = true;
+    if (!readOnly) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        store[_name];
+    }
+    return true;
+}
+
+void Preferences::end() {
+    _started = false;
+}
+
+bool Preferences::clear() {
+    if (!_started || _readOnly) return false;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    store[_name].clear();
+    writes++;
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_started || _readOnly || !validKey(key)) return false;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (store[_name].erase(key) == 0) return false;
+    writes++;
+    return true;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!_started || !validKey(key)) return false;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto ns = store.find(_name);
+    return ns != store.end() && ns->second.count(key) > 0;
+}
+
+size_t Preferences::freeEntries() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    size_t used = 0;
+    for (const auto& ns : store) {
+        for (const auto& entry : ns.second) {
+            used += 1 + (entry.second.size() + 31) / 32;
+        }
+    }
+    return used < NVS_HOST_ENTRIES ? NVS_HOST_ENTRIES - used : 0;
+}
+
+size_t Preferences::putValue(const char* key, const void* value, size_t len) {
+    if (!_started || _readOnly || !validKey(key) || (len && !value)) return 0;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    const uint8_t* bytes = (const uint8_t*)value;
+    store[_name][key].assign(bytes, bytes + len);
+    writes++;
+    return len;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (!value) return 0;
+    // Stored with its terminator, as nvs_set_str does
+    return putValue(key, value, strlen(value) + 1) ? strlen(value) : 0;
+}
+
+bool Preferences::getRaw(const char* key, void* out, size_t len) {
+    if (!_started || !validKey(key)) return false;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto ns = store.find(_name);
+    if (ns == store.end()) return false;
+    auto entry = ns->second.find(key);
+    if (entry == ns->second.end() || entry->second.size() != len) return false;
+    memcpy(out, entry->second.data(), len);
+    return true;
+}
+
+String Preferences::getString(const char* key, const String defaultValue) {
+    if (!_started || !validKey(key)) return defaultValue;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto ns = store.find(_name);
+    if (ns == store.end()) return defaultValue;
+    auto entry = ns->second.find(key);
+    if (entry == ns->second.end() || entry->second.empty()) return defaultValue;
+    return String((const char*)entry->second.data());
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    size_t len = getBytesLength(key);
+    if (len == 0 || !value || len > maxLen) return 0;
+    return getBytes(key, value, maxLen);
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!_started || !validKey(key)) return 0;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto ns = store.find(_name);
+    if (ns == store.end()) return 0;
+    auto entry = ns->second.find(key);
+    return entry == ns->second.end() ? 0 : entry->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!_started || !validKey(key) || !buf) return 0;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto ns = store.find(_name);
+    if (ns == store.end()) return 0;
+    auto entry = ns->second.find(key);
+    if (entry == ns->second.end()) return 0;
+    // Like the ESP32 library, a buffer that is too small gets nothing
+    if (entry->second.size() > maxLen) return 0;
+    memcpy(buf, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
+
+void Preferences::hostReset() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    store.clear();
+}
+
+uint32_t Preferences::hostWriteCount() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return writes;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+
+// In-memory NVS. All instances share one store, like the flash partition;
+// it starts empty on every host run.
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t freeEntries();
+
+    size_t putChar(const char* key, int8_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putInt(key, value); }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return putValue(key, value, len); }
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return getInt(key, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getUInt(key, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    String getString(const char* key, const String defaultValue = String());
+    size_t getString(const char* key, char* value, size_t maxLen);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+    // Host controls
+    static void hostReset();               // Erase every namespace
+    static uint32_t hostWriteCount();      // Successful put*/remove/clear calls so far
+
+private:
+    char _name[16] = "";
+    bool _started = false;
+    bool _readOnly = false;
+
+    size_t putValue(const char* key, const void* value, size_t len);
+    bool getRaw(const char* key, void* out, size_t len);
+
+    template <typename T>
+    T getValue(const char* key, T defaultValue) {
+        T value;
+        return getRaw(key, &value, sizeof(value)) ? value : defaultValue;
+    }
+};
@@ -0,0 +1,127 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string toBase(unsigned long value, unsigned char base, bool negative) {
+    if (base < 2 || base > 36) base = 10;
+    char buf[8 * sizeof(unsigned long) + 2];
+    char* p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do {
+        unsigned digit = value % base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value);
+    if (negative) *--p = '-';
+    return std::string(p);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+    if (base == 10 && value < 0) {
+        _s = toBase(0UL - (unsigned long)value, base, true);
+    } else {
+        _s = toBase((unsigned long)value, base, false);
+    }
+}
+
+String::String(unsigned long value, unsigned char base) : _s(toBase(value, base, false)) {}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    _s = buf;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    if (_s.size() != s._s.size()) return false;
+    for (size_t i = 0; i < _s.size(); i++) {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)s._s[i])) return false;
+    }
+    return true;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix._s.size() > _s.size()) return false;
+    return _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = _s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& s, unsigned int from) const {
+    size_t pos = _s.find(s._s, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = _s.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& s) const {
+    size_t pos = _s.rfind(s._s);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from) const {
+    return substring(from, length());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int tmp = from;
+        from = to;
+        to = tmp;
+    }
+    if (from >= _s.size()) return String();
+    if (to > _s.size()) to = (unsigned int)_s.size();
+    return String(_s.substr(from, to - from));
+}
+
+void String::toLowerCase() {
+    for (char& c : _s) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : _s) c = (char)toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t begin = 0;
+    while (begin < _s.size() && isspace((unsigned char)_s[begin])) begin++;
+    size_t end = _s.size();
+    while (end > begin && isspace((unsigned char)_s[end - 1])) end--;
+    _s = _s.substr(begin, end - begin);
+}
+
+void String::replace(const String& find, const String& with) {
+    if (find._s.empty()) return;
+    size_t pos = 0;
+    while ((pos = _s.find(find._s, pos)) != std::string::npos) {
+        _s.replace(pos, find._s.size(), with._s);
+        pos += with._s.size();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= _s.size()) return;
+    _s.erase(index, count);
+}
+
+long String::toInt() const {
+    return strtol(_s.c_str(), nullptr, 10);
+}
+
+float String::toFloat() const {
+    return strtof(_s.c_str(), nullptr);
+}
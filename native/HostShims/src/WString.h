@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// Arduino String backed by std::string. Only the members the firmware (and
+// ArduinoJson's String support) use are provided.
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const char* s, size_t len) : _s(s ? s : "", s ? len : 0) {}
+    String(const std::string& s) : _s(s) {}
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(unsigned char value, unsigned char base = 10) : String((unsigned int)value, base) {}
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) = default;
+    String& operator=(const char* s) { _s = s ? s : ""; return *this; }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return (unsigned int)_s.size(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+    char charAt(unsigned int i) const { return i < _s.size() ? _s[i] : '\0'; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { return _s[i]; }
+    void clear() { _s.clear(); }
+
+    bool concat(const String& s) { _s += s._s; return true; }
+    bool concat(const char* s) { if (!s) return false; _s += s; return true; }
+    bool concat(const char* s, unsigned int len) { if (!s) return false; _s.append(s, len); return true; }
+    bool concat(char c) { _s += c; return true; }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    String& operator+=(const String& s) { concat(s); return *this; }
+    String& operator+=(const char* s) { concat(s); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+    String& operator+=(int value) { concat(value); return *this; }
+    String& operator+=(unsigned int value) { concat(value); return *this; }
+
+    bool equals(const String& s) const { return _s == s._s; }
+    bool equals(const char* s) const { return _s == (s ? s : ""); }
+    bool equalsIgnoreCase(const String& s) const;
+    int compareTo(const String& s) const { return _s.compare(s._s); }
+    bool startsWith(const String& prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+    bool endsWith(const String& suffix) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& s, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String& s) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    void replace(const String& find, const String& with);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+
+    long toInt() const;
+    float toFloat() const;
+
+    const std::string& str() const { return _s; }
+
+private:
+    std::string _s;
+};
+
+inline bool operator==(const String& a, const String& b) { return a.equals(b); }
+inline bool operator==(const String& a, const char* b) { return a.equals(b); }
+inline bool operator==(const char* a, const String& b) { return b.equals(a); }
+inline bool operator!=(const String& a, const String& b) { return !a.equals(b); }
+inline bool operator!=(const String& a, const char* b) { return !a.equals(b); }
+inline bool operator!=(const char* a, const String& b) { return !b.equals(a); }
+inline bool operator<(const String& a, const String& b) { return a.compareTo(b) < 0; }
+
+inline String operator+(const String& a, const String& b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r.concat(b); return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, char b) { String r(a); r.concat(b); return r; }
+
+class __FlashStringHelper;
+#define F(s) (s)
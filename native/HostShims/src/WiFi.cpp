@@ -0,0 +1,259 @@
+#include "WiFi.h"
+#include "esp_wifi.h"
+#include <string.h>
+
+WiFiClass WiFi;
+
+static const HostNetwork DEFAULT_NETWORKS[] = {
+    { "LabNet", -48, 6, WIFI_AUTH_WPA2_PSK },
+    { "Invernadero", -63, 1, WIFI_AUTH_WPA2_PSK },
+    { "Invitados", -71, 11, WIFI_AUTH_OPEN },
+    { "LabNet", -80, 1, WIFI_AUTH_WPA2_PSK },
+    { "", -75, 6, WIFI_AUTH_WPA2_PSK },
+};
+
+static const uint8_t HOST_MAC[6] = { 0x24, 0x6F, 0x28, 0x00, 0xB1, 0x0A };
+
+void WiFiClass::defaultNetworks() {
+    if (!_networksSet) {
+        hostSetNetworks(DEFAULT_NETWORKS, sizeof(DEFAULT_NETWORKS) / sizeof(DEFAULT_NETWORKS[0]));
+    }
+}
+
+void WiFiClass::hostSetNetworks(const HostNetwork* networks, uint8_t count) {
+    _networksSet = true;
+    _networkCount = count < MAX_NETWORKS ? count : MAX_NETWORKS;
+    for (uint8_t i = 0; i < _networkCount; i++) {
+        strncpy(_networkNames[i], networks[i].ssid ? networks[i].ssid : "", 32);
+        _networkNames[i][32] = '\0';
+        _networks[i] = networks[i];
+        _networks[i].ssid = _networkNames[i];
+    }
+}
+
+const HostNetwork* WiFiClass::findNetwork(const char* ssid) {
+    defaultNetworks();
+    const HostNetwork* best = nullptr;
+    for (uint8_t i = 0; i < _networkCount; i++) {
+        if (ssid[0] && strcmp(_networks[i].ssid, ssid) == 0 && (!best || _networks[i].rssi > best->rssi)) {
+            best = &_networks[i];
+        }
+    }
+    return best;
+}
+
+static bool hasSta(wifi_mode_t mode) { return mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA; }
+static bool hasAp(wifi_mode_t mode) { return mode == WIFI_MODE_AP || mode == WIFI_MODE_APSTA; }
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventCb cb, arduino_event_id_t event) {
+    if (!cb || _handlerCount == MAX_EVENT_HANDLERS) return 0;
+    _handlers[_handlerCount++] = { cb, event };
+    return _handlerCount;
+}
+
+void WiFiClass::raise(arduino_event_id_t event) {
+    for (uint8_t i = 0; i < _handlerCount; i++) {
+        if (_handlers[i].event == ARDUINO_EVENT_MAX || _handlers[i].event == event) {
+            _handlers[i].cb(event);
+        }
+    }
+}
+
+// Interfaces that come up or go down raise their START/STOP events
+void WiFiClass::setMode(wifi_mode_t mode) {
+    wifi_mode_t old = _mode;
+    _mode = mode;
+    if (hasSta(old) && !hasSta(mode)) raise(ARDUINO_EVENT_WIFI_STA_STOP);
+    if (hasAp(old) && !hasAp(mode)) raise(ARDUINO_EVENT_WIFI_AP_STOP);
+    if (!hasSta(old) && hasSta(mode)) raise(ARDUINO_EVENT_WIFI_STA_START);
+    if (!hasAp(old) && hasAp(mode)) raise(ARDUINO_EVENT_WIFI_AP_START);
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    if (mode == WIFI_MODE_NULL || mode == WIFI_MODE_AP) {
+        _status = WL_DISCONNECTED;
+    }
+    setMode(mode);
+    return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+    return _mode;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int channel, int ssidHidden, int maxConnection) {
+    (void)passphrase;
+    (void)channel;
+    (void)ssidHidden;
+    (void)maxConnection;
+    if (!ssid || !ssid[0] || strlen(ssid) > 32) return false;
+    strncpy(_apSsid, ssid, sizeof(_apSsid) - 1);
+    if (_mode == WIFI_MODE_NULL) setMode(WIFI_MODE_AP);
+    if (_mode == WIFI_MODE_STA) setMode(WIFI_MODE_APSTA);
+    return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifiOff) {
+    _apSsid[0] = '\0';
+    if (_mode == WIFI_MODE_APSTA) setMode(WIFI_MODE_STA);
+    else if (_mode == WIFI_MODE_AP) setMode(WIFI_MODE_NULL);
+    if (wifiOff) setMode(WIFI_MODE_NULL);
+    return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+    return (_mode == WIFI_MODE_AP || _mode == WIFI_MODE_APSTA) ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+String WiFiClass::softAPSSID() const {
+    return String(_apSsid);
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+    (void)passphrase;
+    if (_mode == WIFI_MODE_NULL) setMode(WIFI_MODE_STA);
+    if (_mode == WIFI_MODE_AP) setMode(WIFI_MODE_APSTA);
+    strncpy(_staSsid, ssid ? ssid : "", sizeof(_staSsid) - 1);
+
+    const HostNetwork* network = findNetwork(_staSsid);
+    if (network) {
+        _status = WL_CONNECTED;
+        _staRssi = network->rssi;
+        raise(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+        raise(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    } else {
+        _status = WL_NO_SSID_AVAIL;
+        _staRssi = 0;
+        raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    }
+    return _status;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    _status = WL_DISCONNECTED;
+    if (eraseAp) _staSsid[0] = '\0';
+    raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    if (wifiOff) setMode(WIFI_MODE_NULL);
+    return true;
+}
+
+void WiFiClass::hostDropConnection() {
+    if (_status != WL_CONNECTED) return;
+    _status = WL_CONNECTION_LOST;
+    raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+}
+
+wl_status_t WiFiClass::status() {
+    if (_mode != WIFI_MODE_STA && _mode != WIFI_MODE_APSTA && _status == WL_CONNECTED) {
+        return WL_DISCONNECTED;
+    }
+    return _status;
+}
+
+IPAddress WiFiClass::localIP() {
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+String WiFiClass::SSID() const {
+    return String(_status == WL_CONNECTED ? _staSsid : "");
+}
+
+int8_t WiFiClass::RSSI() {
+    return status() == WL_CONNECTED ? _staRssi : 0;
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+    memcpy(mac, HOST_MAC, sizeof(HOST_MAC));
+    return mac;
+}
+
+String WiFiClass::macAddress() {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+             HOST_MAC[0], HOST_MAC[1], HOST_MAC[2], HOST_MAC[3], HOST_MAC[4], HOST_MAC[5]);
+    return String(buf);
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChannel, uint8_t channel) {
+    (void)showHidden;
+    (void)passive;
+    (void)maxMsPerChannel;
+    (void)channel;
+    if (_scanning) return WIFI_SCAN_RUNNING;
+    if (_scanFails || _mode == WIFI_MODE_NULL || _mode == WIFI_MODE_AP) return WIFI_SCAN_FAILED;
+
+    defaultNetworks();
+    _scans++;
+    _scanDone = false;
+    _scanning = true;
+    _scanStartMs = millis();
+    if (!async) {
+        delay(_scanDurationMs);
+        return scanComplete();
+    }
+    return WIFI_SCAN_RUNNING;
+}
+
+int16_t WiFiClass::scanComplete() {
+    if (_scanning) {
+        if (millis() - _scanStartMs < _scanDurationMs) return WIFI_SCAN_RUNNING;
+        _scanning = false;
+        _scanDone = true;
+        raise(ARDUINO_EVENT_WIFI_SCAN_DONE);
+    }
+    return _scanDone ? _networkCount : WIFI_SCAN_FAILED;
+}
+
+void WiFiClass::scanDelete() {
+    _scanDone = false;
+}
+
+String WiFiClass::SSID(uint8_t i) {
+    return String(_scanDone && i < _networkCount ? _networks[i].ssid : "");
+}
+
+int32_t WiFiClass::RSSI(uint8_t i) {
+    return _scanDone && i < _networkCount ? _networks[i].rssi : 0;
+}
+
+int32_t WiFiClass::channel(uint8_t i) {
+    return _scanDone && i < _networkCount ? _networks[i].channel : 0;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t i) {
+    return _scanDone && i < _networkCount ? _networks[i].auth : WIFI_AUTH_OPEN;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf) {
+    if (!conf) return ESP_ERR_INVALID_ARG;
+    if (WiFi._mode == WIFI_MODE_NULL) return ESP_ERR_WIFI_NOT_INIT;
+    memset(conf, 0, sizeof(*conf));
+    if (interface == WIFI_IF_AP) {
+        size_t len = strlen(WiFi._apSsid);
+        memcpy(conf->ap.ssid, WiFi._apSsid, len);
+        conf->ap.ssid_len = (uint8_t)len;
+    } else {
+        memcpy(conf->sta.ssid, WiFi._staSsid, strlen(WiFi._staSsid));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* apInfo) {
+    if (!apInfo) return ESP_ERR_INVALID_ARG;
+    if (WiFi.status() != WL_CONNECTED) return ESP_ERR_WIFI_NOT_CONNECT;
+    memset(apInfo, 0, sizeof(*apInfo));
+    memcpy(apInfo->ssid, WiFi._staSsid, strlen(WiFi._staSsid));
+    apInfo->rssi = WiFi._staRssi;
+    const HostNetwork* network = WiFi.findNetwork(WiFi._staSsid);
+    if (network) {
+        apInfo->primary = network->channel;
+        apInfo->authmode = network->auth;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t* mode) {
+    if (!mode) return ESP_ERR_INVALID_ARG;
+    *mode = WiFi._mode;
+    return ESP_OK;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include "Arduino.h"
+#include "esp_err.h"
+#include "esp_wifi_types.h"
+
+#define WIFI_OFF    WIFI_MODE_NULL
+#define WIFI_STA    WIFI_MODE_STA
+#define WIFI_AP     WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+// The events the host radio raises, numbered as in Arduino-ESP32
+typedef enum {
+    ARDUINO_EVENT_WIFI_READY = 0,
+    ARDUINO_EVENT_WIFI_SCAN_DONE = 1,
+    ARDUINO_EVENT_WIFI_STA_START = 2,
+    ARDUINO_EVENT_WIFI_STA_STOP = 3,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+    ARDUINO_EVENT_WIFI_AP_START = 10,
+    ARDUINO_EVENT_WIFI_AP_STOP = 11,
+    ARDUINO_EVENT_MAX = 40
+} arduino_event_id_t;
+typedef arduino_event_id_t WiFiEvent_t;
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+typedef size_t wifi_event_id_t;
+
+// Network the host radio "sees"
+struct HostNetwork {
+    const char* ssid;
+    int8_t rssi;
+    uint8_t channel;
+    wifi_auth_mode_t auth;
+};
+
+// Host stand-in for the ESP32 WiFi stack. The radio sees a fixed list of
+// networks (settable); begin() joins one of them, asynchronous scans complete
+// after a configurable delay, and nothing ever reaches a real network.
+// Events are delivered synchronously from the call that caused them.
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode();
+
+    // ARDUINO_EVENT_MAX receives every event
+    wifi_event_id_t onEvent(WiFiEventCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+
+    bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1, int ssidHidden = 0,
+                int maxConnection = 4);
+    bool softAPdisconnect(bool wifiOff = false);
+    IPAddress softAPIP();
+    String softAPSSID() const;
+
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    wl_status_t status();
+    bool isConnected() { return status() == WL_CONNECTED; }
+    IPAddress localIP();
+    String SSID() const;
+    int8_t RSSI();
+    uint8_t* macAddress(uint8_t* mac);
+    String macAddress();
+
+    int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                         uint32_t maxMsPerChannel = 300, uint8_t channel = 0);
+    int16_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t i);
+    int32_t RSSI(uint8_t i);
+    int32_t channel(uint8_t i);
+    wifi_auth_mode_t encryptionType(uint8_t i);
+
+    // Host controls
+    void hostSetNetworks(const HostNetwork* networks, uint8_t count);
+    void hostSetScanDuration(uint32_t ms) { _scanDurationMs = ms; }
+    void hostSetScanFails(bool fails) { _scanFails = fails; }
+    uint32_t hostScanCount() const { return _scans; }
+    // Drops the station link, as if the access point went away
+    void hostDropConnection();
+
+private:
+    friend esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf);
+    friend esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* apInfo);
+    friend esp_err_t esp_wifi_get_mode(wifi_mode_t* mode);
+
+    static constexpr uint8_t MAX_NETWORKS = 32;
+    static constexpr uint8_t MAX_EVENT_HANDLERS = 8;
+
+    struct EventHandler {
+        WiFiEventCb cb;
+        arduino_event_id_t event;
+    };
+
+    wifi_mode_t _mode = WIFI_MODE_NULL;
+    char _apSsid[33] = "";
+    char _staSsid[33] = "";
+    wl_status_t _status = WL_IDLE_STATUS;
+    int8_t _staRssi = 0;
+
+    HostNetwork _networks[MAX_NETWORKS] = {};
+    char _networkNames[MAX_NETWORKS][33] = {};
+    uint8_t _networkCount = 0;
+    bool _networksSet = false;
+
+    uint32_t _scanDurationMs = 0;
+    bool _scanFails = false;
+    bool _scanning = false;
+    bool _scanDone = false;
+    unsigned long _scanStartMs = 0;
+    uint32_t _scans = 0;
+
+    EventHandler _handlers[MAX_EVENT_HANDLERS] = {};
+    uint8_t _handlerCount = 0;
+
+    void defaultNetworks();
+    void setMode(wifi_mode_t mode);
+    void raise(arduino_event_id_t event);
+    const HostNetwork* findNetwork(const char* ssid);
+};
+
+extern WiFiClass WiFi;
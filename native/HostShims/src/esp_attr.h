@@ -0,0 +1,10 @@
+#pragma once
+
+// Section attributes have no meaning on the host; RTC memory is ordinary
+// (zero-initialised) memory, i.e. every host run looks like a power-on boot.
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_RODATA_ATTR
+#define EXT_RAM_ATTR
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                 0
+#define ESP_FAIL               -1
+#define ESP_ERR_NO_MEM         0x101
+#define ESP_ERR_INVALID_ARG    0x102
+#define ESP_ERR_INVALID_STATE  0x103
+#define ESP_ERR_NOT_FOUND      0x105
+#define ESP_ERR_WIFI_BASE      0x3000
+#define ESP_ERR_WIFI_NOT_INIT  (ESP_ERR_WIFI_BASE + 1)
+#define ESP_ERR_WIFI_CONN      (ESP_ERR_WIFI_BASE + 7)
+#define ESP_ERR_WIFI_NOT_CONNECT (ESP_ERR_WIFI_BASE + 15)
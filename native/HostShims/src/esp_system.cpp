@@ -0,0 +1,41 @@
+#include "esp_system.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SHUTDOWN_HANDLERS_NO 5
+
+static shutdown_handler_t shutdownHandlers[SHUTDOWN_HANDLERS_NO];
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler) {
+    for (int i = 0; i < SHUTDOWN_HANDLERS_NO; i++) {
+        if (shutdownHandlers[i] == handler) return ESP_ERR_INVALID_STATE;
+        if (shutdownHandlers[i] == nullptr) {
+            shutdownHandlers[i] = handler;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handler) {
+    for (int i = 0; i < SHUTDOWN_HANDLERS_NO; i++) {
+        if (shutdownHandlers[i] == handler) {
+            shutdownHandlers[i] = nullptr;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_STATE;
+}
+
+void esp_restart(void) {
+    // Same order as the IDF: last registered handler first
+    for (int i = SHUTDOWN_HANDLERS_NO - 1; i >= 0; i--) {
+        if (shutdownHandlers[i]) shutdownHandlers[i]();
+    }
+    fflush(stdout);
+    exit(0);
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return ESP_RST_POWERON;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_wifi_types.h"
+
+// Backed by the host WiFi fake (see WiFi.h)
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* apInfo);
+esp_err_t esp_wifi_get_mode(wifi_mode_t* mode);
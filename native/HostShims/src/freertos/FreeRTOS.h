@@ -0,0 +1,48 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF FreeRTOS port. Ticks are milliseconds,
+// critical sections are spin locks and tasks are std::threads.
+
+#include <stdint.h>
+#include <atomic>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY      ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskNO_AFFINITY     0x7FFFFFFF
+#define portNUM_PROCESSORS 2
+
+// Non-recursive spin lock; nesting the same mux deadlocks, as on the board.
+struct portMUX_TYPE {
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux)     vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)      vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)  vPortExitCritical(mux)
+#define taskENTER_CRITICAL(mux)     vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux)      vPortExitCritical(mux)
+
+#define portYIELD_FROM_ISR(...) do {} while (0)
+
+// Core of the calling task (portmacro.h on the ESP32)
+BaseType_t xPortGetCoreID(void);
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
@@ -0,0 +1,128 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct HostTask {
+    std::thread::id thread;
+    const char* name;
+    // Notification value (counting semaphore use only)
+    std::mutex notifyLock;
+    std::condition_variable notified;
+    uint32_t notifyValue = 0;
+};
+
+namespace {
+// Unwinds a task's thread when it deletes itself
+struct TaskExit {};
+}
+
+static const auto tickEpoch = std::chrono::steady_clock::now();
+
+// setup()/loop() run on core 1, as with the Arduino core
+static thread_local BaseType_t currentCore = 1;
+// Created on first use for threads that are not tasks (the loop task)
+static thread_local HostTask* currentTask = nullptr;
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    while (mux->flag.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    mux->flag.clear(std::memory_order_release);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - tickEpoch).count() / portTICK_PERIOD_MS;
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    (void)stackDepth;
+    (void)priority;
+    HostTask* task = new HostTask();
+    task->name = name;
+    BaseType_t pinned = (core >= 0 && core < portNUM_PROCESSORS) ? core : 0;
+    std::thread thread([fn, arg, pinned, task]() {
+        currentCore = pinned;
+        currentTask = task;
+        try {
+            fn(arg);
+        } catch (const TaskExit&) {
+        }
+    });
+    task->thread = thread.get_id();
+    thread.detach();
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+    *previousWake += period;
+    std::this_thread::sleep_until(tickEpoch + std::chrono::milliseconds(*previousWake * portTICK_PERIOD_MS));
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task->thread == std::this_thread::get_id()) {
+        throw TaskExit();
+    }
+}
+
+BaseType_t xPortGetCoreID(void) {
+    return currentCore;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (!currentTask) {
+        currentTask = new HostTask();
+        currentTask->thread = std::this_thread::get_id();
+        currentTask->name = "loopTask";
+    }
+    return currentTask;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    HostTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->notifyLock);
+    auto ready = [task]() { return task->notifyValue != 0; };
+    if (ticksToWait == portMAX_DELAY) {
+        task->notified.wait(lock, ready);
+    } else {
+        task->notified.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready);
+    }
+    uint32_t value = task->notifyValue;
+    if (value) task->notifyValue = clearCountOnExit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->notifyLock);
+        task->notifyValue++;
+    }
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdTRUE;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef struct HostTask* TaskHandle_t;
+
+// The task runs on a detached std::thread; priority is ignored and the core
+// is only what xPortGetCoreID() reports inside it.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* handle);
+
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period);
+// Only a task deleting itself (nullptr) is supported; it ends its thread.
+void vTaskDelete(TaskHandle_t task);
+
+// Direct-to-task notifications, used as a counting semaphore. Threads that
+// are not tasks (the one running setup()/loop()) get a handle on first use.
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken);
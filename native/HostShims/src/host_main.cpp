@@ -0,0 +1,16 @@
+#include "Arduino.h"
+
+// Host entry point: setup() once, then loop() forever, or for the number of
+// iterations given as the first argument. Builds that provide their own
+// main() (benchmarks, tools) define HOST_NO_MAIN; unit tests bring Unity's.
+#if !defined(HOST_NO_MAIN) && !defined(PIO_UNIT_TESTING)
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 0;
+    setup();
+    for (long i = 0; iterations <= 0 || i < iterations; i++) {
+        loop();
+        delay(1); // The Arduino loop task yields to the idle task
+    }
+    return 0;
+}
+#endif
@@ -2,14 +2,64 @@
 
 // Hardware Defines
 #define LED_TYPE     WS2811
-#define NUM_LEDS     4
 #define DATA_PIN     25
 
+// Pixel buffer capacity and segment table. The actual strip layout is
+// configured at runtime (/api/segments) and persisted in NVS; without one,
+// a single segment of DEFAULT_NUM_LEDS pixels is used.
+#define MAX_LEDS         600
+#define MAX_SEGMENTS     8
+#define DEFAULT_NUM_LEDS 4
+
+// Parallel outputs. Each segment is assigned to one data pin and all pins
+// are sent concurrently (RMT, or the I2S parallel driver with LED_USE_I2S),
+// so a frame takes as long as the busiest output instead of the whole strip.
+// Output 0 is DATA_PIN.
+#ifndef LED_OUTPUT_COUNT
+#define LED_OUTPUT_COUNT 1
+#endif
+#define LED_OUTPUT_PIN_1 26
+#define LED_OUTPUT_PIN_2 27
+#define LED_OUTPUT_PIN_3 14
+#ifndef LED_USE_I2S
+#define LED_USE_I2S      0
+#endif
+
+// LED render task: owns the pixel buffer and calls FastLED.show() at most
+// once per frame.
+#define LED_FRAME_RATE_HZ    60
+#define LED_RENDER_CORE      1
+#define LED_RENDER_PRIORITY  2
+#define LED_RENDER_STACK     4096
+#define LED_TRANSITION_MAX_MS 600000 // Longest fade accepted through the API
+// 1: no render task; frames are rendered by calling LedDriver::renderOnce()
+// (host benchmarks, see bench/).
+#ifndef LED_MANUAL_RENDER
+#define LED_MANUAL_RENDER    0
+#endif
+
 // Rotary Encoder Pins
 #define ENCODER_CLK_PIN 5
 #define ENCODER_DT_PIN  18
 #define ENCODER_SW_PIN  19
 
+// Encoder input is decoded in GPIO interrupts and queued; loop() sleeps up to
+// UI_IDLE_WAIT_MS waiting for it before running its periodic work.
+#define ENCODER_DEBOUNCE_US   5000
+#define ENCODER_LONG_PRESS_MS 1000
+#define ENCODER_QUEUE_LEN     32   // Power of two
+#define UI_IDLE_WAIT_MS       20
+
+// 16x2 I2C character LCD. Screens draw into a RAM frame; a flush task sends
+// only the changed characters, at most once per LCD_FLUSH_INTERVAL_MS.
+#define LCD_ADDR              0x27
+#define LCD_COLS              16
+#define LCD_ROWS              2
+#define LCD_FLUSH_INTERVAL_MS 50
+#define LCD_FLUSH_CORE        1
+#define LCD_FLUSH_PRIORITY    1
+#define LCD_FLUSH_STACK       2048
+
 // Logical Control Range
 #define RGB_MIN      0
 #define RGB_MAX      255
@@ -22,6 +72,22 @@
 #define NVS_KEY_G       "g"
 #define NVS_KEY_B       "b"
 #define NVS_KEY_INT     "int"
+#define NVS_KEY_LIGHT_REC "light"
+#define NVS_KEY_SEGMENTS  "segs"
+
+// Deferred light-state persistence: commit to NVS only after this much
+// time without further changes (ms).
+#define LIGHT_PERSIST_QUIET_MS 3000
+
+// Live control WebSocket (/ws). Clients send 5-byte binary frames
+// (r, g, b, intensity, flags); state changes are pushed back to all of them.
+#define WS_PATH            "/ws"
+#define WS_FADE_MS         150  // Fade used for frames with WS_FLAG_FADE
+#define WS_CLEANUP_MS      1000 // Drop clients beyond the library's limit
+
+// Server-Sent Events stream with "light", "wifi" and "scan" events, sent
+// together with the WebSocket pushes.
+#define EVENTS_PATH "/api/events"
 
 // NVS Keys for WiFi
 #define NVS_WIFI_NAMESPACE "wificfg"
@@ -31,6 +97,11 @@
 #define NVS_KEY_AP_SSID      "ap_ssid"
 #define NVS_KEY_AP_PASS      "ap_pass"
 
+// WiFi scan cache: results younger than the TTL are reused unless a scan is
+// forced. Only the strongest WIFI_SCAN_MAX_RESULTS networks are kept.
+#define WIFI_SCAN_TTL_MS      30000
+#define WIFI_SCAN_MAX_RESULTS 20
+
 // Access Point configuration
 #define AP_SSID "BioShacker_Conf"
 
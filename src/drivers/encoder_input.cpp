@@ -0,0 +1,112 @@
+#include "encoder_input.h"
+#include <Arduino.h>
+
+// Quarter-step direction for (previous state << 2 | state), where a state is
+// DT | CLK << 1. Invalid (skipped) transitions count as 0.
+static const int8_t DRAM_ATTR QUADRATURE_STEP[16] = {
+    0, -1, 1, 0,
+    1, 0, 0, -1,
+    -1, 0, 0, 1,
+    0, 1, -1, 0
+};
+
+#define DETENT_STATE 3 // Both pins high at rest
+
+void EncoderInput::begin(uint8_t clkPin, uint8_t dtPin, uint8_t swPin) {
+    _clkPin = clkPin;
+    _dtPin = dtPin;
+    _swPin = swPin;
+    _consumer = xTaskGetCurrentTaskHandle();
+
+    pinMode(_clkPin, INPUT_PULLUP);
+    pinMode(_dtPin, INPUT_PULLUP);
+    pinMode(_swPin, INPUT_PULLUP);
+    _quadState = digitalRead(_dtPin) | (digitalRead(_clkPin) << 1);
+    _buttonDown = digitalRead(_swPin) == LOW;
+
+    attachInterruptArg(digitalPinToInterrupt(_clkPin), onQuadratureEdge, this, CHANGE);
+    attachInterruptArg(digitalPinToInterrupt(_dtPin), onQuadratureEdge, this, CHANGE);
+    attachInterruptArg(digitalPinToInterrupt(_swPin), onButtonEdge, this, CHANGE);
+}
+
+void IRAM_ATTR EncoderInput::post(const RawEvent& event) {
+    _queue.push(event);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(_consumer, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void IRAM_ATTR EncoderInput::onQuadratureEdge(void* arg) {
+    EncoderInput* self = (EncoderInput*)arg;
+    uint8_t state = digitalRead(self->_dtPin) | (digitalRead(self->_clkPin) << 1);
+    if (state == self->_quadState) return;
+    self->_steps += QUADRATURE_STEP[(self->_quadState << 2) | state];
+    self->_quadState = state;
+
+    if (state != DETENT_STATE) return;
+    int32_t detent = self->_steps >> 2;
+    int32_t delta = detent - self->_latched;
+    if (delta == 0) return;
+    self->_latched = detent;
+    if (delta > 127) delta = 127;
+    if (delta < -127) delta = -127;
+    self->post(RawEvent{ RAW_TURN, (int8_t)delta, (uint32_t)micros() });
+}
+
+void IRAM_ATTR EncoderInput::onButtonEdge(void* arg) {
+    EncoderInput* self = (EncoderInput*)arg;
+    uint32_t now = (uint32_t)micros();
+    bool down = digitalRead(self->_swPin) == LOW;
+    // Only a change of the debounced level counts, and contact bounce right
+    // after an accepted edge is ignored
+    if (down == self->_buttonDown || now - self->_buttonEdgeUs < ENCODER_DEBOUNCE_US) return;
+    self->_buttonDown = down;
+    self->_buttonEdgeUs = now;
+    self->post(RawEvent{ down ? RAW_PRESS : RAW_RELEASE, 0, now });
+}
+
+bool EncoderInput::next(EncoderEvent& event, uint32_t waitMs) {
+    const uint32_t longUs = ENCODER_LONG_PRESS_MS * 1000UL;
+    uint32_t start = millis();
+
+    for (;;) {
+        RawEvent raw;
+        while (_queue.pop(raw)) {
+            switch (raw.kind) {
+                case RAW_TURN:
+                    event = EncoderEvent{ ENC_TURN, raw.detents };
+                    return true;
+                case RAW_PRESS:
+                    _pressed = true;
+                    _longSent = false;
+                    _pressUs = raw.us;
+                    break;
+                case RAW_RELEASE:
+                    if (!_pressed) break;
+                    _pressed = false;
+                    if (!_longSent) {
+                        event = EncoderEvent{ ENC_CLICK, 0 };
+                        return true;
+                    }
+                    break;
+            }
+        }
+
+        uint32_t heldUs = micros() - _pressUs;
+        if (_pressed && !_longSent && heldUs >= longUs) {
+            _longSent = true;
+            event = EncoderEvent{ ENC_LONG_PRESS, 0 };
+            return true;
+        }
+
+        uint32_t elapsed = millis() - start;
+        if (elapsed >= waitMs) return false;
+        uint32_t wait = waitMs - elapsed;
+        if (_pressed && !_longSent) {
+            // Wake up in time to report the long press
+            uint32_t untilLong = (longUs - heldUs) / 1000 + 1;
+            if (untilLong < wait) wait = untilLong;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+    }
+}
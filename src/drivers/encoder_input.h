@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../util/spsc_queue.h"
+#include "../config.h"
+
+enum EncoderEventKind : uint8_t {
+    ENC_TURN,        // `detents` steps, positive clockwise
+    ENC_CLICK,       // Released before ENCODER_LONG_PRESS_MS
+    ENC_LONG_PRESS   // Held for ENCODER_LONG_PRESS_MS (sent while still held)
+};
+
+struct EncoderEvent {
+    EncoderEventKind kind;
+    int8_t detents;
+};
+
+// Rotary encoder and push button decoded in GPIO interrupts.
+//
+// The quadrature pins are decoded on every edge with a Gray-code transition
+// table (bounce cancels itself out) and latched on the detent position, like
+// RotaryEncoder's FOUR3 mode. Button edges are timestamped in the interrupt
+// and debounced against the previous accepted edge. The handlers push raw
+// events into a lock-free queue and notify the task that called begin(),
+// which turns them into clicks and long presses in next() and can sleep in
+// there while the knob is idle.
+class EncoderInput {
+public:
+    // Configures the pins and attaches the interrupts. The calling task is
+    // the one next() must be called from.
+    void begin(uint8_t clkPin, uint8_t dtPin, uint8_t swPin);
+
+    // Waits up to `waitMs` for the next event; false on timeout.
+    bool next(EncoderEvent& event, uint32_t waitMs);
+
+    // Raw events lost to a full queue
+    uint32_t droppedCount() const { return _queue.dropped(); }
+
+private:
+    enum RawKind : uint8_t { RAW_TURN, RAW_PRESS, RAW_RELEASE };
+    struct RawEvent {
+        RawKind kind;
+        int8_t detents;
+        uint32_t us; // micros() at the edge
+    };
+
+    static void IRAM_ATTR onQuadratureEdge(void* arg);
+    static void IRAM_ATTR onButtonEdge(void* arg);
+    void IRAM_ATTR post(const RawEvent& event);
+
+    SpscQueue<RawEvent, ENCODER_QUEUE_LEN> _queue;
+    TaskHandle_t _consumer = nullptr;
+    uint8_t _clkPin = 0;
+    uint8_t _dtPin = 0;
+    uint8_t _swPin = 0;
+
+    // Interrupt state
+    volatile uint8_t _quadState = 3;
+    volatile int32_t _steps = 0;     // Quarter steps
+    volatile int32_t _latched = 0;   // _steps / 4 at the last detent
+    volatile bool _buttonDown = false;
+    volatile uint32_t _buttonEdgeUs = 0;
+
+    // Consumer state
+    bool _pressed = false;
+    bool _longSent = false;
+    uint32_t _pressUs = 0;
+};
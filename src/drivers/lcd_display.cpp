@@ -0,0 +1,92 @@
+#include "lcd_display.h"
+#include <string.h>
+#include "../util/metrics.h"
+
+LcdDisplay::LcdDisplay(uint8_t addr) :
+    _lcd(addr, LCD_COLS, LCD_ROWS) {
+    memset(&_draft, ' ', sizeof(_draft));
+    _presented = _draft;
+    _shown = _draft;
+}
+
+void LcdDisplay::begin() {
+    _lcd.init();
+    _lcd.backlight();
+    _lcd.clear(); // Matches _shown, cursor at 0,0
+
+    xTaskCreatePinnedToCore(
+        flushTask,
+        "lcdFlush",
+        LCD_FLUSH_STACK,
+        this,
+        LCD_FLUSH_PRIORITY,
+        &_task,
+        LCD_FLUSH_CORE);
+}
+
+void LcdDisplay::clear() {
+    memset(&_draft, ' ', sizeof(_draft));
+}
+
+void LcdDisplay::printRow(uint8_t row, const char* text) {
+    if (row >= LCD_ROWS) return;
+    size_t len = strnlen(text, LCD_COLS);
+    memcpy(_draft.text[row], text, len);
+    memset(_draft.text[row] + len, ' ', LCD_COLS - len);
+}
+
+void LcdDisplay::present() {
+    if (memcmp(&_draft, &_presented, sizeof(_draft)) == 0) return;
+    _presented = _draft;
+    _mailbox.post(_draft);
+    if (_task) xTaskNotifyGive(_task);
+}
+
+void LcdDisplay::flushTask(void* arg) {
+    LcdDisplay* self = static_cast<LcdDisplay*>(arg);
+    const TickType_t interval = pdMS_TO_TICKS(LCD_FLUSH_INTERVAL_MS) ? pdMS_TO_TICKS(LCD_FLUSH_INTERVAL_MS) : 1;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        LcdFrame frame;
+        if (self->_mailbox.take(frame)) {
+            self->flush(frame);
+        }
+        // Bounds the refresh rate; frames presented meanwhile are coalesced
+        vTaskDelay(interval);
+    }
+}
+
+void LcdDisplay::flush(const LcdFrame& frame) {
+    MetricTimer timer(metrics::lcdFlush);
+    uint32_t writes = 0;
+    for (uint8_t row = 0; row < LCD_ROWS; row++) {
+        const char* want = frame.text[row];
+        char* have = _shown.text[row];
+        uint8_t col = 0;
+        while (col < LCD_COLS) {
+            if (want[col] == have[col]) {
+                col++;
+                continue;
+            }
+            // Extend the run over single unchanged characters: rewriting one
+            // costs the same bus time as the cursor command that skips it.
+            uint8_t end = col + 1;
+            for (uint8_t i = end; i < LCD_COLS && i - end <= 1; i++) {
+                if (want[i] != have[i]) end = i + 1;
+            }
+            if (row != _cursorRow || col != _cursorCol) {
+                _lcd.setCursor(col, row);
+                writes++;
+            }
+            _lcd.write((const uint8_t*)want + col, end - col);
+            memcpy(have + col, want + col, end - col);
+            writes += end - col;
+            _cursorRow = row;
+            _cursorCol = end;
+            col = end;
+        }
+    }
+    _flushes++;
+    _busWrites += writes;
+    metrics::lcdWrites.inc(writes);
+}
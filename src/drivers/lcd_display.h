@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../util/mailbox.h"
+#include "../config.h"
+
+struct LcdFrame {
+    char text[LCD_ROWS][LCD_COLS];
+};
+
+// Character LCD behind a shadow framebuffer.
+//
+// Screens draw into a RAM frame with clear()/printRow(), which never touch
+// the bus, and publish it with present(). A flush task diffs the newest
+// published frame against what the display currently shows and sends only
+// the changed runs of characters, at most once per LCD_FLUSH_INTERVAL_MS.
+// Frames presented in between collapse into the latest one, so the UI never
+// blocks on the ~100 kHz I2C backpack and redrawing an unchanged screen costs
+// nothing.
+class LcdDisplay {
+public:
+    explicit LcdDisplay(uint8_t addr);
+
+    // Initializes the display and starts the flush task.
+    void begin();
+
+    // Drawing (caller's frame only)
+    void clear();
+    void printRow(uint8_t row, const char* text); // Truncated/padded to the row
+    void printRow(uint8_t row, const String& text) { printRow(row, text.c_str()); }
+
+    // Publishes the frame drawn so far; a no-op when nothing changed.
+    void present();
+
+    // Bus traffic: characters plus cursor commands sent by the flush task
+    uint32_t flushCount() const { return _flushes; }
+    uint32_t busWriteCount() const { return _busWrites; }
+
+private:
+    static void flushTask(void* arg);
+    void flush(const LcdFrame& frame);
+
+    LiquidCrystal_I2C _lcd;
+    Mailbox<LcdFrame> _mailbox;
+    TaskHandle_t _task = nullptr;
+
+    // Caller state
+    LcdFrame _draft;
+    LcdFrame _presented;
+
+    // Flush task state
+    LcdFrame _shown;
+    uint8_t _cursorCol = 0;
+    uint8_t _cursorRow = 0;
+
+    volatile uint32_t _flushes = 0;
+    volatile uint32_t _busWrites = 0;
+};
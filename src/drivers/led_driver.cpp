@@ -1,39 +1,365 @@
 #include "led_driver.h"
-#include <FastLED.h>
 #include "../config.h"
+#if LED_USE_I2S
+#define FASTLED_ESP32_I2S true // Must precede FastLED.h
+#endif
+#include <FastLED.h>
+#include <string.h>
+#include "led_timing.h"
+#include "../util/metrics.h"
 
-// Define the array of leds
-CRGB leds[NUM_LEDS];
+static_assert(LED_OUTPUT_COUNT >= 1 && LED_OUTPUT_COUNT <= 4, "LED_OUTPUT_COUNT must be 1-4");
 
-void LedDriver::initLeds() {
-    FastLED.addLeds<LED_TYPE, DATA_PIN>(leds, NUM_LEDS);
-    FastLED.setBrightness(255); // Start at max brightness, intensity will scale it
-    setColor(0, 0, 0, 100);   // Default to off but full intensity
+// Define the array of leds. Only the render task writes to it; segments are
+// filled with word stores, so keep it word aligned.
+alignas(4) CRGB leds[MAX_LEDS];
+// One controller per data pin; each sends its own slice of leds[].
+static CLEDController* controllers[LED_OUTPUT_COUNT] = {};
+// Unused outputs keep a single dark pixel instead of an empty slice.
+static CRGB idlePixel[LED_OUTPUT_COUNT];
+
+static uint32_t packState(const LightState& s) {
+    return (uint32_t)s.r | ((uint32_t)s.g << 8) | ((uint32_t)s.b << 16) | ((uint32_t)s.intensity << 24);
+}
+
+static void unpackState(uint32_t packed, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct) {
+    r = packed & 0xFF;
+    g = (packed >> 8) & 0xFF;
+    b = (packed >> 16) & 0xFF;
+    intensityPct = packed >> 24;
 }
 
-void LedDriver::setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct) {
-    // Store current state
-    current_r = r;
-    current_g = g;
-    current_b = b;
-    current_intensity = intensityPct;
+void LedDriver::initLeds(const SegmentLayout& layout) {
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        _segmentCurrent[i].store(_current.load());
+    }
+    applyLayout(layout);
+    _layout = layout;
 
-    // Map intensity (0-100) to brightness (0-255)
-    uint8_t brightness = map(intensityPct, INT_MIN_PCT, INT_MAX_PCT, 0, 255);
-    FastLED.setBrightness(brightness);
+    // Pins are template parameters, so each output is registered explicitly.
+    controllers[0] = &FastLED.addLeds<LED_TYPE, DATA_PIN>(idlePixel, 1);
+#if LED_OUTPUT_COUNT > 1
+    controllers[1] = &FastLED.addLeds<LED_TYPE, LED_OUTPUT_PIN_1>(idlePixel + 1, 1);
+#endif
+#if LED_OUTPUT_COUNT > 2
+    controllers[2] = &FastLED.addLeds<LED_TYPE, LED_OUTPUT_PIN_2>(idlePixel + 2, 1);
+#endif
+#if LED_OUTPUT_COUNT > 3
+    controllers[3] = &FastLED.addLeds<LED_TYPE, LED_OUTPUT_PIN_3>(idlePixel + 3, 1);
+#endif
+    assignOutputs(layout);
+    FastLED.setBrightness(255); // Intensity is applied per segment
+    FastLED.setDither(0);       // Frames are only sent on change
+    setColor(0, 0, 0, 100);   // Default to off but full intensity
+
+#if !LED_MANUAL_RENDER
+    xTaskCreatePinnedToCore(
+        renderTask,
+        "ledRender",
+        LED_RENDER_STACK,
+        this,
+        LED_RENDER_PRIORITY,
+        &_task,
+        LED_RENDER_CORE);
+#endif
+}
 
-    // Set color for all LEDs
-    for (int i = 0; i < NUM_LEDS; i++) {
-        leds[i] = CRGB(r, g, b);
+void LedDriver::postColor(uint8_t segment, const LightCommand& cmd) {
+    uint32_t packed = packState(cmd.state);
+    if (segment == MAX_SEGMENTS) {
+        _current.store(packed, std::memory_order_relaxed);
+        for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+            _segmentCurrent[i].store(packed, std::memory_order_relaxed);
+        }
+        _colorChanges.fetch_add(1, std::memory_order_relaxed);
+        _mailbox.post(cmd);
+    } else {
+        _segmentCurrent[segment].store(packed, std::memory_order_relaxed);
+        _segmentMailbox[segment].post(cmd);
     }
+}
 
-    // Apply changes
-    FastLED.show();
+void LedDriver::setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct, uint32_t transitionMs) {
+    LightCommand cmd = { LIGHT_CMD_SET, { r, g, b, intensityPct }, transitionMs, ++_stamp };
+    postColor(MAX_SEGMENTS, cmd);
+}
+
+bool LedDriver::setSegmentColor(uint8_t segment, uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct,
+                                uint32_t transitionMs) {
+    if (segment >= MAX_SEGMENTS) return false;
+    LightCommand cmd = { LIGHT_CMD_SET, { r, g, b, intensityPct }, transitionMs, ++_stamp };
+    postColor(segment, cmd);
+    return true;
 }
 
 void LedDriver::getColor(uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct) {
-    r = current_r;
-    g = current_g;
-    b = current_b;
-    intensityPct = current_intensity;
+    unpackState(_current.load(std::memory_order_relaxed), r, g, b, intensityPct);
+}
+
+void LedDriver::getSegmentColor(uint8_t segment, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct) {
+    uint32_t packed = segment < MAX_SEGMENTS ? _segmentCurrent[segment].load(std::memory_order_relaxed) : 0;
+    unpackState(packed, r, g, b, intensityPct);
+}
+
+void LedDriver::setLayout(const SegmentLayout& layout) {
+    portENTER_CRITICAL(&_layoutMux);
+    _layout = layout;
+    portEXIT_CRITICAL(&_layoutMux);
+    _layoutMailbox.post(layout);
+}
+
+void LedDriver::getLayout(SegmentLayout& layout) {
+    portENTER_CRITICAL(&_layoutMux);
+    layout = _layout;
+    portEXIT_CRITICAL(&_layoutMux);
+}
+
+void LedDriver::playProgram(const Program& program) {
+    uint32_t stamp = ++_stamp;
+    static ProgramCommand play; // Too large for the async_tcp stack; one caller at a time
+    play.stamp = stamp;
+    play.program = program;
+    _programMailbox.post(play);
+    LightCommand cmd = { LIGHT_CMD_PLAY, { 0, 0, 0, 0 }, 0, stamp };
+    _mailbox.post(cmd);
+}
+
+void LedDriver::stopProgram() {
+    LightCommand cmd = { LIGHT_CMD_STOP, { 0, 0, 0, 0 }, 0, ++_stamp };
+    _mailbox.post(cmd);
+}
+
+void LedDriver::loop() {
+    ProgramRequest request;
+    if (!_chainRequest.take(request)) return;
+
+    static Program program; // Too large for the loop task stack
+    if (!loadProgram(request.name, program)) {
+        // An empty program tells the render task to stop at the end
+        Serial.printf("[led] Chained program '%s' not found or invalid\n", request.name);
+        memset(&program, 0, sizeof(program));
+        strncpy(program.name, request.name, PROGRAM_NAME_LEN - 1);
+    }
+    _chainMailbox.post(program);
+}
+
+void LedDriver::getProgramName(char* name, size_t len) {
+    portENTER_CRITICAL(&_nameMux);
+    strncpy(name, _programName, len);
+    portEXIT_CRITICAL(&_nameMux);
+    if (len > 0) name[len - 1] = '\0';
+}
+
+void LedDriver::renderTask(void* arg) {
+    LedDriver* self = static_cast<LedDriver*>(arg);
+    const TickType_t period = pdMS_TO_TICKS(1000 / LED_FRAME_RATE_HZ) ? pdMS_TO_TICKS(1000 / LED_FRAME_RATE_HZ) : 1;
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        self->renderFrame();
+        vTaskDelayUntil(&lastWake, period);
+    }
+}
+
+void LedDriver::handleCommand(const LightCommand& cmd, uint32_t now) {
+    switch (cmd.kind) {
+        case LIGHT_CMD_SET:
+            _sequencer.stop();
+            // Start from what is on the strip right now, even mid-fade.
+            _transition.start(_shown, cmd.state, cmd.transitionMs, now);
+            break;
+        case LIGHT_CMD_PLAY:
+            if (!startProgram(cmd.stamp, now)) {
+                Serial.println("[led] PLAY without a program");
+                return;
+            }
+            break;
+        case LIGHT_CMD_STOP:
+            // Freeze a running program on the current output
+            if (_sequencer.isRunning()) {
+                _sequencer.stop();
+                _transition.start(_shown, _shown, 0, now);
+            }
+            publishProgramState();
+            return;
+    }
+
+    // SET and PLAY take the whole strip back from segment overrides
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+        if (!_segments[i].follow) {
+            _segments[i].follow = true;
+            _segments[i].dirty = true;
+        }
+    }
+    publishProgramState();
+}
+
+bool LedDriver::startProgram(uint32_t stamp, uint32_t now) {
+    // The program is posted before its command, so the mailbox holds this
+    // one or, if another play raced in, a newer one whose command follows.
+    ProgramCommand play;
+    if (!_programMailbox.take(play)) {
+        return stamp <= _programStamp; // Already started by an earlier command
+    }
+    _programStamp = play.stamp;
+    _sequencer.start(play.program, _shown, _transition, now);
+    requestNextProgram();
+    return true;
+}
+
+void LedDriver::requestNextProgram() {
+    // Fetched while this one plays, so the chain does not wait on LittleFS
+    if (!_sequencer.isRunning() || _sequencer.nextName()[0] == '\0') return;
+    ProgramRequest request = {};
+    strncpy(request.name, _sequencer.nextName(), PROGRAM_NAME_LEN - 1);
+    _chainRequest.post(request);
+}
+
+void LedDriver::chainProgram() {
+    Program program;
+    if (!_chainMailbox.take(program)) return; // Still loading
+    if (strcmp(program.name, _sequencer.nextName()) != 0) return; // Left over from an earlier program
+    if (_sequencer.chain(program, _transition)) {
+        requestNextProgram();
+    }
+}
+
+void LedDriver::publishProgramState() {
+    if (_sequencer.isRunning()) {
+        uint32_t packed = packState(_transition.target());
+        _current.store(packed, std::memory_order_relaxed);
+        for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+            _segmentCurrent[i].store(packed, std::memory_order_relaxed);
+        }
+        _colorChanges.fetch_add(1, std::memory_order_relaxed);
+    }
+    portENTER_CRITICAL(&_nameMux);
+    strncpy(_programName, _sequencer.isRunning() ? _sequencer.programName() : "", PROGRAM_NAME_LEN);
+    portEXIT_CRITICAL(&_nameMux);
+    _programRunning = _sequencer.isRunning();
+}
+
+void LedDriver::applyLayout(const SegmentLayout& layout) {
+    uint16_t oldCount = _pixelCount;
+    _segmentCount = layout.count;
+    _pixelCount = layoutPixelCount(layout);
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+        _segments[i].config = layout.segments[i];
+        compileColorOrder(layout.segments[i].order, _segments[i].perm);
+        _segments[i].shown = _shown;
+        _segments[i].follow = true;
+        _segments[i].dirty = true;
+    }
+    // Pixels between or after segments stay dark
+    memset((void*)leds, 0, sizeof(CRGB) * (oldCount > _pixelCount ? oldCount : _pixelCount));
+    assignOutputs(layout);
+    _layoutChanged = true;
+}
+
+void LedDriver::assignOutputs(const SegmentLayout& layout) {
+    if (!controllers[0]) return; // Not registered yet
+
+    OutputRange ranges[LED_OUTPUT_COUNT];
+    layoutOutputs(layout, ranges);
+    for (uint8_t i = 0; i < LED_OUTPUT_COUNT; i++) {
+        if (ranges[i].count) {
+            controllers[i]->setLeds(leds + ranges[i].offset, ranges[i].count);
+        } else {
+            controllers[i]->setLeds(idlePixel + i, 1);
+        }
+    }
+
+    uint32_t frameUs = parallelFrameUs(layout);
+    uint32_t budgetUs = frameBudgetUs(LED_FRAME_RATE_HZ);
+    Serial.printf("[led] %u px on %d output(s): %u us/frame (single pin: %u us, budget %u us)\n",
+                  (unsigned)_pixelCount, LED_OUTPUT_COUNT, (unsigned)frameUs,
+                  (unsigned)serialFrameUs(layout), (unsigned)budgetUs);
+    if (frameUs > budgetUs) {
+        Serial.println("[led] Warning: layout exceeds the frame budget, frame rate will drop");
+    }
+}
+
+void LedDriver::paintSegment(SegmentRuntime& seg) {
+    // Intensity (0-100) scales the pixel values themselves, so every segment
+    // can have its own brightness with a single global FastLED brightness.
+    uint8_t brightness = map(seg.shown.intensity, INT_MIN_PCT, INT_MAX_PCT, 0, 255);
+    CRGB color(seg.shown.r, seg.shown.g, seg.shown.b);
+    color.nscale8_video(brightness);
+
+    const uint8_t rgb[3] = { color.r, color.g, color.b };
+    fillPixels((uint8_t*)&leds[seg.config.start], seg.config.length,
+               rgb[seg.perm[0]], rgb[seg.perm[1]], rgb[seg.perm[2]]);
+    seg.dirty = false;
+}
+
+void LedDriver::renderFrame() {
+    MetricTimer frameTimer(metrics::ledFrame);
+    _frames++;
+    uint32_t now = millis();
+
+    SegmentLayout layout;
+    if (_layoutMailbox.take(layout)) {
+        applyLayout(layout);
+    }
+
+    // Whole-strip commands and the program drive the master transition
+    LightCommand cmd;
+    uint32_t masterStamp = 0;
+    if (_mailbox.take(cmd)) {
+        masterStamp = cmd.stamp;
+        handleCommand(cmd, now);
+    } else if (_sequencer.isRunning()) {
+        // Publish only on keyframe changes, chaining or when the program ends
+        bool changed = _sequencer.update(_transition, now);
+        if (_sequencer.waitingForNext()) {
+            chainProgram();
+            changed = !_sequencer.waitingForNext();
+        }
+        if (changed || !_sequencer.isRunning()) {
+            publishProgramState();
+        }
+    }
+    if (_transition.isActive()) {
+        _shown = _transition.sample(now);
+    }
+
+    // Segment overrides posted after the last whole-strip command
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+        SegmentRuntime& seg = _segments[i];
+        if (_segmentMailbox[i].take(cmd) && cmd.stamp > masterStamp) {
+            seg.transition.start(seg.shown, cmd.state, cmd.transitionMs, now);
+            seg.follow = false;
+        }
+        if (seg.follow) {
+            if (seg.shown != _shown) {
+                seg.shown = _shown;
+                seg.dirty = true;
+            }
+        } else if (seg.transition.isActive()) {
+            LightState state = seg.transition.sample(now);
+            if (state != seg.shown) {
+                seg.shown = state;
+                seg.dirty = true;
+            }
+        }
+    }
+
+    // Refill only what changed, then send the frame once
+    bool anyDirty = _layoutChanged;
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+        if (_segments[i].dirty) {
+            paintSegment(_segments[i]);
+            anyDirty = true;
+        }
+    }
+    if (!anyDirty) {
+        return; // Nothing changed since the last frame
+    }
+    _layoutChanged = false;
+
+    // Apply changes
+    {
+        MetricTimer showTimer(metrics::ledShow);
+        FastLED.show();
+    }
+    _shows++;
 }
@@ -1,16 +1,144 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../util/mailbox.h"
+#include "light_state.h"
+#include "transition.h"
+#include "sequencer.h"
+#include "segment.h"
+#include "../config.h"
 
+enum LightCommandKind : uint8_t {
+    LIGHT_CMD_SET,
+    LIGHT_CMD_PLAY,
+    LIGHT_CMD_STOP
+};
+
+// Command posted to the render task. Only the latest one per mailbox is
+// acted upon; `stamp` orders whole-strip commands against segment ones.
+struct LightCommand {
+    LightCommandKind kind;
+    LightState state;
+    uint32_t transitionMs;
+    uint32_t stamp;
+};
+
+// Program for LIGHT_CMD_PLAY, posted just before the command with the same
+// stamp. Too large to ride in every LightCommand slot.
+struct ProgramCommand {
+    uint32_t stamp;
+    Program program;
+};
+
+// Chained program the render task asks loop() to load.
+struct ProgramRequest {
+    char name[PROGRAM_NAME_LEN];
+};
+
+// The LED strip is owned by a dedicated render task running at
+// LED_FRAME_RATE_HZ. setColor() only posts the target state to it, so callers
+// (encoder loop, async web handlers) never block on the WS2811 output and a
+// burst of updates within one frame results in a single FastLED.show().
+// With a non-zero transitionMs the render task fades to the target itself,
+// gamma-correct and at the full frame rate. Keyframe programs are played by
+// the same task; setting a color stops them. The render task never touches
+// LittleFS: callers load the program they play, and loop() loads the ones
+// chained with `next` while the previous one is still playing.
+//
+// The strip is split into segments laid out in one contiguous pixel buffer.
+// setColor() drives every segment; setSegmentColor() overrides one of them
+// until the next whole-strip command. Only segments whose state changed are
+// refilled each frame. Segments may be spread over LED_OUTPUT_COUNT data
+// pins, which FastLED sends concurrently.
 class LedDriver {
 public:
-    void initLeds();
-    void setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct);
+    void initLeds(const SegmentLayout& layout);
+    void setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct, uint32_t transitionMs = 0);
     void getColor(uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct);
+    // Whole-strip colors posted since boot; changes whenever getColor() may have.
+    uint32_t colorChangeCount() const { return _colorChanges.load(std::memory_order_relaxed); }
+
+    // Segments
+    void setLayout(const SegmentLayout& layout);
+    void getLayout(SegmentLayout& layout);
+    bool setSegmentColor(uint8_t segment, uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct,
+                         uint32_t transitionMs = 0);
+    void getSegmentColor(uint8_t segment, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct);
+
+    // Keyframe programs
+    void playProgram(const Program& program);
+    void stopProgram();
+    // Loads chained programs for the render task. Call from loop().
+    void loop();
+    bool isProgramRunning() const { return _programRunning; }
+    // Copies the name of the running program; empty when idle.
+    void getProgramName(char* name, size_t len);
+
+    // Render statistics
+    uint32_t frameCount() const { return _frames; }
+    uint32_t showCount() const { return _shows; }
+    uint32_t coalescedCount() const { return _mailbox.superseded(); }
+
+#if LED_MANUAL_RENDER
+    // Renders one frame on the caller's thread (there is no render task)
+    void renderOnce() { renderFrame(); }
+#endif
 
 private:
-    uint8_t current_r = 0;
-    uint8_t current_g = 0;
-    uint8_t current_b = 0;
-    uint8_t current_intensity = 100;
-};
\ No newline at end of file
+    // Render-task view of one segment
+    struct SegmentRuntime {
+        SegmentConfig config;
+        uint8_t perm[3];       // Compiled color order
+        Transition transition; // Used while overriding the whole-strip state
+        LightState shown;
+        bool follow;           // Mirrors the whole-strip state
+        bool dirty;
+    };
+
+    static void renderTask(void* arg);
+    void renderFrame();
+    void handleCommand(const LightCommand& cmd, uint32_t now);
+    void applyLayout(const SegmentLayout& layout);
+    void assignOutputs(const SegmentLayout& layout);
+    void paintSegment(SegmentRuntime& seg);
+    void publishProgramState();
+    bool startProgram(uint32_t stamp, uint32_t now);
+    void chainProgram();
+    void requestNextProgram();
+    void postColor(uint8_t segment, const LightCommand& cmd);
+
+    Mailbox<LightCommand> _mailbox;
+    Mailbox<LightCommand> _segmentMailbox[MAX_SEGMENTS];
+    Mailbox<SegmentLayout> _layoutMailbox;
+    Mailbox<ProgramCommand, 3> _programMailbox;
+    Mailbox<ProgramRequest, 3> _chainRequest;
+    Mailbox<Program, 3> _chainMailbox;
+    std::atomic<uint32_t> _stamp{0};
+    std::atomic<uint32_t> _current{0x64000000}; // last posted state, packed (intensity 100)
+    std::atomic<uint32_t> _colorChanges{0};
+    std::atomic<uint32_t> _segmentCurrent[MAX_SEGMENTS];
+    TaskHandle_t _task = nullptr;
+
+    portMUX_TYPE _layoutMux = portMUX_INITIALIZER_UNLOCKED;
+    SegmentLayout _layout = {};
+
+    // Render task state
+    Transition _transition;
+    Sequencer _sequencer;
+    uint32_t _programStamp = 0; // stamp of the last program started
+    LightState _shown = { 0, 0, 0, 100 };
+    SegmentRuntime _segments[MAX_SEGMENTS];
+    uint8_t _segmentCount = 0;
+    uint16_t _pixelCount = 0;
+    bool _layoutChanged = true;
+
+    volatile bool _programRunning = false;
+    portMUX_TYPE _nameMux = portMUX_INITIALIZER_UNLOCKED;
+    char _programName[PROGRAM_NAME_LEN] = "";
+
+    volatile uint32_t _frames = 0;
+    volatile uint32_t _shows = 0;
+};
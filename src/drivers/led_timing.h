@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include "segment.h"
+
+// Frame time model for WS2811 strips (800 kHz: 24 bits x 1.25 us per pixel,
+// followed by a >= 50 us latch). Pure arithmetic so frame budgets can be
+// checked on the host (see tools/led_budget.cpp) as well as on the device.
+#define WS2811_US_PER_PIXEL 30
+#define WS2811_LATCH_US     50
+
+inline uint32_t outputFrameUs(uint16_t pixels) {
+    return pixels ? (uint32_t)pixels * WS2811_US_PER_PIXEL + WS2811_LATCH_US : 0;
+}
+
+// Every segment chained on a single data pin.
+inline uint32_t serialFrameUs(const SegmentLayout& layout) {
+    return outputFrameUs(layoutPixelCount(layout));
+}
+
+// Outputs sent concurrently: bounded by the longest output.
+inline uint32_t parallelFrameUs(const SegmentLayout& layout) {
+    OutputRange ranges[LED_OUTPUT_COUNT];
+    layoutOutputs(layout, ranges);
+    uint32_t worst = 0;
+    for (uint8_t i = 0; i < LED_OUTPUT_COUNT; i++) {
+        uint32_t us = outputFrameUs(ranges[i].count);
+        if (us > worst) worst = us;
+    }
+    return worst;
+}
+
+inline uint32_t frameBudgetUs(uint16_t frameRateHz) {
+    return frameRateHz ? 1000000UL / frameRateHz : 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+struct LightState {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t intensity;
+};
+
+inline bool operator==(const LightState& a, const LightState& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.intensity == b.intensity;
+}
+
+inline bool operator!=(const LightState& a, const LightState& b) {
+    return !(a == b);
+}
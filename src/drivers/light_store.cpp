@@ -0,0 +1,130 @@
+#include "light_store.h"
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+
+// Pending (not yet committed) record mirrored in RTC memory. It survives
+// software, watchdog and panic resets, so a change that never reached flash
+// can be committed on the next boot.
+struct RtcShadow {
+    uint32_t magic;
+    LightRecord rec;
+    uint8_t check;
+};
+
+#define RTC_SHADOW_MAGIC 0x4C495445 // "LITE"
+
+RTC_NOINIT_ATTR static RtcShadow rtcShadow;
+
+static LightStore* shutdownInstance = nullptr;
+
+static uint8_t recordCheck(const LightRecord& rec) {
+    return (uint8_t)(0xA5 ^ rec.version ^ rec.r ^ (rec.g << 1) ^ (rec.b << 2) ^ (rec.intensity << 3));
+}
+
+static bool sameRecord(const LightRecord& a, const LightRecord& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.intensity == b.intensity;
+}
+
+// Mirrors `rec` in RTC memory while it is pending, clears the mirror otherwise.
+static void setShadow(const LightRecord& rec, bool pending) {
+    if (pending) {
+        rtcShadow.rec = rec;
+        rtcShadow.check = recordCheck(rec);
+        rtcShadow.magic = RTC_SHADOW_MAGIC;
+    } else {
+        rtcShadow.magic = 0;
+    }
+}
+
+LightStore::LightStore(Storage& storage, uint32_t quietMs) :
+    _storage(storage),
+    _quietMs(quietMs) {}
+
+bool LightStore::begin(LightRecord& rec) {
+    _committed = rec;
+    _committed.version = LIGHT_RECORD_VERSION;
+    bool found = _storage.loadLightRecord(_committed);
+
+    // Commit a change that was interrupted by a reset before its quiet period ended.
+    if (rtcShadow.magic == RTC_SHADOW_MAGIC && rtcShadow.check == recordCheck(rtcShadow.rec)
+        && rtcShadow.rec.version == LIGHT_RECORD_VERSION) {
+        if (!found || !sameRecord(rtcShadow.rec, _committed)) {
+            Serial.printf("[store] Recovering pending light state (reset reason %d)\n", (int)esp_reset_reason());
+            _committed = rtcShadow.rec;
+            _storage.saveLightRecord(_committed);
+            _commits++;
+        }
+        found = true;
+    }
+    rtcShadow.magic = 0;
+
+    _live = _committed;
+    _dirty = false;
+
+    if (shutdownInstance == nullptr) {
+        shutdownInstance = this;
+        esp_register_shutdown_handler(&LightStore::shutdownHandler);
+    }
+
+    rec = _committed;
+    return found;
+}
+
+void LightStore::update(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct) {
+    portENTER_CRITICAL(&_mux);
+    _updates++;
+    if (_dirty) _coalesced++;
+    _live.r = r;
+    _live.g = g;
+    _live.b = b;
+    _live.intensity = intensityPct;
+    _dirty = !sameRecord(_live, _committed);
+    _lastChangeMs = millis();
+    setShadow(_live, _dirty);
+    portEXIT_CRITICAL(&_mux);
+}
+
+void LightStore::current(uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct) {
+    portENTER_CRITICAL(&_mux);
+    r = _live.r;
+    g = _live.g;
+    b = _live.b;
+    intensityPct = _live.intensity;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void LightStore::loop() {
+    if (_dirty && (millis() - _lastChangeMs) >= _quietMs) {
+        flush();
+    }
+}
+
+void LightStore::flush() {
+    portENTER_CRITICAL(&_mux);
+    bool dirty = _dirty;
+    LightRecord rec = _live;
+    _dirty = false;
+    portEXIT_CRITICAL(&_mux);
+
+    if (!dirty) return;
+
+    // The NVS write happens outside the critical section. An update() racing
+    // with it compares against the old _committed, so whether the store is
+    // still dirty is only known once `rec` is committed.
+    _storage.saveLightRecord(rec);
+
+    portENTER_CRITICAL(&_mux);
+    _committed = rec;
+    _commits++;
+    _dirty = !sameRecord(_live, _committed);
+    if (_dirty) {
+        _lastChangeMs = millis();
+    }
+    setShadow(_live, _dirty);
+    portEXIT_CRITICAL(&_mux);
+}
+
+void LightStore::shutdownHandler() {
+    if (shutdownInstance) shutdownInstance->flush();
+}
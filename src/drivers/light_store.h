@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include "storage.h"
+#include "../config.h"
+
+// Deferred persistence for the light state.
+//
+// update() only touches RAM; the packed record is committed to NVS by loop()
+// once no further change has arrived for the quiet period, or by flush()
+// (called automatically before a software restart). A copy of the pending
+// record is kept in RTC memory so that a state lost to a brownout/panic
+// reset can still be committed on the next boot.
+class LightStore {
+public:
+    LightStore(Storage& storage, uint32_t quietMs = LIGHT_PERSIST_QUIET_MS);
+
+    // Loads the last committed record (recovering an interrupted one first).
+    // On entry `rec` holds the defaults used when nothing has been stored yet,
+    // in which case it returns false.
+    bool begin(LightRecord& rec);
+
+    void update(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct);
+    void current(uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct);
+
+    void loop();
+    void flush();
+
+    void setQuietPeriod(uint32_t ms) { _quietMs = ms; }
+    uint32_t quietPeriod() const { return _quietMs; }
+
+    // Counters: an update() is coalesced when it overwrites a record that was
+    // still waiting to be committed. Commits include one recovered from RTC
+    // memory at boot.
+    bool isPending() const { return _dirty; }
+    uint32_t updateCount() const { return _updates; }
+    uint32_t coalescedCount() const { return _coalesced; }
+    uint32_t commitCount() const { return _commits; }
+
+private:
+    Storage& _storage;
+    uint32_t _quietMs;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    LightRecord _live = { LIGHT_RECORD_VERSION, 0, 0, 0, 100 };
+    LightRecord _committed = { LIGHT_RECORD_VERSION, 0, 0, 0, 100 };
+    volatile bool _dirty = false;
+    uint32_t _lastChangeMs = 0;
+
+    uint32_t _updates = 0;
+    uint32_t _coalesced = 0;
+    uint32_t _commits = 0;
+
+    static void shutdownHandler();
+};
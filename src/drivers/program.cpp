@@ -0,0 +1,117 @@
+#include "program.h"
+#include <string.h>
+#include <LittleFS.h>
+
+#define PROGRAM_DIR "/programs"
+
+static void programPath(const char* name, char* path, size_t len) {
+    snprintf(path, len, PROGRAM_DIR "/%s.blp", name);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool isValidProgramName(const char* name) {
+    size_t n = strlen(name);
+    if (n == 0 || n >= PROGRAM_NAME_LEN) return false;
+    for (size_t i = 0; i < n; i++) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-')) return false;
+    }
+    return true;
+}
+
+size_t encodeProgram(const Program& program, uint8_t* buf, size_t len) {
+    size_t size = PROGRAM_HEADER_SIZE + (size_t)program.count * PROGRAM_KEYFRAME_SIZE;
+    if (program.count > PROGRAM_MAX_KEYFRAMES || len < size) return 0;
+
+    memset(buf, 0, PROGRAM_HEADER_SIZE);
+    memcpy(buf, PROGRAM_MAGIC, 4);
+    buf[4] = program.count;
+    buf[5] = program.flags;
+    strncpy((char*)buf + 8, program.next, PROGRAM_NAME_LEN - 1);
+
+    uint8_t* p = buf + PROGRAM_HEADER_SIZE;
+    for (uint8_t i = 0; i < program.count; i++, p += PROGRAM_KEYFRAME_SIZE) {
+        const KeyFrame& kf = program.frames[i];
+        p[0] = kf.state.r;
+        p[1] = kf.state.g;
+        p[2] = kf.state.b;
+        p[3] = kf.state.intensity;
+        put32(p + 4, kf.holdMs);
+        put32(p + 8, (kf.fadeMs & PROGRAM_MAX_FADE_MS) | ((uint32_t)kf.easing << 24));
+    }
+    return size;
+}
+
+bool decodeProgram(const uint8_t* buf, size_t len, Program& program) {
+    if (len < PROGRAM_HEADER_SIZE || memcmp(buf, PROGRAM_MAGIC, 4) != 0) return false;
+
+    uint8_t count = buf[4];
+    if (count == 0 || count > PROGRAM_MAX_KEYFRAMES) return false;
+    if (len != PROGRAM_HEADER_SIZE + (size_t)count * PROGRAM_KEYFRAME_SIZE) return false;
+
+    program.count = count;
+    program.flags = buf[5];
+    memcpy(program.next, buf + 8, PROGRAM_NAME_LEN);
+    program.next[PROGRAM_NAME_LEN - 1] = '\0';
+
+    const uint8_t* p = buf + PROGRAM_HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++, p += PROGRAM_KEYFRAME_SIZE) {
+        KeyFrame& kf = program.frames[i];
+        kf.state.r = p[0];
+        kf.state.g = p[1];
+        kf.state.b = p[2];
+        kf.state.intensity = p[3] > 100 ? 100 : p[3];
+        kf.holdMs = get32(p + 4);
+        uint32_t fadeEasing = get32(p + 8);
+        kf.fadeMs = fadeEasing & PROGRAM_MAX_FADE_MS;
+        uint8_t easing = fadeEasing >> 24;
+        kf.easing = easing < EASE_COUNT ? (Easing)easing : EASE_LINEAR;
+    }
+    return true;
+}
+
+bool loadProgram(const char* name, Program& program) {
+    if (!isValidProgramName(name)) return false;
+
+    char path[32];
+    programPath(name, path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+
+    uint8_t buf[PROGRAM_MAX_SIZE];
+    size_t len = f.read(buf, sizeof(buf));
+    f.close();
+
+    if (!decodeProgram(buf, len, program)) return false;
+    strncpy(program.name, name, PROGRAM_NAME_LEN);
+    return true;
+}
+
+bool saveProgram(const Program& program) {
+    if (!isValidProgramName(program.name)) return false;
+
+    uint8_t buf[PROGRAM_MAX_SIZE];
+    size_t len = encodeProgram(program, buf, sizeof(buf));
+    if (len == 0) return false;
+
+    if (!LittleFS.exists(PROGRAM_DIR)) {
+        LittleFS.mkdir(PROGRAM_DIR);
+    }
+    char path[32];
+    programPath(program.name, path, sizeof(path));
+    File f = LittleFS.open(path, "w");
+    if (!f) return false;
+    size_t written = f.write(buf, len);
+    f.close();
+    return written == len;
+}
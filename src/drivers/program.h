@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "light_state.h"
+#include "transition.h"
+
+// Keyframe light programs, stored on LittleFS as /programs/<name>.blp.
+//
+// Binary layout (little-endian):
+//   header, 16 bytes:  "BLP1" | count u8 | flags u8 | reserved u16 | next char[8]
+//   keyframe, 12 bytes: r u8 | g u8 | b u8 | intensity u8 | hold_ms u32 |
+//                       fade_ms u24 | easing u8
+// `next` names the program chained after the last keyframe (empty for none).
+
+#define PROGRAM_MAGIC          "BLP1"
+#define PROGRAM_HEADER_SIZE    16
+#define PROGRAM_KEYFRAME_SIZE  12
+#define PROGRAM_MAX_KEYFRAMES  32
+#define PROGRAM_NAME_LEN       8   // including terminator
+#define PROGRAM_MAX_FADE_MS    0xFFFFFF
+#define PROGRAM_MAX_SIZE       (PROGRAM_HEADER_SIZE + PROGRAM_MAX_KEYFRAMES * PROGRAM_KEYFRAME_SIZE)
+
+#define PROGRAM_FLAG_LOOP      0x01
+
+struct KeyFrame {
+    LightState state;
+    uint32_t holdMs;
+    uint32_t fadeMs;
+    Easing easing;
+};
+
+struct Program {
+    char name[PROGRAM_NAME_LEN];
+    char next[PROGRAM_NAME_LEN];
+    uint8_t flags;
+    uint8_t count;
+    KeyFrame frames[PROGRAM_MAX_KEYFRAMES];
+};
+
+// Program names are 1-7 characters of [a-z0-9_-].
+bool isValidProgramName(const char* name);
+
+// Binary (de)serialization. encodeProgram returns the number of bytes written
+// (0 if the buffer is too small); decodeProgram returns false on malformed data.
+size_t encodeProgram(const Program& program, uint8_t* buf, size_t len);
+bool decodeProgram(const uint8_t* buf, size_t len, Program& program);
+
+// LittleFS storage
+bool loadProgram(const char* name, Program& program);
+bool saveProgram(const Program& program);
@@ -0,0 +1,131 @@
+#include "segment.h"
+#include <string.h>
+
+static const char* const ORDER_NAMES[ORDER_COUNT] = { "RGB", "RBG", "GRB", "GBR", "BRG", "BGR" };
+
+static const uint8_t ORDER_PERMUTATIONS[ORDER_COUNT][3] = {
+    { 0, 1, 2 }, // RGB
+    { 0, 2, 1 }, // RBG
+    { 1, 0, 2 }, // GRB
+    { 1, 2, 0 }, // GBR
+    { 2, 0, 1 }, // BRG
+    { 2, 1, 0 }, // BGR
+};
+
+void defaultLayout(SegmentLayout& layout) {
+    memset(&layout, 0, sizeof(layout));
+    layout.count = 1;
+    layout.segments[0].start = 0;
+    layout.segments[0].length = DEFAULT_NUM_LEDS;
+    layout.segments[0].order = ORDER_RGB;
+}
+
+bool isValidLayout(const SegmentLayout& layout) {
+    if (layout.count == 0 || layout.count > MAX_SEGMENTS) return false;
+    for (uint8_t i = 0; i < layout.count; i++) {
+        const SegmentConfig& a = layout.segments[i];
+        if (a.length == 0 || a.order >= ORDER_COUNT || a.output >= LED_OUTPUT_COUNT) return false;
+        if ((uint32_t)a.start + a.length > MAX_LEDS) return false;
+        for (uint8_t j = 0; j < i; j++) {
+            const SegmentConfig& b = layout.segments[j];
+            if (a.start < b.start + b.length && b.start < a.start + a.length) return false;
+        }
+    }
+
+    OutputRange ranges[LED_OUTPUT_COUNT];
+    layoutOutputs(layout, ranges);
+    for (uint8_t i = 0; i < LED_OUTPUT_COUNT; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            if (ranges[i].count && ranges[j].count
+                && ranges[i].offset < ranges[j].offset + ranges[j].count
+                && ranges[j].offset < ranges[i].offset + ranges[i].count) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void layoutOutputs(const SegmentLayout& layout, OutputRange* ranges) {
+    uint16_t end[LED_OUTPUT_COUNT];
+    for (uint8_t i = 0; i < LED_OUTPUT_COUNT; i++) {
+        ranges[i].offset = MAX_LEDS;
+        end[i] = 0;
+    }
+    for (uint8_t i = 0; i < layout.count; i++) {
+        const SegmentConfig& seg = layout.segments[i];
+        if (seg.output >= LED_OUTPUT_COUNT) continue;
+        if (seg.start < ranges[seg.output].offset) ranges[seg.output].offset = seg.start;
+        if (seg.start + seg.length > end[seg.output]) end[seg.output] = seg.start + seg.length;
+    }
+    for (uint8_t i = 0; i < LED_OUTPUT_COUNT; i++) {
+        if (end[i] == 0) {
+            ranges[i].offset = 0;
+            ranges[i].count = 0;
+        } else {
+            ranges[i].count = end[i] - ranges[i].offset;
+        }
+    }
+}
+
+uint16_t layoutPixelCount(const SegmentLayout& layout) {
+    uint16_t end = 0;
+    for (uint8_t i = 0; i < layout.count; i++) {
+        uint16_t segEnd = layout.segments[i].start + layout.segments[i].length;
+        if (segEnd > end) end = segEnd;
+    }
+    return end;
+}
+
+const char* colorOrderName(uint8_t order) {
+    return order < ORDER_COUNT ? ORDER_NAMES[order] : "";
+}
+
+bool parseColorOrder(const char* name, uint8_t& order) {
+    for (uint8_t i = 0; i < ORDER_COUNT; i++) {
+        if (strcasecmp(name, ORDER_NAMES[i]) == 0) {
+            order = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void compileColorOrder(uint8_t order, uint8_t perm[3]) {
+    const uint8_t* src = ORDER_PERMUTATIONS[order < ORDER_COUNT ? order : (uint8_t)ORDER_RGB];
+    perm[0] = src[0];
+    perm[1] = src[1];
+    perm[2] = src[2];
+}
+
+void fillPixels(uint8_t* dst, uint16_t count, uint8_t c0, uint8_t c1, uint8_t c2) {
+    // Byte-wise until the destination is word aligned (at most 3 pixels).
+    while (count > 0 && ((uintptr_t)dst & 3) != 0) {
+        dst[0] = c0;
+        dst[1] = c1;
+        dst[2] = c2;
+        dst += 3;
+        count--;
+    }
+
+    // Four pixels are exactly three little-endian words.
+    const uint32_t w0 = c0 | (c1 << 8) | (c2 << 16) | ((uint32_t)c0 << 24);
+    const uint32_t w1 = c1 | (c2 << 8) | (c0 << 16) | ((uint32_t)c1 << 24);
+    const uint32_t w2 = c2 | (c0 << 8) | (c1 << 16) | ((uint32_t)c2 << 24);
+    while (count >= 4) {
+        uint8_t* p = (uint8_t*)__builtin_assume_aligned(dst, 4);
+        memcpy(p, &w0, 4);
+        memcpy(p + 4, &w1, 4);
+        memcpy(p + 8, &w2, 4);
+        dst += 12;
+        count -= 4;
+    }
+
+    while (count > 0) {
+        dst[0] = c0;
+        dst[1] = c1;
+        dst[2] = c2;
+        dst += 3;
+        count--;
+    }
+}
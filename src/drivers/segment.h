@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../config.h"
+
+// Channel order of a strip section, as wired.
+enum ColorOrder : uint8_t {
+    ORDER_RGB = 0,
+    ORDER_RBG,
+    ORDER_GRB,
+    ORDER_GBR,
+    ORDER_BRG,
+    ORDER_BGR,
+    ORDER_COUNT
+};
+
+// A contiguous run of pixels in the shared pixel buffer (e.g. one shelf),
+// wired to data output `output`.
+struct SegmentConfig {
+    uint16_t start;
+    uint16_t length;
+    uint8_t order;
+    uint8_t output;
+};
+
+struct SegmentLayout {
+    uint8_t count;
+    SegmentConfig segments[MAX_SEGMENTS];
+};
+
+// Slice of the pixel buffer sent on one data output. The first pixel of the
+// strip on that pin is buffer index `offset`.
+struct OutputRange {
+    uint16_t offset;
+    uint16_t count;
+};
+
+void defaultLayout(SegmentLayout& layout);
+
+// Segments must be non-empty, fit in MAX_LEDS and not overlap. Segments on
+// different outputs must not interleave in the buffer.
+bool isValidLayout(const SegmentLayout& layout);
+
+// Buffer slice of each of the LED_OUTPUT_COUNT outputs (count 0 if unused).
+void layoutOutputs(const SegmentLayout& layout, OutputRange* ranges);
+
+// Number of pixels that have to be sent to cover every segment.
+uint16_t layoutPixelCount(const SegmentLayout& layout);
+
+const char* colorOrderName(uint8_t order);
+bool parseColorOrder(const char* name, uint8_t& order);
+
+// Compiles a color order into the source channel (0=R, 1=G, 2=B) of each
+// transmitted byte, so the render loop can remap with plain indexing.
+void compileColorOrder(uint8_t order, uint8_t perm[3]);
+
+// Fills `count` 3-byte pixels with the same color using aligned 32-bit
+// stores (three words per four pixels) instead of byte-wise writes.
+void fillPixels(uint8_t* dst, uint16_t count, uint8_t c0, uint8_t c1, uint8_t c2);
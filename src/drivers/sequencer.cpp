@@ -0,0 +1,59 @@
+#include "sequencer.h"
+
+void Sequencer::start(const Program& program, const LightState& shown, Transition& transition, uint32_t nowMs) {
+    _program = program;
+    _index = 0;
+    _waiting = false;
+    _running = _program.count > 0;
+    if (_running) {
+        beginKeyframe(shown, transition, nowMs);
+    }
+}
+
+bool Sequencer::update(Transition& transition, uint32_t nowMs) {
+    if (!_running || _waiting || (nowMs - _phaseStartMs) < _phaseMs) {
+        return false;
+    }
+
+    // Keep the schedule anchored to the previous phase so long programs do not drift.
+    uint32_t phaseEnd = _phaseStartMs + _phaseMs;
+
+    if (_index + 1 < _program.count) {
+        _index++;
+    } else if (_program.flags & PROGRAM_FLAG_LOOP) {
+        _index = 0;
+    } else if (_program.next[0] != '\0') {
+        // Hold the last keyframe until chain(); the next one starts at phaseEnd
+        _phaseStartMs = phaseEnd;
+        _phaseMs = 0;
+        _waiting = true;
+        return false;
+    } else {
+        _running = false; // Hold the last keyframe
+        return false;
+    }
+
+    // The phase covers the whole fade, so the previous target has been reached.
+    beginKeyframe(transition.target(), transition, phaseEnd);
+    return true;
+}
+
+bool Sequencer::chain(const Program& program, Transition& transition) {
+    if (!_waiting) return false;
+    _waiting = false;
+    if (program.count == 0) {
+        _running = false;
+        return false;
+    }
+    _program = program;
+    _index = 0;
+    beginKeyframe(transition.target(), transition, _phaseStartMs);
+    return true;
+}
+
+void Sequencer::beginKeyframe(LightState from, Transition& transition, uint32_t nowMs) {
+    const KeyFrame& kf = _program.frames[_index];
+    transition.start(from, kf.state, kf.fadeMs, nowMs, kf.easing);
+    _phaseStartMs = nowMs;
+    _phaseMs = (kf.holdMs > UINT32_MAX - kf.fadeMs) ? UINT32_MAX : kf.fadeMs + kf.holdMs;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include "program.h"
+#include "transition.h"
+
+// Plays a keyframe Program on the render task: each keyframe fades in from
+// whatever is currently shown and then holds. At the end the program loops,
+// chains to `next` or stops on its last keyframe. The sequencer never loads
+// anything itself: the chained program is handed in through chain() by the
+// owner, which fetches it off the render task.
+class Sequencer {
+public:
+    void start(const Program& program, const LightState& shown, Transition& transition, uint32_t nowMs);
+    void stop() { _running = false; _waiting = false; }
+
+    // Advances playback; returns true when a new keyframe fade was started.
+    // At the end of a program with `next` it holds the last keyframe and
+    // waits for chain().
+    bool update(Transition& transition, uint32_t nowMs);
+
+    // Continues with the program named by nextName(), on the schedule of the
+    // one that just ended. A program without keyframes (the chained one could
+    // not be loaded) stops playback. Returns true when playback continues.
+    bool chain(const Program& program, Transition& transition);
+
+    bool isRunning() const { return _running; }
+    bool waitingForNext() const { return _waiting; }
+    const char* programName() const { return _program.name; }
+    // Program chained after this one; empty if none.
+    const char* nextName() const { return _program.next; }
+    uint8_t keyframeIndex() const { return _index; }
+
+private:
+    void beginKeyframe(LightState from, Transition& transition, uint32_t nowMs);
+
+    Program _program = {};
+    uint8_t _index = 0;
+    uint32_t _phaseStartMs = 0;
+    uint32_t _phaseMs = 0;
+    bool _running = false;
+    bool _waiting = false;
+};
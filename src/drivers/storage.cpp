@@ -1,6 +1,7 @@
 #include "storage.h"
 #include <Preferences.h>
 #include "../config.h"
+#include "../util/metrics.h"
 
 Preferences preferences;
 
@@ -9,6 +10,7 @@ void Storage::begin() {
 }
 
 bool Storage::loadLightConfig(uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct) {
+    metrics::nvsReads.inc();
     preferences.begin(NVS_NAMESPACE, true); // Read-only
     bool success = preferences.isKey(NVS_KEY_R);
     if (success) {
@@ -22,6 +24,7 @@ bool Storage::loadLightConfig(uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& inten
 }
 
 void Storage::saveLightConfig(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct) {
+    MetricTimer timer(metrics::nvsWrite);
     preferences.begin(NVS_NAMESPACE, false); // Read-write
     preferences.putUChar(NVS_KEY_R, r);
     preferences.putUChar(NVS_KEY_G, g);
@@ -30,7 +33,83 @@ void Storage::saveLightConfig(uint8_t r, uint8_t g, uint8_t b, uint8_t intensity
     preferences.end();
 }
 
+bool Storage::loadLightRecord(LightRecord& rec) {
+    metrics::nvsReads.inc();
+    preferences.begin(NVS_NAMESPACE, true); // Read-only
+    LightRecord tmp;
+    size_t len = preferences.getBytes(NVS_KEY_LIGHT_REC, &tmp, sizeof(tmp));
+    preferences.end();
+    if (len != sizeof(tmp) || tmp.version != LIGHT_RECORD_VERSION) {
+        return false;
+    }
+    rec = tmp;
+    return true;
+}
+
+void Storage::saveLightRecord(const LightRecord& rec) {
+    MetricTimer timer(metrics::nvsWrite);
+    preferences.begin(NVS_NAMESPACE, false); // Read-write
+    preferences.putBytes(NVS_KEY_LIGHT_REC, &rec, sizeof(rec));
+    preferences.end();
+}
+
+// Segment blob: version, count, then start u16 | length u16 | order u8 |
+// output u8 per segment (version 1 had no output byte).
+#define SEGMENTS_BLOB_VERSION 2
+#define SEGMENT_BLOB_ENTRY    6
+
+bool Storage::loadSegments(SegmentLayout& layout) {
+    metrics::nvsReads.inc();
+    uint8_t buf[2 + MAX_SEGMENTS * SEGMENT_BLOB_ENTRY];
+    preferences.begin(NVS_NAMESPACE, true); // Read-only
+    size_t len = preferences.getBytes(NVS_KEY_SEGMENTS, buf, sizeof(buf));
+    preferences.end();
+
+    if (len < 2 || (buf[0] != 1 && buf[0] != SEGMENTS_BLOB_VERSION)) {
+        return false;
+    }
+    size_t entry = (buf[0] == 1) ? SEGMENT_BLOB_ENTRY - 1 : SEGMENT_BLOB_ENTRY;
+    if (buf[1] > MAX_SEGMENTS || len != 2 + buf[1] * entry) {
+        return false;
+    }
+    SegmentLayout tmp = {};
+    tmp.count = buf[1];
+    const uint8_t* p = buf + 2;
+    for (uint8_t i = 0; i < tmp.count; i++, p += entry) {
+        tmp.segments[i].start = p[0] | (p[1] << 8);
+        tmp.segments[i].length = p[2] | (p[3] << 8);
+        tmp.segments[i].order = p[4];
+        tmp.segments[i].output = (entry == SEGMENT_BLOB_ENTRY) ? p[5] : 0;
+    }
+    if (!isValidLayout(tmp)) {
+        return false;
+    }
+    layout = tmp;
+    return true;
+}
+
+void Storage::saveSegments(const SegmentLayout& layout) {
+    MetricTimer timer(metrics::nvsWrite);
+    uint8_t buf[2 + MAX_SEGMENTS * SEGMENT_BLOB_ENTRY];
+    buf[0] = SEGMENTS_BLOB_VERSION;
+    buf[1] = layout.count;
+    uint8_t* p = buf + 2;
+    for (uint8_t i = 0; i < layout.count; i++, p += SEGMENT_BLOB_ENTRY) {
+        const SegmentConfig& seg = layout.segments[i];
+        p[0] = seg.start & 0xFF;
+        p[1] = seg.start >> 8;
+        p[2] = seg.length & 0xFF;
+        p[3] = seg.length >> 8;
+        p[4] = seg.order;
+        p[5] = seg.output;
+    }
+    preferences.begin(NVS_NAMESPACE, false); // Read-write
+    preferences.putBytes(NVS_KEY_SEGMENTS, buf, 2 + layout.count * SEGMENT_BLOB_ENTRY);
+    preferences.end();
+}
+
 bool Storage::loadWifiCredentials(String& ssid, String& pass) {
+    metrics::nvsReads.inc();
     preferences.begin(NVS_WIFI_NAMESPACE, true); // Read-only
     bool success = preferences.isKey(NVS_KEY_WIFI_SSID);
     if (success) {
@@ -42,6 +121,7 @@ bool Storage::loadWifiCredentials(String& ssid, String& pass) {
 }
 
 void Storage::saveWifiCredentials(const String& ssid, const String& pass) {
+    MetricTimer timer(metrics::nvsWrite);
     preferences.begin(NVS_WIFI_NAMESPACE, false); // Read-write
     preferences.putString(NVS_KEY_WIFI_SSID, ssid);
     preferences.putString(NVS_KEY_WIFI_PASS, pass);
@@ -49,6 +129,7 @@ void Storage::saveWifiCredentials(const String& ssid, const String& pass) {
 }
 
 void Storage::resetWifiCredentials() {
+    MetricTimer timer(metrics::nvsWrite);
     preferences.begin(NVS_WIFI_NAMESPACE, false);
     preferences.remove(NVS_KEY_WIFI_SSID);
     preferences.remove(NVS_KEY_WIFI_PASS);
@@ -56,6 +137,7 @@ void Storage::resetWifiCredentials() {
 }
 
 bool Storage::loadApCredentials(String& ssid, String& pass) {
+    metrics::nvsReads.inc();
     preferences.begin(NVS_WIFI_NAMESPACE, true);
     bool success = preferences.isKey(NVS_KEY_AP_SSID);
     if (success) {
@@ -67,6 +149,7 @@ bool Storage::loadApCredentials(String& ssid, String& pass) {
 }
 
 void Storage::saveApCredentials(const String& ssid, const String& pass) {
+    MetricTimer timer(metrics::nvsWrite);
     preferences.begin(NVS_WIFI_NAMESPACE, false);
     preferences.putString(NVS_KEY_AP_SSID, ssid);
     preferences.putString(NVS_KEY_AP_PASS, pass);
@@ -74,6 +157,7 @@ void Storage::saveApCredentials(const String& ssid, const String& pass) {
 }
 
 uint8_t Storage::getWifiMode() {
+    metrics::nvsReads.inc();
     preferences.begin(NVS_WIFI_NAMESPACE, true);
     uint8_t mode = preferences.getUChar(NVS_KEY_WIFI_MODE, 1); // Default to STA
     preferences.end();
@@ -81,12 +165,14 @@ uint8_t Storage::getWifiMode() {
 }
 
 void Storage::setWifiMode(uint8_t mode) {
+    MetricTimer timer(metrics::nvsWrite);
     preferences.begin(NVS_WIFI_NAMESPACE, false);
     preferences.putUChar(NVS_KEY_WIFI_MODE, mode);
     preferences.end();
 }
 
 uint8_t Storage::loadLanguage() {
+    metrics::nvsReads.inc();
     preferences.begin(NVS_NAMESPACE, true);
     // 0: Spanish, 1: English. Default to 0 (Spanish).
     uint8_t lang = preferences.getUChar(NVS_KEY_LANG, 0);
@@ -95,6 +181,7 @@ uint8_t Storage::loadLanguage() {
 }
 
 void Storage::saveLanguage(uint8_t lang) {
+    MetricTimer timer(metrics::nvsWrite);
     preferences.begin(NVS_NAMESPACE, false);
     preferences.putUChar(NVS_KEY_LANG, lang);
     preferences.end();
@@ -2,6 +2,18 @@
 
 #include <stdint.h>
 #include <WString.h>
+#include "segment.h"
+
+// Packed light state as stored in NVS (one blob, one flash write).
+struct LightRecord {
+    uint8_t version;
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t intensity;
+};
+
+#define LIGHT_RECORD_VERSION 1
 
 class Storage {
 public:
@@ -10,6 +22,12 @@ public:
     // Light configuration
     bool loadLightConfig(uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& intensityPct);
     void saveLightConfig(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct);
+    bool loadLightRecord(LightRecord& rec);
+    void saveLightRecord(const LightRecord& rec);
+
+    // LED segment layout
+    bool loadSegments(SegmentLayout& layout);
+    void saveSegments(const SegmentLayout& layout);
 
     // WiFi credentials
     bool loadWifiCredentials(String& ssid, String& pass);
@@ -0,0 +1,118 @@
+#include "transition.h"
+
+// Gamma 2.2 curve: 8-bit channel value -> linear light (0..65535).
+// Generated with round((i / 255.0) ** 2.2 * 65535).
+static const uint16_t GAMMA_TO_LINEAR[256] = {
+        0,     0,     2,     4,     7,    11,    17,    24,
+       32,    42,    53,    65,    79,    94,   111,   129,
+      148,   169,   192,   216,   242,   270,   299,   330,
+      362,   396,   432,   469,   508,   549,   591,   635,
+      681,   729,   779,   830,   883,   938,   995,  1053,
+     1113,  1175,  1239,  1305,  1373,  1443,  1514,  1587,
+     1663,  1740,  1819,  1900,  1983,  2068,  2155,  2243,
+     2334,  2427,  2521,  2618,  2717,  2817,  2920,  3024,
+     3131,  3240,  3350,  3463,  3578,  3694,  3813,  3934,
+     4057,  4182,  4309,  4438,  4570,  4703,  4838,  4976,
+     5115,  5257,  5401,  5547,  5695,  5845,  5998,  6152,
+     6309,  6468,  6629,  6792,  6957,  7124,  7294,  7466,
+     7640,  7816,  7994,  8175,  8358,  8543,  8730,  8919,
+     9111,  9305,  9501,  9699,  9900, 10102, 10307, 10515,
+    10724, 10936, 11150, 11366, 11585, 11806, 12029, 12254,
+    12482, 12712, 12944, 13179, 13416, 13655, 13896, 14140,
+    14386, 14635, 14885, 15138, 15394, 15652, 15912, 16174,
+    16439, 16706, 16975, 17247, 17521, 17798, 18077, 18358,
+    18642, 18928, 19216, 19507, 19800, 20095, 20393, 20694,
+    20996, 21301, 21609, 21919, 22231, 22546, 22863, 23182,
+    23504, 23829, 24156, 24485, 24817, 25151, 25487, 25826,
+    26168, 26512, 26858, 27207, 27558, 27912, 28268, 28627,
+    28988, 29351, 29717, 30086, 30457, 30830, 31206, 31585,
+    31966, 32349, 32735, 33124, 33514, 33908, 34304, 34702,
+    35103, 35507, 35913, 36321, 36732, 37146, 37562, 37981,
+    38402, 38825, 39252, 39680, 40112, 40546, 40982, 41421,
+    41862, 42306, 42753, 43202, 43654, 44108, 44565, 45025,
+    45487, 45951, 46418, 46888, 47360, 47835, 48313, 48793,
+    49275, 49761, 50249, 50739, 51232, 51728, 52226, 52727,
+    53230, 53736, 54245, 54756, 55270, 55787, 56306, 56828,
+    57352, 57879, 58409, 58941, 59476, 60014, 60554, 61097,
+    61642, 62190, 62741, 63295, 63851, 64410, 64971, 65535,
+};
+
+uint16_t gammaToLinear(uint8_t v) {
+    return GAMMA_TO_LINEAR[v];
+}
+
+uint8_t linearToGamma(uint16_t lin) {
+    // Binary search for the closest table entry (8 steps).
+    uint8_t lo = 0;
+    uint8_t hi = 255;
+    while (lo < hi) {
+        uint8_t mid = lo + ((hi - lo) >> 1);
+        if (GAMMA_TO_LINEAR[mid] < lin) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo > 0 && (lin - GAMMA_TO_LINEAR[lo - 1]) < (GAMMA_TO_LINEAR[lo] - lin)) {
+        lo--;
+    }
+    return lo;
+}
+
+static uint16_t lerp16(uint16_t a, uint16_t b, uint32_t tQ16) {
+    return (uint16_t)(a + (((int64_t)b - a) * tQ16 >> 16));
+}
+
+// Applies an easing curve to a Q16 progress value (0..65536).
+static uint32_t ease(uint32_t t, Easing easing) {
+    uint32_t inv;
+    switch (easing) {
+        case EASE_IN:
+            return (t * t) >> 16;
+        case EASE_OUT:
+            inv = 65536 - t;
+            return 65536 - (uint32_t)(((uint64_t)inv * inv) >> 16);
+        case EASE_IN_OUT:
+            // 3t^2 - 2t^3
+            return (uint32_t)(((uint64_t)t * t * (3 * 65536 - 2 * t)) >> 32);
+        default:
+            return t;
+    }
+}
+
+void Transition::start(const LightState& from, const LightState& to, uint32_t durationMs, uint32_t nowMs,
+                       Easing easing) {
+    _from = from;
+    _to = to;
+    _startMs = nowMs;
+    _durationMs = durationMs;
+    _easing = easing;
+    _active = true;
+
+    // Use the copies: callers may pass references into this object.
+    _fromLin[0] = gammaToLinear(_from.r);
+    _fromLin[1] = gammaToLinear(_from.g);
+    _fromLin[2] = gammaToLinear(_from.b);
+    _toLin[0] = gammaToLinear(_to.r);
+    _toLin[1] = gammaToLinear(_to.g);
+    _toLin[2] = gammaToLinear(_to.b);
+}
+
+LightState Transition::sample(uint32_t nowMs) {
+    uint32_t elapsed = nowMs - _startMs;
+    if (!_active || elapsed >= _durationMs) {
+        _active = false;
+        return _to;
+    }
+
+    uint32_t tQ16 = ease((uint32_t)(((uint64_t)elapsed << 16) / _durationMs), _easing);
+
+    // Channels are blended in linear light so fades do not dip or flash;
+    // intensity already scales linearly and is blended directly.
+    LightState out;
+    out.r = linearToGamma(lerp16(_fromLin[0], _toLin[0], tQ16));
+    out.g = linearToGamma(lerp16(_fromLin[1], _toLin[1], tQ16));
+    out.b = linearToGamma(lerp16(_fromLin[2], _toLin[2], tQ16));
+    out.intensity = (uint8_t)lerp16(_from.intensity, _to.intensity, tQ16);
+    return out;
+}
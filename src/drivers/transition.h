@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include "light_state.h"
+
+// Gamma-corrected 8-bit <-> 16-bit linear light conversion.
+uint16_t gammaToLinear(uint8_t v);
+uint8_t linearToGamma(uint16_t lin);
+
+enum Easing : uint8_t {
+    EASE_LINEAR = 0,
+    EASE_IN,      // quadratic, slow start
+    EASE_OUT,     // quadratic, slow end
+    EASE_IN_OUT,  // smoothstep
+    EASE_COUNT
+};
+
+// Fixed-point fade between two light states, sampled once per render frame.
+class Transition {
+public:
+    void start(const LightState& from, const LightState& to, uint32_t durationMs, uint32_t nowMs,
+               Easing easing = EASE_LINEAR);
+    LightState sample(uint32_t nowMs);
+    bool isActive() const { return _active; }
+    const LightState& target() const { return _to; }
+
+private:
+    LightState _from = { 0, 0, 0, 100 };
+    LightState _to = { 0, 0, 0, 100 };
+    uint16_t _fromLin[3] = { 0, 0, 0 };
+    uint16_t _toLin[3] = { 0, 0, 0 };
+    uint32_t _startMs = 0;
+    uint32_t _durationMs = 0;
+    Easing _easing = EASE_LINEAR;
+    bool _active = false;
+};
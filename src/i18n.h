@@ -0,0 +1,11 @@
+#pragma once
+
+#include "i18n_strings.h" // Generated from data/ui_web/*.json by tools/gen_i18n.py
+
+extern Lang currentLang;
+
+// Text for `key` in the current language. Strings live in flash; the
+// lookup is one array index.
+inline const char* tr(TrKey key) {
+    return TR_TABLES[currentLang][key];
+}
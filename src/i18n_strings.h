@@ -0,0 +1,118 @@
+// Generated by tools/gen_i18n.py from data/ui_web/{es,en}.json. Do not edit.
+#pragma once
+
+#include <stdint.h>
+
+enum Lang : uint8_t { ES, EN };
+#define LANG_COUNT 2
+
+enum TrKey : uint16_t {
+    TR_ERROR_AUTH_FAILED,
+    TR_ERROR_INTERNAL_ERROR,
+    TR_ERROR_INVALID_INPUT,
+    TR_ERROR_SSID_NOT_FOUND,
+    TR_ERROR_TIMEOUT,
+    TR_HOME_AP_MODE,
+    TR_HOME_BLUE,
+    TR_HOME_CHANGE_WIFI,
+    TR_HOME_GREEN,
+    TR_HOME_LIGHT,
+    TR_HOME_NO_WIFI,
+    TR_HOME_RED,
+    TR_HOME_WIFI_OFF,
+    TR_LANG_EN,
+    TR_LANG_ES,
+    TR_MENU_BACK,
+    TR_MENU_BLUE,
+    TR_MENU_GREEN,
+    TR_MENU_INTENSITY,
+    TR_MENU_LANG,
+    TR_MENU_RED,
+    TR_MENU_WIFI_CHANGE,
+    TR_MENU_WIFI_TOGGLE,
+    TR_WIFI_CONNECT,
+    TR_WIFI_CONNECTED,
+    TR_WIFI_CONNECTING,
+    TR_WIFI_ERROR,
+    TR_WIFI_HIDDEN_NETWORK,
+    TR_WIFI_NETWORK,
+    TR_WIFI_PASSWORD,
+    TR_WIFI_REFRESH,
+    TR_WIFI_SSID,
+    TR_WIFI_TITLE,
+    TR_KEY_COUNT
+};
+
+static constexpr const char* TR_ES[TR_KEY_COUNT] = {
+    "Contrase\303\261a incorrecta.",
+    "Error interno.",
+    "Datos inv\303\241lidos.",
+    "La red no fue encontrada.",
+    "La conexi\303\263n tard\303\263 demasiado.",
+    "MODO AP",
+    "A",
+    "Cambiar WiFi",
+    "V",
+    "I",
+    "SIN WIFI",
+    "R",
+    "WIFI APAGADO",
+    "English",
+    "Espanol",
+    "Volver",
+    "Color Azul",
+    "Color Verde",
+    "Intensidad",
+    "Idioma",
+    "Color Rojo",
+    "Cambiar Red",
+    "WiFi Con/Des",
+    "Conectar",
+    "\302\241Conectado! IP:",
+    "Conectando...",
+    "Error:",
+    "Red Oculta",
+    "Red",
+    "Contrase\303\261a",
+    "Actualizar",
+    "Nombre de Red (SSID)",
+    "Configurar WiFi",
+};
+
+static constexpr const char* TR_EN[TR_KEY_COUNT] = {
+    "Authentication failed.",
+    "Internal error.",
+    "Invalid input.",
+    "Network not found.",
+    "Connection timed out.",
+    "AP MODE",
+    "B",
+    "Change WiFi",
+    "G",
+    "I",
+    "NO WIFI",
+    "R",
+    "WIFI OFF",
+    "English",
+    "Espanol",
+    "Back",
+    "Blue Color",
+    "Green Color",
+    "Intensity",
+    "Language",
+    "Red Color",
+    "Change WiFi",
+    "WiFi On/Off",
+    "Connect",
+    "Connected! IP:",
+    "Connecting...",
+    "Error:",
+    "Hidden Network",
+    "Network",
+    "Password",
+    "Refresh",
+    "Network Name (SSID)",
+    "WiFi Setup",
+};
+
+static constexpr const char* const* TR_TABLES[LANG_COUNT] = { TR_ES, TR_EN };
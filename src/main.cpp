@@ -1,16 +1,17 @@
 #include <Arduino.h>
 #include <Preferences.h>
-#include <LiquidCrystal_I2C.h>
-#include <RotaryEncoder.h>
 #include "config.h"
+#include "i18n.h"
 #include "drivers/storage.h"
 #include "drivers/led_driver.h"
+#include "drivers/encoder_input.h"
+#include "drivers/lcd_display.h"
+#include "drivers/light_store.h"
 #include "web/wifi_manager.h"
+#include "web/wifi_scan.h"
 #include "web/rest.h"
 #include "web/web_server.h"
-
-// LCD I2C address
-#define LCD_ADDR 0x27
+#include "util/metrics.h"
 
 // ===========================================================================
 // UI State & Menu Definitions
@@ -26,6 +27,7 @@ HomeCarouselSlot homeSlot = HOME_SLOT_RG;
 HomeApInfoSlot homeApInfoSlot = AP_INFO_MODE;
 unsigned long lastHomeCarouselSwitch = 0;
 unsigned long lastHomeApInfoSwitch = 0;
+uint32_t homeColorChanges = 0; // LedDriver color count the home screen shows
 const int CAROUSEL_INTERVAL_MS = 2000;
 bool editMode = false;
 
@@ -37,71 +39,20 @@ int wifiChangeSelection = 0; // 0: STA, 1: AP
 // ===========================================================================
 // i18n (Internationalization)
 // ===========================================================================
-enum Lang { ES, EN };
 Lang currentLang = ES;
 
-const char* TR_ES[][2] = {
-  {"title", "BioLighting v2"},
-  {"M_RED", "Color Rojo"},
-  {"M_GREEN", "Color Verde"},
-  {"M_BLUE", "Color Azul"},
-  {"M_INTENSITY", "Intensidad"},
-  {"M_LANG", "Idioma"},
-  {"M_WIFI_TOGGLE", "WiFi Con/Des"},
-  {"M_WIFI_CHANGE", "Cambiar Red"},
-  {"M_BACK", "Volver"},
-  {"home.red", "R"},
-  {"home.green", "V"},
-  {"home.blue", "A"},
-  {"home.light", "I"},
-  {"home.no_wifi", "SIN WIFI"},
-  {"home.ap_mode", "MODO AP"},
-  {"home.wifi_off", "WIFI APAGADO"},
-};
-
-const char* TR_EN[][2] = {
-  {"title", "BioLighting v2"},
-  {"M_RED", "Red Color"},
-  {"M_GREEN", "Green Color"},
-  {"M_BLUE", "Blue Color"},
-  {"M_INTENSITY", "Intensity"},
-  {"M_LANG", "Language"},
-  {"M_WIFI_TOGGLE", "WiFi On/Off"},
-  {"M_WIFI_CHANGE", "Change WiFi"},
-  {"M_BACK", "Back"},
-  {"home.red", "R"},
-  {"home.green", "G"},
-  {"home.blue", "B"},
-  {"home.light", "I"},
-  {"home.no_wifi", "NO WIFI"},
-  {"home.ap_mode", "AP MODE"},
-  {"home.wifi_off", "WIFI OFF"},
-};
-
-String tr(const char* key) {
-    if (currentLang == EN) {
-        for (int i = 0; i < sizeof(TR_EN) / sizeof(TR_EN[0]); i++) {
-            if (strcmp(TR_EN[i][0], key) == 0) return TR_EN[i][1];
-        }
-    }
-    for (int i = 0; i < sizeof(TR_ES) / sizeof(TR_ES[0]); i++) {
-        if (strcmp(TR_ES[i][0], key) == 0) return TR_ES[i][1];
-    }
-    return "";
-}
-
-const char* menuItemKey(MenuItem item) {
+TrKey menuItemKey(MenuItem item) {
     switch (item) {
-        case M_RED: return "M_RED";
-        case M_GREEN: return "M_GREEN";
-        case M_BLUE: return "M_BLUE";
-        case M_INTENSITY: return "M_INTENSITY";
-        case M_LANG: return "M_LANG";
-        case M_WIFI_TOGGLE: return "M_WIFI_TOGGLE";
-        case M_WIFI_CHANGE: return "M_WIFI_CHANGE";
-        case M_BACK: return "M_BACK";
+        case M_RED: return TR_MENU_RED;
+        case M_GREEN: return TR_MENU_GREEN;
+        case M_BLUE: return TR_MENU_BLUE;
+        case M_INTENSITY: return TR_MENU_INTENSITY;
+        case M_LANG: return TR_MENU_LANG;
+        case M_WIFI_TOGGLE: return TR_MENU_WIFI_TOGGLE;
+        case M_WIFI_CHANGE: return TR_MENU_WIFI_CHANGE;
+        case M_BACK: return TR_MENU_BACK;
     }
-    return "";
+    return TR_MENU_BACK;
 }
 
 // ===========================================================================
@@ -109,40 +60,26 @@ const char* menuItemKey(MenuItem item) {
 // ===========================================================================
 Storage     storage;
 LedDriver   ledDriver;
+LightStore  lightStore(storage);
 WiFiManager wifiManager(storage);
-RestApi     restApi(storage);
+WifiScanService wifiScan;
+RestApi     restApi(storage, lightStore, wifiScan);
 WebServer   webServer(restApi);
 Preferences prefs;
-LiquidCrystal_I2C lcd(LCD_ADDR, 16, 2);
-RotaryEncoder encoder(ENCODER_DT_PIN, ENCODER_CLK_PIN, RotaryEncoder::LatchMode::FOUR3);
+LcdDisplay  lcd(LCD_ADDR);
+EncoderInput encoderInput;
 
 uint8_t r_val, g_val, b_val, intensity_val;
 
-// ===========================================================================
-// LCD Helpers
-// ===========================================================================
-void lcdClearRow(uint8_t row) { lcd.setCursor(0, row); lcd.print("                "); }
-
-void lcdPrint16(uint8_t row, const String& s) {
-  String t = s;
-  if (t.length() > 16) t = t.substring(0, 16);
-  lcd.setCursor(0, row);
-  lcd.print(t);
-  for (int i = t.length(); i < 16; i++) lcd.print(" ");
-}
-
 // ===========================================================================
 // Business Logic
 // ===========================================================================
 void persistIfNeeded() {
     prefs.begin("biolight", false);
     prefs.putUChar("lang", (uint8_t)currentLang);
-    prefs.putUChar("r", r_val);
-    prefs.putUChar("g", g_val);
-    prefs.putUChar("b", b_val);
-    prefs.putUChar("int", intensity_val);
     prefs.putBool("wifi_on", wifiEnabled);
     prefs.end();
+    lightStore.update(r_val, g_val, b_val, intensity_val);
 }
 
 void applyDeltaToCurrentItem(int dir) {
@@ -162,57 +99,47 @@ void applyDeltaToCurrentItem(int dir) {
 // Rendering Functions
 // ===========================================================================
 void renderMenuValue() {
-    lcdClearRow(1);
     String valStr;
     switch (currentItem) {
         case M_RED: valStr = String(r_val); break;
         case M_GREEN: valStr = String(g_val); break;
         case M_BLUE: valStr = String(b_val); break;
         case M_INTENSITY: valStr = String(intensity_val) + "%"; break;
-        case M_LANG: valStr = (currentLang == ES) ? "Espanol" : "English"; break;
+        case M_LANG: valStr = tr(currentLang == ES ? TR_LANG_ES : TR_LANG_EN); break;
         case M_WIFI_TOGGLE: valStr = wifiEnabled ? "ON" : "OFF"; break;
         case M_WIFI_CHANGE: valStr = (wifiManager.getMode() == WiFiMode::AP) ? "AP" : "STA"; break;
         default: break;
     }
-    lcdPrint16(1, (editMode ? "> " : "") + valStr);
+    lcd.printRow(1, (editMode ? "> " : "") + valStr);
 }
 
 void renderMenu() {
-  lcdClearRow(0);
-  lcdPrint16(0, tr(menuItemKey(currentItem)));
+  lcd.printRow(0, tr(menuItemKey(currentItem)));
   renderMenuValue();
 }
 
 void renderWifiToggle() {
-    lcdPrint16(0, tr("M_WIFI_TOGGLE"));
+    lcd.printRow(0, tr(TR_MENU_WIFI_TOGGLE));
     String s = (wifiToggleSelection == 0) ? "[o] ON  [ ] OFF" : "[ ] ON  [o] OFF";
-    lcdPrint16(1, s);
+    lcd.printRow(1, s);
 }
 
 void renderWifiChange() {
-    lcdPrint16(0, tr("M_WIFI_CHANGE"));
+    lcd.printRow(0, tr(TR_MENU_WIFI_CHANGE));
     String s = (wifiChangeSelection == 0) ? "[o] STA [ ] AP " : "[ ] STA [o] AP ";
-    lcdPrint16(1, s);
+    lcd.printRow(1, s);
 }
 
-void renderHome(bool forceRedraw = false) {
-    static String lastLine1 = "", lastLine2 = "";
-
-    if (forceRedraw) {
-        lastLine1 = "";
-        lastLine2 = "";
-        lcd.clear();
-    }
-
+void renderHome() {
     String line1 = "";
     if (!wifiEnabled) {
-        line1 = tr("home.wifi_off");
+        line1 = tr(TR_HOME_WIFI_OFF);
     } else if (wifiManager.isConnected()) {
         line1 = wifiManager.getStaIp();
     } else if (wifiManager.getMode() == WiFiMode::AP) {
         switch(homeApInfoSlot) {
             case AP_INFO_MODE:
-                line1 = tr("home.ap_mode");
+                line1 = tr(TR_HOME_AP_MODE);
                 break;
             case AP_INFO_SSID:
                 line1 = wifiManager.getApSsid();
@@ -222,20 +149,25 @@ void renderHome(bool forceRedraw = false) {
                 break;
         }
     } else {
-        line1 = tr("home.no_wifi");
+        line1 = tr(TR_HOME_NO_WIFI);
     }
 
+    // What is on the strip: it differs from r_val/g_val/b_val while a program plays
+    uint8_t r, g, b, intensity;
+    homeColorChanges = ledDriver.colorChangeCount();
+    ledDriver.getColor(r, g, b, intensity);
+
     String line2 = "";
     char buf[17];
     if (homeSlot == HOME_SLOT_RG) {
-        snprintf(buf, sizeof(buf), "%s:%-3d %s:%-3d", tr("home.red").c_str(), r_val, tr("home.green").c_str(), g_val);
+        snprintf(buf, sizeof(buf), "%s:%-3d %s:%-3d", tr(TR_HOME_RED), r, tr(TR_HOME_GREEN), g);
     } else {
-        snprintf(buf, sizeof(buf), "%s:%-3d %s:%-3d", tr("home.blue").c_str(), b_val, tr("home.light").c_str(), intensity_val);
+        snprintf(buf, sizeof(buf), "%s:%-3d %s:%-3d", tr(TR_HOME_BLUE), b, tr(TR_HOME_LIGHT), intensity);
     }
     line2 = String(buf);
 
-    if (line1 != lastLine1) { lcdPrint16(0, line1); lastLine1 = line1; }
-    if (line2 != lastLine2) { lcdPrint16(1, line2); lastLine2 = line2; }
+    lcd.printRow(0, line1);
+    lcd.printRow(1, line2);
 }
 
 // ===========================================================================
@@ -246,23 +178,34 @@ void setup() {
     Serial.println("\n[main] BioLighting Firmware Starting...");
     prefs.begin("biolight", true);
     currentLang = (Lang)prefs.getUChar("lang", (uint8_t)ES);
+    if (currentLang >= LANG_COUNT) currentLang = ES;
     r_val = prefs.getUChar("r", 255);
     g_val = prefs.getUChar("g", 255);
     b_val = prefs.getUChar("b", 255);
     intensity_val = prefs.getUChar("int", 100);
     wifiEnabled = prefs.getBool("wifi_on", true);
     prefs.end();
-    ledDriver.initLeds();
+    // The packed record supersedes the per-key values read above (kept for migration).
+    LightRecord rec = { LIGHT_RECORD_VERSION, r_val, g_val, b_val, intensity_val };
+    lightStore.begin(rec);
+    r_val = rec.r;
+    g_val = rec.g;
+    b_val = rec.b;
+    intensity_val = rec.intensity;
+    SegmentLayout layout;
+    if (!storage.loadSegments(layout)) {
+        defaultLayout(layout);
+    }
+    ledDriver.initLeds(layout);
     ledDriver.setColor(r_val, g_val, b_val, intensity_val);
-    lcd.init();
-    lcd.backlight();
-    lcd.clear();
-    pinMode(ENCODER_SW_PIN, INPUT_PULLUP);
+    lcd.begin();
+    encoderInput.begin(ENCODER_CLK_PIN, ENCODER_DT_PIN, ENCODER_SW_PIN);
     if (wifiEnabled) {
       wifiManager.begin();
       webServer.begin(); // Server runs in AP and STA mode
     }
-    renderHome(true);
+    renderHome();
+    lcd.present();
     Serial.println("[main] Setup complete.");
 }
 
@@ -276,7 +219,7 @@ void onShortClick() {
     } else if (uiScreen == MENU && !editMode) {
         if (currentItem == M_BACK) {
             uiScreen = HOME;
-            renderHome(true); // Force redraw
+            renderHome();
         } else if (currentItem == M_WIFI_TOGGLE) {
             uiScreen = WIFI_TOGGLE;
             wifiToggleSelection = wifiEnabled ? 0 : 1;
@@ -284,8 +227,9 @@ void onShortClick() {
         } else if (currentItem == M_WIFI_CHANGE) {
             // This option now simply forces a restart into AP mode
             lcd.clear();
-            lcdPrint16(0, "Reiniciando...");
-            lcdPrint16(1, "Modo AP Forzado");
+            lcd.printRow(0, "Reiniciando...");
+            lcd.printRow(1, "Modo AP Forzado");
+            lcd.present(); // Flushed while forceApMode() waits to restart
             wifiManager.forceApMode(); // This will reset creds and restart
         } else {
             uiScreen = EDIT;
@@ -303,12 +247,13 @@ void onShortClick() {
             wifiEnabled = willBeEnabled;
             persistIfNeeded();
             lcd.clear();
-            lcdPrint16(0, "Reiniciando...");
+            lcd.printRow(0, "Reiniciando...");
+            lcd.present();
             delay(1000);
             ESP.restart();
         } else {
             uiScreen = HOME;
-            renderHome(true);
+            renderHome();
         }
     }
 }
@@ -320,18 +265,13 @@ void onLongClick() {
     } else if (uiScreen == EDIT) {
         uiScreen = MENU;
         editMode = false;
-        // Reload values from prefs
-        prefs.begin("biolight", true);
-        r_val = prefs.getUChar("r", 255);
-        g_val = prefs.getUChar("g", 255);
-        b_val = prefs.getUChar("b", 255);
-        intensity_val = prefs.getUChar("int", 100);
-        prefs.end();
+        // Revert to the last saved values
+        lightStore.current(r_val, g_val, b_val, intensity_val);
         ledDriver.setColor(r_val, g_val, b_val, intensity_val);
         renderMenu();
     } else if (uiScreen == MENU) {
         uiScreen = HOME;
-        renderHome(true); // Force redraw
+        renderHome();
     }
 }
 
@@ -355,33 +295,28 @@ void onEncoderTurn(int dir) {
 // Main Loop
 // ===========================================================================
 void loop() {
-    encoder.tick();
-
-    // --- Handle Encoder Turn ---
-    int dir = (int)encoder.getDirection();
-    if (dir != 0) {
-        onEncoderTurn(dir);
-    }
-
-    // --- Handle Encoder Click (Unified) ---
-    static unsigned long pressStartTime = 0;
-    static bool longPressHandled = false;
-    bool isPressed = (digitalRead(ENCODER_SW_PIN) == LOW);
-
-    if (isPressed) {
-        if (pressStartTime == 0) {
-            pressStartTime = millis();
-        }
-        if (!longPressHandled && (millis() - pressStartTime > 1000)) {
-            onLongClick();
-            longPressHandled = true;
-        }
-    } else {
-        if (pressStartTime > 0 && !longPressHandled) {
-            onShortClick();
+    // Sleeps until the knob is used or the periodic work below is due
+    EncoderEvent event;
+    bool hasEvent = encoderInput.next(event, UI_IDLE_WAIT_MS);
+
+    MetricTimer loopTimer(metrics::loopDuration);
+    lightStore.loop();
+    ledDriver.loop();
+    wifiScan.loop();
+    webServer.loop();
+
+    if (hasEvent) {
+        switch (event.kind) {
+            case ENC_TURN: {
+                int dir = event.detents > 0 ? 1 : -1;
+                for (int i = 0; i < abs(event.detents); i++) {
+                    onEncoderTurn(dir);
+                }
+                break;
+            }
+            case ENC_CLICK: onShortClick(); break;
+            case ENC_LONG_PRESS: onLongClick(); break;
         }
-        pressStartTime = 0;
-        longPressHandled = false;
     }
 
     // --- Handle Home Carousels ---
@@ -399,8 +334,14 @@ void loop() {
             lastHomeApInfoSwitch = now;
             needsRender = true;
         }
+        if (ledDriver.colorChangeCount() != homeColorChanges) {
+            needsRender = true; // Program keyframes, web and API changes
+        }
         if (needsRender) {
             renderHome();
         }
     }
+
+    // Hands whatever the handlers above drew to the LCD flush task
+    lcd.present();
 }
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free "latest value" mailbox for many producers and one consumer.
+//
+// Each post() claims a free slot from a bitmask, writes the value into it and
+// swaps it in as the latest one. A value that was never taken is recycled
+// immediately, so bursts of posts collapse into the single newest value.
+// Neither side ever waits on the other: a slot is owned by exactly one party
+// between claim and release. N must cover the producers that can be inside
+// post() at the same time, plus one latest slot and one being read.
+template <typename T, uint8_t N = 4>
+class Mailbox {
+    static_assert(N >= 3 && N < 32, "Mailbox needs between 3 and 31 slots");
+
+public:
+    // Publishes `value`, replacing any value not yet taken. Returns false only
+    // if every slot is busy (more concurrent producers than slots).
+    bool post(const T& value) {
+        uint8_t slot;
+        if (!claim(slot)) return false;
+        _slots[slot] = value;
+        uint8_t old = _latest.exchange(slot, std::memory_order_acq_rel);
+        if (old != NONE) {
+            release(old);
+            _superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Copies the newest value posted since the last take(). Consumer only.
+    bool take(T& out) {
+        uint8_t slot = _latest.exchange(NONE, std::memory_order_acq_rel);
+        if (slot == NONE) return false;
+        out = _slots[slot];
+        release(slot);
+        return true;
+    }
+
+    // Number of posted values that were replaced before being taken.
+    uint32_t superseded() const { return _superseded.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint8_t NONE = 0xFF;
+
+    bool claim(uint8_t& slot) {
+        uint32_t mask = _free.load(std::memory_order_relaxed);
+        for (;;) {
+            if (mask == 0) return false;
+            uint32_t bit = mask & (~mask + 1); // lowest free slot
+            if (_free.compare_exchange_weak(mask, mask & ~bit,
+                                            std::memory_order_acquire, std::memory_order_relaxed)) {
+                slot = (uint8_t)__builtin_ctz(bit);
+                return true;
+            }
+        }
+    }
+
+    void release(uint8_t slot) {
+        _free.fetch_or(1u << slot, std::memory_order_release);
+    }
+
+    T _slots[N] = {};
+    std::atomic<uint32_t> _free{(1u << N) - 1};
+    std::atomic<uint8_t> _latest{NONE};
+    std::atomic<uint32_t> _superseded{0};
+};
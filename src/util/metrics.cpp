@@ -0,0 +1,156 @@
+#include "metrics.h"
+#include <stdio.h>
+
+Metric* Metric::_first = nullptr;
+Metric* Metric::_last = nullptr;
+
+Metric::Metric(Type type, const char* name, const char* help, const char* labels) :
+    _type(type),
+    _name(name),
+    _help(help),
+    _labels(labels) {
+    // Static construction is single-threaded, so no locking here
+    if (_last) {
+        _last->_next = this;
+    } else {
+        _first = this;
+    }
+    _last = this;
+}
+
+// snprintf() returns the untruncated length; clamp it to what was written
+static size_t clampWritten(int n, size_t len) {
+    if (n < 0 || len == 0) return 0;
+    return (size_t)n < len ? (size_t)n : len - 1;
+}
+
+size_t Metric::writeSeries(char* out, size_t len, const char* suffix, const char* extra) const {
+    bool labelled = _labels || extra;
+    int n = snprintf(out, len, "%s%s%s%s%s%s%s ", _name, suffix, labelled ? "{" : "",
+                     _labels ? _labels : "", _labels && extra ? "," : "", extra ? extra : "",
+                     labelled ? "}" : "");
+    return clampWritten(n, len);
+}
+
+// ---------------------------------------------------------------------------
+// Counter / Gauge
+// ---------------------------------------------------------------------------
+uint32_t Counter::value() const {
+    uint32_t total = 0;
+    for (const std::atomic<uint32_t>& slot : _slots) {
+        total += slot.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t Counter::writeSample(uint8_t index, const uint32_t* values, char* out, size_t len) const {
+    (void)index;
+    size_t n = writeSeries(out, len);
+    return n + clampWritten(snprintf(out + n, len - n, "%lu", (unsigned long)values[0]), len - n);
+}
+
+size_t Gauge::writeSample(uint8_t index, const uint32_t* values, char* out, size_t len) const {
+    (void)index;
+    (void)values;
+    size_t n = writeSeries(out, len);
+    return n + clampWritten(snprintf(out + n, len - n, "%.10g", _read()), len - n);
+}
+
+// ---------------------------------------------------------------------------
+// Histogram
+// ---------------------------------------------------------------------------
+const uint32_t Histogram::BOUNDS_US[BUCKETS - 1] = {
+    20, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 100000, 1000000
+};
+
+void Histogram::record(uint32_t us) {
+    uint8_t bucket = 0;
+    while (bucket < BUCKETS - 1 && us > BOUNDS_US[bucket]) {
+        bucket++;
+    }
+    Slot& slot = _slots[core()];
+    slot.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    slot.sumUs.fetch_add(us, std::memory_order_relaxed);
+}
+
+void Histogram::read(uint32_t* values) const {
+    for (uint8_t b = 0; b <= BUCKETS; b++) values[b] = 0;
+    for (const Slot& slot : _slots) {
+        for (uint8_t b = 0; b < BUCKETS; b++) {
+            values[b] += slot.buckets[b].load(std::memory_order_relaxed);
+        }
+        values[BUCKETS] += slot.sumUs.load(std::memory_order_relaxed);
+    }
+}
+
+size_t Histogram::writeSample(uint8_t index, const uint32_t* values, char* out, size_t len) const {
+    uint32_t count = 0;
+    for (uint8_t b = 0; b < BUCKETS && b <= index; b++) {
+        count += values[b];
+    }
+
+    size_t n;
+    if (index < BUCKETS) {
+        // Cumulative bucket; bounds are exported in seconds
+        char le[24];
+        if (index < BUCKETS - 1) {
+            snprintf(le, sizeof(le), "le=\"%g\"", BOUNDS_US[index] / 1e6);
+        } else {
+            snprintf(le, sizeof(le), "le=\"+Inf\"");
+        }
+        n = writeSeries(out, len, "_bucket", le);
+    } else if (index == BUCKETS) {
+        n = writeSeries(out, len, "_sum");
+        return n + clampWritten(snprintf(out + n, len - n, "%.6f", values[BUCKETS] / 1e6), len - n);
+    } else {
+        n = writeSeries(out, len, "_count");
+    }
+    return n + clampWritten(snprintf(out + n, len - n, "%lu", (unsigned long)count), len - n);
+}
+
+// ---------------------------------------------------------------------------
+// Firmware metrics, in export order
+// ---------------------------------------------------------------------------
+namespace metrics {
+
+Histogram loopDuration("biolight_loop_duration_seconds", "Duration of one pass of the Arduino loop()");
+Histogram ledFrame("biolight_led_frame_duration_seconds", "Render task work per frame, FastLED.show() included");
+Histogram ledShow("biolight_led_show_duration_seconds", "Duration of FastLED.show()");
+Histogram nvsWrite("biolight_nvs_write_duration_seconds", "Duration of one Storage write to NVS");
+Counter nvsReads("biolight_nvs_reads_total", "Storage reads from NVS");
+Histogram lcdFlush("biolight_lcd_flush_duration_seconds", "Duration of one LCD frame flush over I2C");
+Counter lcdWrites("biolight_lcd_writes_total", "Characters and cursor commands sent to the LCD");
+
+#define HTTP_REQUEST_METRIC "biolight_http_request_duration_seconds"
+#define HTTP_REQUEST_HELP   "REST handler duration, response rendering included"
+Histogram httpRequest[HTTP_ROUTE_COUNT] = {
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"light\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"segments\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"order\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"persist\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"program\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"presets\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"wifi\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"lang\"" },
+    { HTTP_REQUEST_METRIC, HTTP_REQUEST_HELP, "route=\"metrics\"" },
+};
+
+static double readFreeHeap() { return ESP.getFreeHeap(); }
+static double readMinFreeHeap() { return ESP.getMinFreeHeap(); }
+static double readLargestFreeBlock() { return ESP.getMaxAllocHeap(); }
+static double readFragmentation() {
+    // 0 when the free heap is one block, towards 1 as it splinters
+    uint32_t free = ESP.getFreeHeap();
+    return free ? 1.0 - (double)ESP.getMaxAllocHeap() / free : 0.0;
+}
+static double readUptime() { return millis() / 1000.0; }
+
+Gauge heapFree("biolight_heap_free_bytes", "Free heap", readFreeHeap);
+Gauge heapMinFree("biolight_heap_min_free_bytes", "Lowest free heap since boot", readMinFreeHeap);
+Gauge heapLargestBlock("biolight_heap_largest_free_block_bytes", "Largest allocatable heap block",
+                       readLargestFreeBlock);
+Gauge heapFragmentation("biolight_heap_fragmentation_ratio", "1 - largest free block / free heap",
+                        readFragmentation);
+Gauge uptime("biolight_uptime_seconds", "Time since boot", readUptime);
+
+} // namespace metrics
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+// Lightweight runtime instrumentation, exported by GET /api/metrics in the
+// Prometheus text format.
+//
+// Every metric keeps one slot per core and only the running core writes its
+// own slot, with a relaxed atomic add: recording never takes a lock or
+// disables interrupts and the two cores never contend for a word. Readers
+// sum the slots, so a scrape may see a histogram a few events apart from its
+// _count, as Prometheus allows.
+//
+// Metrics are static objects; each links itself into a global list on
+// construction, in definition order, which is the export order (metrics of
+// one family must be defined next to each other).
+class Metric {
+public:
+    enum Type : uint8_t { COUNTER, GAUGE, HISTOGRAM };
+
+    // Largest number of values read() returns (histogram buckets + sum)
+    static constexpr uint8_t MAX_VALUES = 13;
+
+    Metric(Type type, const char* name, const char* help, const char* labels);
+    virtual ~Metric() {}
+
+    static Metric* first() { return _first; }
+    Metric* next() const { return _next; }
+
+    Type type() const { return _type; }
+    const char* name() const { return _name; }
+    const char* help() const { return _help; }
+    const char* labels() const { return _labels; } // e.g. route="light", or nullptr
+
+    // Export: read() takes a snapshot of the totals once, then every sample
+    // line is rendered from it, so the lines of one scrape agree.
+    virtual void read(uint32_t* values) const { (void)values; }
+    virtual uint8_t sampleCount() const { return 1; }
+    // Renders sample line `index` (without the newline); returns its length.
+    virtual size_t writeSample(uint8_t index, const uint32_t* values, char* out, size_t len) const = 0;
+
+protected:
+    static uint8_t core() { return (uint8_t)xPortGetCoreID() % portNUM_PROCESSORS; }
+
+    // "name{labels} " or "name_suffix{labels,extra} "
+    size_t writeSeries(char* out, size_t len, const char* suffix = "", const char* extra = nullptr) const;
+
+private:
+    static Metric* _first;
+    static Metric* _last;
+
+    Metric* _next = nullptr;
+    Type _type;
+    const char* _name;
+    const char* _help;
+    const char* _labels;
+};
+
+class Counter : public Metric {
+public:
+    Counter(const char* name, const char* help, const char* labels = nullptr) :
+        Metric(COUNTER, name, help, labels) {}
+
+    void inc(uint32_t n = 1) { _slots[core()].fetch_add(n, std::memory_order_relaxed); }
+    uint32_t value() const;
+
+    void read(uint32_t* values) const override { values[0] = value(); }
+    size_t writeSample(uint8_t index, const uint32_t* values, char* out, size_t len) const override;
+
+private:
+    std::atomic<uint32_t> _slots[portNUM_PROCESSORS] = {};
+};
+
+// Value computed when scraped (heap, uptime).
+class Gauge : public Metric {
+public:
+    typedef double (*ReadFn)();
+
+    Gauge(const char* name, const char* help, ReadFn read, const char* labels = nullptr) :
+        Metric(GAUGE, name, help, labels), _read(read) {}
+
+    size_t writeSample(uint8_t index, const uint32_t* values, char* out, size_t len) const override;
+
+private:
+    ReadFn _read;
+};
+
+// Duration histogram with fixed buckets from 20 us to 1 s. The sum is kept
+// in microseconds in 32 bits, so it wraps after ~71 minutes of accumulated
+// time; Prometheus treats that as a counter reset.
+class Histogram : public Metric {
+public:
+    static constexpr uint8_t BUCKETS = 12;
+    static const uint32_t BOUNDS_US[BUCKETS - 1]; // The last bucket is +Inf
+
+    Histogram(const char* name, const char* help, const char* labels = nullptr) :
+        Metric(HISTOGRAM, name, help, labels) {}
+
+    void record(uint32_t us);
+
+    // values: per-bucket counts, then the sum in microseconds
+    void read(uint32_t* values) const override;
+    uint8_t sampleCount() const override { return BUCKETS + 2; } // buckets, _sum, _count
+    size_t writeSample(uint8_t index, const uint32_t* values, char* out, size_t len) const override;
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> buckets[BUCKETS];
+        std::atomic<uint32_t> sumUs;
+    };
+    Slot _slots[portNUM_PROCESSORS] = {};
+};
+
+// Times a scope with esp_timer and records it into `histogram`. Unlike the
+// per-core cycle counter, the timer is shared by both cores and does not
+// depend on the CPU clock, so unpinned tasks (AsyncTCP) can be timed too.
+class MetricTimer {
+public:
+    explicit MetricTimer(Histogram& histogram) : _histogram(histogram), _start(esp_timer_get_time()) {}
+    ~MetricTimer() { _histogram.record((uint32_t)(esp_timer_get_time() - _start)); }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    Histogram& _histogram;
+    int64_t _start;
+};
+
+// The firmware's metrics (defined in metrics.cpp)
+namespace metrics {
+
+extern Histogram loopDuration;
+extern Histogram ledFrame;
+extern Histogram ledShow;
+extern Histogram nvsWrite;
+extern Counter nvsReads;
+extern Histogram lcdFlush;
+extern Counter lcdWrites;
+
+enum HttpRoute : uint8_t {
+    HTTP_ROUTE_LIGHT,
+    HTTP_ROUTE_SEGMENTS,
+    HTTP_ROUTE_ORDER,
+    HTTP_ROUTE_PERSIST,
+    HTTP_ROUTE_PROGRAM,
+    HTTP_ROUTE_PRESETS,
+    HTTP_ROUTE_WIFI,
+    HTTP_ROUTE_LANG,
+    HTTP_ROUTE_METRICS,
+    HTTP_ROUTE_COUNT
+};
+extern Histogram httpRequest[HTTP_ROUTE_COUNT];
+
+} // namespace metrics
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free bounded FIFO for one producer and one consumer, e.g. an
+// interrupt handler feeding a task.
+//
+// The producer only writes _head and the consumer only writes _tail, so
+// neither side ever waits or disables interrupts. N must be a power of two;
+// N - 1 items fit. When the queue is full push() drops the item and counts
+// it instead of overwriting unread ones.
+template <typename T, uint8_t N = 32>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    // Producer only. Safe from an ISR: always inlined so it runs from the
+    // caller's IRAM instead of a flash copy of the template.
+    __attribute__((always_inline)) bool push(const T& item) {
+        uint8_t head = _head.load(std::memory_order_relaxed);
+        uint8_t next = (head + 1) & (N - 1);
+        if (next == _tail.load(std::memory_order_acquire)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _items[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool pop(T& out) {
+        uint8_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        out = _items[tail];
+        _tail.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+    }
+
+    // Items rejected because the queue was full.
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    T _items[N] = {};
+    std::atomic<uint8_t> _head{0};
+    std::atomic<uint8_t> _tail{0};
+    std::atomic<uint32_t> _dropped{0};
+};
@@ -0,0 +1,81 @@
+#include "json_response.h"
+#include <string.h>
+
+JsonResponse::JsonResponse(int code) :
+    _writer(_body, sizeof(_body)) {
+    _code = code;
+    _contentType = "application/json";
+}
+
+void JsonResponse::_respond(AsyncWebServerRequest* request) {
+    if (_writer.overflowed()) {
+        // Never send truncated JSON
+        _code = 500;
+        _writer = JsonWriter(_body, sizeof(_body));
+        _writer.beginObject();
+        _writer.field("error", "overflow");
+        _writer.endObject();
+    }
+    _contentLength = _writer.length();
+    AsyncAbstractResponse::_respond(request);
+}
+
+size_t JsonResponse::_fillBuffer(uint8_t* buf, size_t maxLen) {
+    size_t n = _writer.length() - _sent;
+    if (n > maxLen) n = maxLen;
+    memcpy(buf, _body + _sent, n);
+    _sent += n;
+    return n;
+}
+
+ScanResultsResponse::ScanResultsResponse(WifiScanService& scan) {
+    _code = 200;
+    _contentType = "application/json";
+    scan.snapshot(_results);
+
+    // Length is known up front, so no chunked encoding is needed
+    size_t total = 0;
+    size_t len;
+    for (uint8_t i = 0; renderPiece(i, _piece, len); i++) {
+        total += len;
+    }
+    _contentLength = total;
+}
+
+bool ScanResultsResponse::renderPiece(uint8_t index, char* out, size_t& len) {
+    if (index == 0) {
+        out[0] = '[';
+        len = 1;
+        return true;
+    }
+    if (index == _results.count + 1) {
+        out[0] = ']';
+        len = 1;
+        return true;
+    }
+    if (index > _results.count + 1) return false;
+
+    size_t comma = index > 1 ? 1 : 0;
+    out[0] = ',';
+    JsonWriter json(out + comma, ScanResults::ENTRY_JSON_LEN);
+    ScanResults::writeEntry(json, _results.entries[index - 1]);
+    len = comma + json.length();
+    return true;
+}
+
+size_t ScanResultsResponse::_fillBuffer(uint8_t* buf, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (_piecePos == _pieceLen) {
+            if (!renderPiece(_nextPiece, _piece, _pieceLen)) break;
+            _nextPiece++;
+            _piecePos = 0;
+        }
+        size_t n = _pieceLen - _piecePos;
+        if (n > maxLen - written) n = maxLen - written;
+        memcpy(buf + written, _piece + _piecePos, n);
+        _piecePos += n;
+        written += n;
+    }
+    return written;
+}
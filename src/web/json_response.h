@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include "json_writer.h"
+#include "wifi_scan.h"
+
+// Response whose JSON body is written in place into a fixed buffer inside
+// the response object and copied from there straight into the TCP send
+// buffer, with no JsonDocument or String for the body.
+class JsonResponse : public AsyncAbstractResponse {
+public:
+    static constexpr size_t CAPACITY = 192;
+
+    explicit JsonResponse(int code = 200);
+
+    // Write the body through this, then hand the response to request->send().
+    JsonWriter& writer() { return _writer; }
+
+    bool _sourceValid() const override { return true; }
+    size_t _fillBuffer(uint8_t* buf, size_t maxLen) override;
+    void _respond(AsyncWebServerRequest* request) override;
+
+private:
+    char _body[CAPACITY];
+    JsonWriter _writer;
+    size_t _sent = 0;
+};
+
+// Streams a snapshot of the WiFi scan results as a JSON array, rendering one
+// network at a time straight into the TCP send buffer.
+class ScanResultsResponse : public AsyncAbstractResponse {
+public:
+    explicit ScanResultsResponse(WifiScanService& scan);
+
+    bool _sourceValid() const override { return true; }
+    size_t _fillBuffer(uint8_t* buf, size_t maxLen) override;
+
+private:
+    ScanResults _results;
+    uint8_t _nextPiece = 0; // "[", one per entry, then "]"
+    char _piece[ScanResults::ENTRY_JSON_LEN + 1];
+    size_t _pieceLen = 0;
+    size_t _piecePos = 0;
+
+    bool renderPiece(uint8_t index, char* out, size_t& len);
+};
@@ -0,0 +1,101 @@
+#include "json_writer.h"
+#include <stdio.h>
+#include <string.h>
+
+JsonWriter::JsonWriter(char* buf, size_t capacity) :
+    _buf(buf),
+    _cap(capacity) {
+    if (_cap) _buf[0] = '\0';
+}
+
+void JsonWriter::beginObject() {
+    separate();
+    put('{');
+    _comma = false;
+}
+
+void JsonWriter::endObject() {
+    put('}');
+    _comma = true;
+}
+
+void JsonWriter::beginArray() {
+    separate();
+    put('[');
+    _comma = false;
+}
+
+void JsonWriter::endArray() {
+    put(']');
+    _comma = true;
+}
+
+void JsonWriter::key(const char* name) {
+    value(name);
+    put(':');
+    _comma = false;
+}
+
+void JsonWriter::value(const char* str) {
+    separate();
+    put('"');
+    for (const char* p = str; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put((char)c);
+        } else if (c < 0x20) {
+            char esc[7];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            write(esc, 6);
+        } else {
+            put((char)c);
+        }
+    }
+    put('"');
+    _comma = true;
+}
+
+void JsonWriter::value(int32_t v) {
+    char num[12];
+    int n = snprintf(num, sizeof(num), "%ld", (long)v);
+    separate();
+    write(num, (size_t)n);
+    _comma = true;
+}
+
+void JsonWriter::value(uint32_t v) {
+    char num[11];
+    int n = snprintf(num, sizeof(num), "%lu", (unsigned long)v);
+    separate();
+    write(num, (size_t)n);
+    _comma = true;
+}
+
+void JsonWriter::value(bool v) {
+    separate();
+    if (v) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+    _comma = true;
+}
+
+void JsonWriter::put(char c) {
+    write(&c, 1);
+}
+
+void JsonWriter::write(const char* s, size_t n) {
+    if (_overflow || _len + n >= _cap) {
+        _overflow = true;
+        return;
+    }
+    memcpy(_buf + _len, s, n);
+    _len += n;
+    _buf[_len] = '\0';
+}
+
+void JsonWriter::separate() {
+    if (_comma) put(',');
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal JSON serializer into a caller-provided buffer. It never allocates:
+// output that does not fit is dropped and reported by overflowed(), and the
+// buffer always stays NUL-terminated.
+class JsonWriter {
+public:
+    JsonWriter(char* buf, size_t capacity);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(const char* name);
+    void value(const char* str);
+    void value(int32_t v);
+    void value(uint32_t v);
+    void value(bool v);
+
+    template <typename T>
+    void field(const char* name, T v) {
+        key(name);
+        value(v);
+    }
+
+    const char* c_str() const { return _buf; }
+    size_t length() const { return _len; }
+    bool overflowed() const { return _overflow; }
+
+private:
+    char* _buf;
+    size_t _cap;
+    size_t _len = 0;
+    bool _comma = false;
+    bool _overflow = false;
+
+    void put(char c);
+    void write(const char* s, size_t n);
+    void separate();
+};
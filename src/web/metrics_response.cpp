@@ -0,0 +1,65 @@
+#include "metrics_response.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* typeName(Metric::Type type) {
+    switch (type) {
+        case Metric::COUNTER: return "counter";
+        case Metric::GAUGE: return "gauge";
+        case Metric::HISTOGRAM: return "histogram";
+    }
+    return "untyped";
+}
+
+MetricsResponse::MetricsResponse() :
+    _metric(Metric::first()) {
+    _code = 200;
+    _contentType = "text/plain; version=0.0.4";
+    _sendContentLength = false;
+    _chunked = true;
+}
+
+// Renders the next line into _piece; false once every metric is out.
+bool MetricsResponse::renderLine() {
+    while (_metric) {
+        uint8_t samples = _metric->sampleCount();
+        int n = -1;
+        if (_line == 0) {
+            if (_familyStart) n = snprintf(_piece, sizeof(_piece), "# HELP %s %s\n", _metric->name(), _metric->help());
+        } else if (_line == 1) {
+            if (_familyStart) n = snprintf(_piece, sizeof(_piece), "# TYPE %s %s\n", _metric->name(),
+                                           typeName(_metric->type()));
+            _metric->read(_values); // One snapshot for all the samples below
+        } else if (_line < 2 + samples) {
+            size_t len = _metric->writeSample(_line - 2, _values, _piece, sizeof(_piece) - 1);
+            _piece[len++] = '\n';
+            n = (int)len;
+        } else {
+            Metric* next = _metric->next();
+            _familyStart = !next || strcmp(next->name(), _metric->name()) != 0;
+            _metric = next;
+            _line = 0;
+            continue;
+        }
+        _line++;
+        if (n >= 0) {
+            _pieceLen = (size_t)n < sizeof(_piece) ? (size_t)n : sizeof(_piece) - 1;
+            _piecePos = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t MetricsResponse::_fillBuffer(uint8_t* buf, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (_piecePos == _pieceLen && !renderLine()) break;
+        size_t n = _pieceLen - _piecePos;
+        if (n > maxLen - written) n = maxLen - written;
+        memcpy(buf + written, _piece + _piecePos, n);
+        _piecePos += n;
+        written += n;
+    }
+    return written;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include "../util/metrics.h"
+
+// Streams every registered metric in the Prometheus text exposition format
+// (version 0.0.4), one line at a time straight into the TCP send buffer.
+// The body is chunked, so nothing is rendered twice to learn its length.
+class MetricsResponse : public AsyncAbstractResponse {
+public:
+    static constexpr size_t LINE_LEN = 192;
+
+    MetricsResponse();
+
+    bool _sourceValid() const override { return true; }
+    size_t _fillBuffer(uint8_t* buf, size_t maxLen) override;
+
+private:
+    Metric* _metric;
+    uint8_t _line = 0;          // HELP, TYPE, then the samples
+    bool _familyStart = true;   // First metric of its name: print HELP/TYPE
+    uint32_t _values[Metric::MAX_VALUES];
+    char _piece[LINE_LEN];
+    size_t _pieceLen = 0;
+    size_t _piecePos = 0;
+
+    bool renderLine();
+};
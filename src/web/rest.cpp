@@ -1,156 +1,388 @@
 #include "rest.h"
 #include "../config.h"
+#include "../drivers/program.h"
+#include "../drivers/led_timing.h"
+#include "json_response.h"
+#include "metrics_response.h"
+#include "../util/metrics.h"
 #include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
-#include <Preferences.h>
 #include <WiFi.h>
+#include <esp_wifi.h>
 #include <AsyncJson.h>
 
-// Variables globales para el escaneo WiFi asíncrono
-volatile bool scanRunning = false;
-volatile bool scanComplete = false;
-String scanResultsJson = "[]"; // Para almacenar los resultados
-TaskHandle_t scanTaskHandle = NULL; // Handle para la tarea de escaneo
-
 extern LedDriver ledDriver;
-extern Preferences prefs;
 extern uint8_t r_val, g_val, b_val, intensity_val;
 
-// Tarea para realizar el escaneo WiFi en segundo plano
-void wifiScanTask(void *pvParameters) {
-    scanRunning = true;
-    scanComplete = false;
-    log_i("Iniciando escaneo WiFi en tarea separada...");
-
-    int n = WiFi.scanNetworks(); // Llamada bloqueante, pero ahora en su propia tarea
-
-    log_i("Escaneo completado. %d redes encontradas.", n);
-
-    JsonDocument jsonDoc; // Usar JsonDocument en lugar de DynamicJsonDocument
-    jsonDoc.to<JsonArray>();
-    JsonArray networks = jsonDoc.as<JsonArray>();
-
-    if (n > 0) {
-        for (int i = 0; i < n; ++i) {
-            JsonObject net = networks.add<JsonObject>(); // Usar add<JsonObject>()
-            net["ssid"] = WiFi.SSID(i);
-            net["rssi"] = WiFi.RSSI(i);
-            net["secure"] = WiFi.encryptionType(i) != WIFI_AUTH_OPEN;
-        }
-    }
-    // std::sort no funciona directamente con JsonArray. Debemos copiar a un vector.
-    std::vector<JsonObject> networks_vec;
-    for (JsonObject net : networks) {
-        networks_vec.push_back(net);
-    }
-
-    // Ordenar el vector
-    std::sort(networks_vec.begin(), networks_vec.end(), [](const JsonObject &a, const JsonObject &b) {
-        return a["rssi"].as<int>() > b["rssi"].as<int>();
-    });
-
-    // Crear un nuevo documento JSON con los datos ordenados
-    JsonDocument sortedDoc;
-    sortedDoc.to<JsonArray>();
-    JsonArray sortedNetworks = sortedDoc.as<JsonArray>();
-    for (const auto& net : networks_vec) {
-        sortedNetworks.add(net);
-    }
-
-    scanResultsJson = ""; // Limpia la cadena antes de serializar
-    serializeJson(sortedDoc, scanResultsJson);
-
-    scanComplete = true;
-    scanRunning = false;
-    scanTaskHandle = NULL; // Indica que la tarea ya no existe
-    vTaskDelete(NULL);    // Elimina la tarea una vez completada
+// Wrap a handler so its duration is recorded under `route` (handlers that
+// call each other are only counted once).
+static ArRequestHandlerFunction timed(metrics::HttpRoute route, ArRequestHandlerFunction fn) {
+    return [route, fn](AsyncWebServerRequest* request) {
+        MetricTimer timer(metrics::httpRequest[route]);
+        fn(request);
+    };
 }
 
-void handleScanWifiResults(AsyncWebServerRequest *request) {
-    if (scanRunning) {
-        // El escaneo aún está en progreso
-        request->send(202, "application/json", "{\"message\":\"Scan in progress...\"}");
-    } else if (scanComplete) {
-        // El escaneo terminó, devuelve los resultados
-        // Envía directamente la cadena JSON pre-serializada
-         AsyncResponseStream *response = request->beginResponseStream("application/json");
-         response->print(scanResultsJson); // Envía el JSON almacenado
-         request->send(response);
-        // Opcional: podrías resetear scanComplete aquí si quieres que los resultados solo se lean una vez
-        // scanComplete = false;
-    } else {
-        // No hay resultados disponibles (no se ha escaneado o ya se leyeron)
-        request->send(404, "application/json", "{\"message\":\"No scan results available. Initiate scan first using /api/wifi/scan.\"}");
-    }
+static ArJsonRequestHandlerFunction timedJson(metrics::HttpRoute route, ArJsonRequestHandlerFunction fn) {
+    return [route, fn](AsyncWebServerRequest* request, JsonVariant& json) {
+        MetricTimer timer(metrics::httpRequest[route]);
+        fn(request, json);
+    };
 }
 
-
-RestApi::RestApi(Storage& storage) : _storage(storage) {}
+RestApi::RestApi(Storage& storage, LightStore& lightStore, WifiScanService& wifiScan) :
+    _storage(storage),
+    _lightStore(lightStore),
+    _wifiScan(wifiScan) {}
 
 void RestApi::registerHandlers(AsyncWebServer& server) {
     // Light state handlers
-    server.on("/api/light", HTTP_GET, std::bind(&RestApi::handleGetLight, this, std::placeholders::_1));
+    server.on("/api/light", HTTP_GET, timed(metrics::HTTP_ROUTE_LIGHT, std::bind(&RestApi::handleGetLight, this, std::placeholders::_1)));
 
     AsyncCallbackJsonWebHandler* postLightHandler = new AsyncCallbackJsonWebHandler("/api/light",
-        [this](AsyncWebServerRequest *request, JsonVariant &json) {
+        timedJson(metrics::HTTP_ROUTE_LIGHT, [this](AsyncWebServerRequest *request, JsonVariant &json) {
             JsonObject jsonObj = json.as<JsonObject>();
             if (!jsonObj["r"].is<int>() || !jsonObj["g"].is<int>() || !jsonObj["b"].is<int>() || !jsonObj["intensity"].is<int>()) {
                 request->send(400, "application/json", "{\"error\":\"missing_field\"}");
                 return;
             }
-            r_val = jsonObj["r"];
-            g_val = jsonObj["g"];
-            b_val = jsonObj["b"];
-            intensity_val = jsonObj["intensity"];
+            // Optional on-device fade duration
+            uint32_t transitionMs = 0;
+            if (!jsonObj["transition_ms"].isNull()) {
+                if (!jsonObj["transition_ms"].is<uint32_t>() || jsonObj["transition_ms"].as<uint32_t>() > LED_TRANSITION_MAX_MS) {
+                    request->send(400, "application/json", "{\"error\":\"out_of_range\"}");
+                    return;
+                }
+                transitionMs = jsonObj["transition_ms"];
+            }
+            // Optional single segment target; the saved whole-strip state is left untouched
+            if (!jsonObj["segment"].isNull()) {
+                SegmentLayout layout;
+                ledDriver.getLayout(layout);
+                uint8_t segment = jsonObj["segment"] | 0xFF;
+                if (!jsonObj["segment"].is<uint8_t>() || segment >= layout.count
+                    || !jsonObj["r"].is<uint8_t>() || !jsonObj["g"].is<uint8_t>() || !jsonObj["b"].is<uint8_t>()
+                    || !jsonObj["intensity"].is<uint8_t>() || jsonObj["intensity"].as<uint8_t>() > INT_MAX_PCT) {
+                    request->send(400, "application/json", "{\"error\":\"out_of_range\"}");
+                    return;
+                }
+                ledDriver.setSegmentColor(segment, jsonObj["r"], jsonObj["g"], jsonObj["b"], jsonObj["intensity"], transitionMs);
+                handleGetSegments(request);
+                return;
+            }
+            int r = jsonObj["r"];
+            int g = jsonObj["g"];
+            int b = jsonObj["b"];
+            int intensity = jsonObj["intensity"];
 
-            if (r_val < 0 || r_val > 255 || g_val < 0 || g_val > 255 || b_val < 0 || b_val > 255 || intensity_val < 0 || intensity_val > 100) {
+            if (r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255 || intensity < 0 || intensity > 100) {
                 request->send(400, "application/json", "{\"error\":\"out_of_range\"}");
                 return;
             }
 
-            ledDriver.setColor(r_val, g_val, b_val, intensity_val);
-            prefs.begin("biolight", false);
-            prefs.putUChar("r", r_val);
-            prefs.putUChar("g", g_val);
-            prefs.putUChar("b", b_val);
-            prefs.putUChar("int", intensity_val);
-            prefs.end();
+            applyLight(r, g, b, intensity, transitionMs);
 
             handleGetLight(request);
-        }
+        })
     );
     server.addHandler(postLightHandler);
-
-    server.on("/api/presets", HTTP_GET, std::bind(&RestApi::handleGetPresets, this, std::placeholders::_1));
-    server.on("/api/preset/{name}", HTTP_POST, std::bind(&RestApi::handlePostPreset, this, std::placeholders::_1));
-    server.on("/api/wifi/reset", HTTP_POST, std::bind(&RestApi::handleWifiReset, this, std::placeholders::_1));
-    server.on("/api/wifi/status", HTTP_GET, std::bind(&RestApi::handleGetWifiStatus, this, std::placeholders::_1));
-    server.on("/api/wifi/scan", HTTP_GET, std::bind(&RestApi::handleGetWifiScan, this, std::placeholders::_1));
-    server.on("/api/wifi/results", HTTP_GET, handleScanWifiResults);
+    server.on("/api/segments", HTTP_GET, timed(metrics::HTTP_ROUTE_SEGMENTS, std::bind(&RestApi::handleGetSegments, this, std::placeholders::_1)));
+    AsyncCallbackJsonWebHandler* postSegmentsHandler = new AsyncCallbackJsonWebHandler("/api/segments",
+        timedJson(metrics::HTTP_ROUTE_SEGMENTS, std::bind(&RestApi::handlePostSegments, this, std::placeholders::_1, std::placeholders::_2)));
+    server.addHandler(postSegmentsHandler);
+    server.on("/api/order", HTTP_GET, timed(metrics::HTTP_ROUTE_ORDER, std::bind(&RestApi::handleGetOrder, this, std::placeholders::_1)));
+    AsyncCallbackJsonWebHandler* postOrderHandler = new AsyncCallbackJsonWebHandler("/api/order",
+        timedJson(metrics::HTTP_ROUTE_ORDER, std::bind(&RestApi::handlePostOrder, this, std::placeholders::_1, std::placeholders::_2)));
+    server.addHandler(postOrderHandler);
+    server.on("/api/persist", HTTP_GET, timed(metrics::HTTP_ROUTE_PERSIST, std::bind(&RestApi::handleGetPersistStats, this, std::placeholders::_1)));
+
+    // Keyframe programs (stop must be registered before the JSON upload handler)
+    server.on("/api/program/stop", HTTP_POST, timed(metrics::HTTP_ROUTE_PROGRAM, std::bind(&RestApi::handleStopProgram, this, std::placeholders::_1)));
+    server.on("/api/program", HTTP_GET, timed(metrics::HTTP_ROUTE_PROGRAM, std::bind(&RestApi::handleGetProgram, this, std::placeholders::_1)));
+    AsyncCallbackJsonWebHandler* postProgramHandler = new AsyncCallbackJsonWebHandler("/api/program",
+        timedJson(metrics::HTTP_ROUTE_PROGRAM, std::bind(&RestApi::handlePostProgram, this, std::placeholders::_1, std::placeholders::_2)));
+    server.addHandler(postProgramHandler);
+
+    server.on("/api/presets", HTTP_GET, timed(metrics::HTTP_ROUTE_PRESETS, std::bind(&RestApi::handleGetPresets, this, std::placeholders::_1)));
+    server.on("/api/preset/{name}", HTTP_POST, timed(metrics::HTTP_ROUTE_PRESETS, std::bind(&RestApi::handlePostPreset, this, std::placeholders::_1)));
+    server.on("/api/wifi/reset", HTTP_POST, timed(metrics::HTTP_ROUTE_WIFI, std::bind(&RestApi::handleWifiReset, this, std::placeholders::_1)));
+    server.on("/api/wifi/status", HTTP_GET, timed(metrics::HTTP_ROUTE_WIFI, std::bind(&RestApi::handleGetWifiStatus, this, std::placeholders::_1)));
+    server.on("/api/wifi/scan", HTTP_GET, timed(metrics::HTTP_ROUTE_WIFI, std::bind(&RestApi::handleGetWifiScan, this, std::placeholders::_1)));
+    server.on("/api/wifi/results", HTTP_GET, timed(metrics::HTTP_ROUTE_WIFI, std::bind(&RestApi::handleGetWifiResults, this, std::placeholders::_1)));
 
 
     AsyncCallbackJsonWebHandler* postConnectHandler = new AsyncCallbackJsonWebHandler("/api/wifi/connect",
-        std::bind(&RestApi::handlePostWifiConnect, this, std::placeholders::_1, std::placeholders::_2));
+        timedJson(metrics::HTTP_ROUTE_WIFI, std::bind(&RestApi::handlePostWifiConnect, this, std::placeholders::_1, std::placeholders::_2)));
     server.addHandler(postConnectHandler);
 
-    server.on("/api/lang", HTTP_GET, std::bind(&RestApi::handleGetLang, this, std::placeholders::_1));
+    server.on("/api/lang", HTTP_GET, timed(metrics::HTTP_ROUTE_LANG, std::bind(&RestApi::handleGetLang, this, std::placeholders::_1)));
     AsyncCallbackJsonWebHandler* postLangHandler = new AsyncCallbackJsonWebHandler("/api/lang",
-        std::bind(&RestApi::handlePostLang, this, std::placeholders::_1, std::placeholders::_2));
+        timedJson(metrics::HTTP_ROUTE_LANG, std::bind(&RestApi::handlePostLang, this, std::placeholders::_1, std::placeholders::_2)));
     server.addHandler(postLangHandler);
+
+    // Prometheus scrape target
+    server.on("/api/metrics", HTTP_GET, timed(metrics::HTTP_ROUTE_METRICS, std::bind(&RestApi::handleGetMetrics, this, std::placeholders::_1)));
+}
+
+void RestApi::applyLight(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct, uint32_t transitionMs, bool persist) {
+    r_val = r;
+    g_val = g;
+    b_val = b;
+    intensity_val = intensityPct;
+    ledDriver.setColor(r, g, b, intensityPct, transitionMs);
+    if (persist) {
+        _lightStore.update(r, g, b, intensityPct);
+    }
 }
 
 void RestApi::handleGetLight(AsyncWebServerRequest *request) {
+    // The driver's state, as /ws and /api/events send it: it follows programs too
+    uint8_t r, g, b, intensity;
+    ledDriver.getColor(r, g, b, intensity);
+
+    JsonResponse* response = new JsonResponse();
+    JsonWriter& json = response->writer();
+    json.beginObject();
+    json.field("r", (uint32_t)r);
+    json.field("g", (uint32_t)g);
+    json.field("b", (uint32_t)b);
+    json.field("intensity", (uint32_t)intensity);
+    json.endObject();
+    request->send(response);
+}
+
+void RestApi::handleGetSegments(AsyncWebServerRequest *request) {
+    SegmentLayout layout;
+    ledDriver.getLayout(layout);
+
+    JsonDocument doc;
+    doc["max_leds"] = MAX_LEDS;
+    doc["max_segments"] = MAX_SEGMENTS;
+    doc["outputs"] = LED_OUTPUT_COUNT;
+    doc["frame_us"] = parallelFrameUs(layout);
+    doc["budget_us"] = frameBudgetUs(LED_FRAME_RATE_HZ);
+    JsonArray segments = doc["segments"].to<JsonArray>();
+    for (uint8_t i = 0; i < layout.count; i++) {
+        uint8_t r, g, b, intensity;
+        ledDriver.getSegmentColor(i, r, g, b, intensity);
+        JsonObject seg = segments.add<JsonObject>();
+        seg["start"] = layout.segments[i].start;
+        seg["length"] = layout.segments[i].length;
+        seg["order"] = colorOrderName(layout.segments[i].order);
+        seg["output"] = layout.segments[i].output;
+        seg["r"] = r;
+        seg["g"] = g;
+        seg["b"] = b;
+        seg["intensity"] = intensity;
+    }
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, String("application/json"), json);
+}
+
+void RestApi::handlePostSegments(AsyncWebServerRequest *request, const JsonVariant &json) {
+    JsonArray segments = json["segments"].as<JsonArray>();
+    if (segments.isNull() || segments.size() == 0 || segments.size() > MAX_SEGMENTS) {
+        request->send(400, "application/json", "{\"error\":\"invalid_segments\"}");
+        return;
+    }
+
+    SegmentLayout layout = {};
+    for (JsonObject seg : segments) {
+        SegmentConfig& cfg = layout.segments[layout.count++];
+        if (!seg["start"].is<uint16_t>() || !seg["length"].is<uint16_t>()) {
+            request->send(400, "application/json", "{\"error\":\"missing_field\"}");
+            return;
+        }
+        cfg.start = seg["start"];
+        cfg.length = seg["length"];
+        cfg.order = ORDER_RGB;
+        int output = seg["output"] | 0;
+        if (output < 0 || output >= LED_OUTPUT_COUNT) {
+            request->send(400, "application/json", "{\"error\":\"invalid_output\"}");
+            return;
+        }
+        cfg.output = output;
+        if (seg["order"].is<const char*>() && !parseColorOrder(seg["order"], cfg.order)) {
+            request->send(400, "application/json", "{\"error\":\"invalid_order\"}");
+            return;
+        }
+    }
+    if (!isValidLayout(layout)) {
+        request->send(400, "application/json", "{\"error\":\"out_of_range\"}");
+        return;
+    }
+
+    _storage.saveSegments(layout);
+    ledDriver.setLayout(layout);
+    handleGetSegments(request);
+}
+
+void RestApi::handleGetOrder(AsyncWebServerRequest *request) {
+    SegmentLayout layout;
+    ledDriver.getLayout(layout);
+
+    JsonDocument doc;
+    JsonArray orders = doc["orders"].to<JsonArray>();
+    for (uint8_t i = 0; i < layout.count; i++) {
+        orders.add(colorOrderName(layout.segments[i].order));
+    }
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, String("application/json"), json);
+}
+
+void RestApi::handlePostOrder(AsyncWebServerRequest *request, const JsonVariant &json) {
+    uint8_t order;
+    if (!json["order"].is<const char*>() || !parseColorOrder(json["order"], order)) {
+        request->send(400, "application/json", "{\"error\":\"invalid_order\"}");
+        return;
+    }
+
+    SegmentLayout layout;
+    ledDriver.getLayout(layout);
+    if (json["segment"].is<uint8_t>()) {
+        uint8_t segment = json["segment"];
+        if (segment >= layout.count) {
+            request->send(400, "application/json", "{\"error\":\"invalid_segment\"}");
+            return;
+        }
+        layout.segments[segment].order = order;
+    } else {
+        for (uint8_t i = 0; i < layout.count; i++) {
+            layout.segments[i].order = order;
+        }
+    }
+
+    _storage.saveSegments(layout);
+    ledDriver.setLayout(layout);
+    handleGetOrder(request);
+}
+
+void RestApi::handleGetPersistStats(AsyncWebServerRequest *request) {
     JsonDocument doc;
-    doc["r"] = r_val;
-    doc["g"] = g_val;
-    doc["b"] = b_val;
-    doc["intensity"] = intensity_val;
+    doc["pending"] = _lightStore.isPending();
+    doc["quiet_ms"] = _lightStore.quietPeriod();
+    doc["updates"] = _lightStore.updateCount();
+    doc["coalesced"] = _lightStore.coalescedCount();
+    doc["committed"] = _lightStore.commitCount();
 
     String json;
     serializeJson(doc, json);
     request->send(200, String("application/json"), json);
 }
 
+static bool parseEasing(const char* name, Easing& easing) {
+    static const char* const NAMES[EASE_COUNT] = { "linear", "in", "out", "in_out" };
+    for (uint8_t i = 0; i < EASE_COUNT; i++) {
+        if (strcmp(name, NAMES[i]) == 0) {
+            easing = (Easing)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RestApi::handleGetProgram(AsyncWebServerRequest *request) {
+    char name[PROGRAM_NAME_LEN];
+    ledDriver.getProgramName(name, sizeof(name));
+
+    JsonDocument doc;
+    doc["running"] = ledDriver.isProgramRunning();
+    doc["name"] = name;
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, String("application/json"), json);
+}
+
+void RestApi::handlePostProgram(AsyncWebServerRequest *request, const JsonVariant &json) {
+    JsonObject jsonObj = json.as<JsonObject>();
+    const char* name = jsonObj["name"] | "";
+    if (!isValidProgramName(name)) {
+        request->send(400, "application/json", "{\"error\":\"invalid_name\"}");
+        return;
+    }
+
+    static Program program; // Too large for the async_tcp stack; handlers run one at a time
+    memset(&program, 0, sizeof(program));
+
+    // Without frames the request just plays an already stored program
+    if (jsonObj["frames"].isNull()) {
+        if (!loadProgram(name, program)) {
+            request->send(404, "application/json", "{\"error\":\"program_not_found\"}");
+            return;
+        }
+        ledDriver.playProgram(program);
+        request->send(200, "application/json", "{\"success\":true}");
+        return;
+    }
+
+    JsonArray frames = jsonObj["frames"].as<JsonArray>();
+    if (frames.isNull() || frames.size() == 0 || frames.size() > PROGRAM_MAX_KEYFRAMES) {
+        request->send(400, "application/json", "{\"error\":\"invalid_frames\"}");
+        return;
+    }
+
+    const char* next = jsonObj["next"] | "";
+    if (next[0] != '\0' && !isValidProgramName(next)) {
+        request->send(400, "application/json", "{\"error\":\"invalid_next\"}");
+        return;
+    }
+
+    strncpy(program.name, name, PROGRAM_NAME_LEN - 1);
+    strncpy(program.next, next, PROGRAM_NAME_LEN - 1);
+    program.flags = (jsonObj["loop"] | false) ? PROGRAM_FLAG_LOOP : 0;
+
+    for (JsonObject frame : frames) {
+        if (!frame["r"].is<uint8_t>() || !frame["g"].is<uint8_t>() || !frame["b"].is<uint8_t>()
+            || !frame["intensity"].is<uint8_t>() || frame["intensity"].as<uint8_t>() > INT_MAX_PCT) {
+            request->send(400, "application/json", "{\"error\":\"out_of_range\"}");
+            return;
+        }
+        KeyFrame& kf = program.frames[program.count++];
+        kf.state.r = frame["r"];
+        kf.state.g = frame["g"];
+        kf.state.b = frame["b"];
+        kf.state.intensity = frame["intensity"];
+        kf.holdMs = frame["hold_ms"] | 0u;
+        kf.fadeMs = frame["fade_ms"] | 0u;
+        kf.easing = EASE_LINEAR;
+        if (kf.fadeMs > PROGRAM_MAX_FADE_MS
+            || (frame["easing"].is<const char*>() && !parseEasing(frame["easing"], kf.easing))) {
+            request->send(400, "application/json", "{\"error\":\"out_of_range\"}");
+            return;
+        }
+    }
+
+    if (!saveProgram(program)) {
+        request->send(500, "application/json", "{\"error\":\"storage_failed\"}");
+        return;
+    }
+
+    bool play = jsonObj["play"] | true;
+    if (play) {
+        ledDriver.playProgram(program);
+    }
+
+    JsonDocument doc;
+    doc["name"] = name;
+    doc["frames"] = program.count;
+    doc["bytes"] = PROGRAM_HEADER_SIZE + program.count * PROGRAM_KEYFRAME_SIZE;
+    doc["playing"] = play;
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void RestApi::handleStopProgram(AsyncWebServerRequest *request) {
+    ledDriver.stopProgram();
+    request->send(200, "application/json", "{\"success\":true}");
+}
+
 void RestApi::handlePostWifiConnect(AsyncWebServerRequest *request, const JsonVariant &json) {
     JsonObject jsonObj = json.as<JsonObject>();
     if (!jsonObj["ssid"].is<String>()) {
@@ -208,30 +440,38 @@ void RestApi::handlePostLang(AsyncWebServerRequest *request, const JsonVariant &
 }
 
 void RestApi::handleGetWifiScan(AsyncWebServerRequest *request) {
-    if (scanRunning) {
-        // Ya hay un escaneo en progreso
-        request->send(429, "application/json", "{\"message\":\"Scan already in progress\"}");
-        return;
+    bool force = false;
+    if (request->hasParam("force")) {
+        const String& value = request->getParam("force")->value();
+        force = value == "1" || value == "true";
     }
 
-    // Inicia la tarea de escaneo en el núcleo 0 (o 1 si prefieres) con prioridad 1
-    xTaskCreatePinnedToCore(
-        wifiScanTask,       /* Función de la Tarea */
-        "wifiScanTask",     /* Nombre de la Tarea */
-        4096,               /* Tamaño de la pila (ajusta si es necesario) */
-        NULL,               /* Parámetro de la tarea */
-        1,                  /* Prioridad (baja) */
-        &scanTaskHandle,    /* Handle de la tarea */
-        0);                 /* Núcleo donde se ejecutará (0 o 1) */
-
-    if (scanTaskHandle == NULL) {
-         log_e("Error al crear la tarea de escaneo WiFi");
-         request->send(500, "application/json", "{\"message\":\"Failed to start scan task\"}");
-         return;
+    switch (_wifiScan.request(force)) {
+        case WifiScanService::Request::CACHED:
+            request->send(200, "application/json", "{\"message\":\"Cached results available at /api/wifi/results\"}");
+            break;
+        case WifiScanService::Request::STARTED:
+        case WifiScanService::Request::RUNNING:
+            request->send(202, "application/json", "{\"message\":\"Scan initiated. Check /api/wifi/results later.\"}");
+            break;
+        case WifiScanService::Request::FAILED:
+            request->send(500, "application/json", "{\"message\":\"Failed to start scan\"}");
+            break;
     }
+}
+
+void RestApi::handleGetWifiResults(AsyncWebServerRequest *request) {
+    if (_wifiScan.isRunning()) {
+        request->send(202, "application/json", "{\"message\":\"Scan in progress...\"}");
+    } else if (_wifiScan.hasResults()) {
+        request->send(new ScanResultsResponse(_wifiScan));
+    } else {
+        request->send(404, "application/json", "{\"message\":\"No scan results available. Initiate scan first using /api/wifi/scan.\"}");
+    }
+}
 
-    // Responde inmediatamente indicando que el escaneo ha comenzado
-    request->send(202, "application/json", "{\"message\":\"Scan initiated. Check /api/wifi/results later.\"}");
+void RestApi::handleGetMetrics(AsyncWebServerRequest *request) {
+    request->send(new MetricsResponse());
 }
 
 void RestApi::handleGetPresets(AsyncWebServerRequest *request) {
@@ -262,12 +502,7 @@ void RestApi::handlePostPreset(AsyncWebServerRequest *request) {
 
     intensity_val = 100;
     ledDriver.setColor(r_val, g_val, b_val, intensity_val);
-    prefs.begin("biolight", false);
-    prefs.putUChar("r", r_val);
-    prefs.putUChar("g", g_val);
-    prefs.putUChar("b", b_val);
-    prefs.putUChar("int", intensity_val);
-    prefs.end();
+    _lightStore.update(r_val, g_val, b_val, intensity_val);
 
     handleGetLight(request);
 }
@@ -278,48 +513,67 @@ void RestApi::handleWifiReset(AsyncWebServerRequest *request) {
 }
 
 void RestApi::handleGetWifiStatus(AsyncWebServerRequest *request) {
-    JsonDocument doc;
+    JsonResponse* response = new JsonResponse();
+    writeWifiStatus(response->writer());
+    request->send(response);
+}
+
+static void writeIp(JsonWriter& json, const IPAddress& ip) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    json.field("ip", buf);
+}
+
+void RestApi::writeWifiStatus(JsonWriter& json) {
+    // SSIDs are read from the driver so that no String is built
+    char ssid[33] = "";
     wl_status_t status = WiFi.status();
 
+    json.beginObject();
     if (WiFi.getMode() == WIFI_AP || WiFi.getMode() == WIFI_AP_STA) {
-        doc["mode"] = "AP";
-        doc["status"] = "connected"; // AP is always 'connected' to itself
-        doc["ssid"] = WiFi.softAPSSID();
-        doc["ip"] = WiFi.softAPIP().toString();
-        doc["rssi"] = -1; // Not applicable
+        wifi_config_t conf;
+        if (esp_wifi_get_config(WIFI_IF_AP, &conf) == ESP_OK) {
+            size_t len = conf.ap.ssid_len ? conf.ap.ssid_len : strnlen((const char*)conf.ap.ssid, 32);
+            memcpy(ssid, conf.ap.ssid, len < 32 ? len : 32);
+            ssid[len < 32 ? len : 32] = '\0';
+        }
+        json.field("mode", "AP");
+        json.field("status", "connected"); // AP is always 'connected' to itself
+        json.field("ssid", ssid);
+        writeIp(json, WiFi.softAPIP());
+        json.field("rssi", (int32_t)-1); // Not applicable
     } else { // STA mode or OFF
-        doc["mode"] = "STA";
+        json.field("mode", "STA");
         switch (status) {
             case WL_IDLE_STATUS:
             case WL_DISCONNECTED:
-                doc["status"] = "disconnected";
+                json.field("status", "disconnected");
                 break;
             case WL_SCAN_COMPLETED: // Intermediate state
             case WL_CONNECT_FAILED:
             case WL_CONNECTION_LOST:
             case WL_NO_SSID_AVAIL:
-                doc["status"] = "disconnected";
+                json.field("status", "disconnected");
                 break;
             case WL_CONNECTED:
-                doc["status"] = "connected";
+                json.field("status", "connected");
                 break;
             default: // Other states are considered "connecting"
-                doc["status"] = "connecting";
+                json.field("status", "connecting");
                 break;
         }
 
-        if (status == WL_CONNECTED) {
-            doc["ssid"] = WiFi.SSID();
-            doc["ip"] = WiFi.localIP().toString();
-            doc["rssi"] = WiFi.RSSI();
+        wifi_ap_record_t info;
+        if (status == WL_CONNECTED && esp_wifi_sta_get_ap_info(&info) == ESP_OK) {
+            strncpy(ssid, (const char*)info.ssid, sizeof(ssid) - 1);
+            json.field("ssid", ssid);
+            writeIp(json, WiFi.localIP());
+            json.field("rssi", (int32_t)info.rssi);
         } else {
-            doc["ssid"] = "";
-            doc["ip"] = "0.0.0.0";
-            doc["rssi"] = 0;
+            json.field("ssid", "");
+            json.field("ip", "0.0.0.0");
+            json.field("rssi", (int32_t)0);
         }
     }
-
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    json.endObject();
 }
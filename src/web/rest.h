@@ -4,24 +4,51 @@
 #include <ArduinoJson.h>
 #include "../drivers/led_driver.h"
 #include "../drivers/storage.h"
+#include "../drivers/light_store.h"
+#include "wifi_scan.h"
 
 // Forward declaration
 class AsyncWebServer;
 
 class RestApi {
 public:
-    RestApi(Storage& storage);
+    RestApi(Storage& storage, LightStore& lightStore, WifiScanService& wifiScan);
     void registerHandlers(AsyncWebServer& server);
 
+    // Sets the whole-strip color (as POST /api/light does) and, unless
+    // `persist` is false, queues it for NVS.
+    void applyLight(uint8_t r, uint8_t g, uint8_t b, uint8_t intensityPct, uint32_t transitionMs, bool persist = true);
+
+    // Writes the body of GET /api/wifi/status.
+    void writeWifiStatus(class JsonWriter& json);
+
+    WifiScanService& wifiScan() { return _wifiScan; }
+
 private:
     Storage& _storage;
-    String _scan_cache;
-    unsigned long _last_scan_ms = 0;
+    LightStore& _lightStore;
+    WifiScanService& _wifiScan;
 
     // Handlers for /api/light
     void handleGetLight(class AsyncWebServerRequest *request);
     void handlePostLight(class AsyncWebServerRequest *request, struct ArBodyHandler* handler);
 
+    // Handlers for /api/segments
+    void handleGetSegments(class AsyncWebServerRequest *request);
+    void handlePostSegments(class AsyncWebServerRequest *request, const JsonVariant &json);
+
+    // Handlers for /api/order
+    void handleGetOrder(class AsyncWebServerRequest *request);
+    void handlePostOrder(class AsyncWebServerRequest *request, const JsonVariant &json);
+
+    // Handler for /api/persist
+    void handleGetPersistStats(class AsyncWebServerRequest *request);
+
+    // Handlers for /api/program
+    void handleGetProgram(class AsyncWebServerRequest *request);
+    void handlePostProgram(class AsyncWebServerRequest *request, const JsonVariant &json);
+    void handleStopProgram(class AsyncWebServerRequest *request);
+
     // Handlers for /api/presets
     void handleGetPresets(class AsyncWebServerRequest *request);
     void handlePostPreset(class AsyncWebServerRequest *request);
@@ -32,12 +59,16 @@ private:
     // Handler for /api/wifi/status
     void handleGetWifiStatus(class AsyncWebServerRequest *request);
 
-    // Handler for /api/wifi/scan
+    // Handlers for /api/wifi/scan and /api/wifi/results
     void handleGetWifiScan(class AsyncWebServerRequest *request);
+    void handleGetWifiResults(class AsyncWebServerRequest *request);
 
     // Handler for /api/wifi/connect
     void handlePostWifiConnect(class AsyncWebServerRequest *request, const JsonVariant &json);
 
+    // Handler for /api/metrics (Prometheus text format)
+    void handleGetMetrics(class AsyncWebServerRequest *request);
+
     // Handlers for /api/lang
     void handleGetLang(class AsyncWebServerRequest *request);
     void handlePostLang(class AsyncWebServerRequest *request, const JsonVariant &json);
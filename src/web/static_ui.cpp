@@ -0,0 +1,32 @@
+#include "static_ui.h"
+
+bool StaticUiHandler::canHandle(AsyncWebServerRequest* request) {
+    if (!(request->method() & (HTTP_GET | HTTP_HEAD)) || !find(request->url())) {
+        return false;
+    }
+    request->addInterestingHeader("If-None-Match");
+    return true;
+}
+
+void StaticUiHandler::handleRequest(AsyncWebServerRequest* request) {
+    const UiAsset* asset = find(request->url());
+
+    AsyncWebServerResponse* response;
+    if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == asset->etag) {
+        response = request->beginResponse(304);
+    } else {
+        response = request->beginResponse_P(200, asset->contentType, asset->data, asset->length);
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    // Browsers revalidate on every load; an unchanged asset costs one 304.
+    response->addHeader("ETag", asset->etag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+const UiAsset* StaticUiHandler::find(const String& url) {
+    const char* name = url.c_str();
+    if (*name == '/') name++;
+    if (*name == '\0') name = "index.html";
+    return findUiAsset(name);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include "ui_bundle.h"
+
+// Serves the UI bundle linked into the firmware (see ui_bundle.h).
+//
+// Responses are slices of the const blob in flash, sent without copying,
+// with Content-Encoding: gzip and a strong ETag; a matching If-None-Match
+// is answered with 304 and no body. Unknown paths fall through to the next
+// handler.
+class StaticUiHandler : public AsyncWebHandler {
+public:
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    bool isRequestHandlerTrivial() override { return true; }
+
+private:
+    static const UiAsset* find(const String& url);
+};
@@ -0,0 +1,21 @@
+#include "ui_bundle.h"
+#include <string.h>
+
+#if __has_include("ui_bundle_data.h")
+#include "ui_bundle_data.h" // UI_BLOB, UI_ASSETS, UI_ASSET_COUNT
+#else
+static const UiAsset* const UI_ASSETS = nullptr;
+#define UI_ASSET_COUNT 0
+#endif
+
+size_t uiAssetCount() {
+    return UI_ASSET_COUNT;
+}
+
+const UiAsset* findUiAsset(const char* name) {
+    // Not UI_ASSET_COUNT: without the generated header "i < 0" warns (-Wtype-limits)
+    for (size_t i = 0; i < uiAssetCount(); i++) {
+        if (strcmp(UI_ASSETS[i].name, name) == 0) return &UI_ASSETS[i];
+    }
+    return nullptr;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One gzip-compressed web UI file linked into the firmware. `data` points
+// into a const blob in flash and can be sent as-is.
+struct UiAsset {
+    const char* name;        // Path below the web root, e.g. "app.js"
+    const char* contentType;
+    const char* etag;        // Quoted strong ETag
+    const uint8_t* data;
+    uint32_t length;
+};
+
+// Embedded assets, generated by tools/compress_ui.py. Empty when the
+// firmware was built without the script.
+size_t uiAssetCount();
+const UiAsset* findUiAsset(const char* name);
@@ -1,24 +1,68 @@
 #include "web_server.h"
 #include <ESPAsyncWebServer.h>
 #include <LittleFS.h>
+#include <WiFi.h>
+#include <atomic>
+#include "../config.h"
+#include "json_writer.h"
+#include "static_ui.h"
+
+extern LedDriver ledDriver;
+
+// WiFi stack events since boot, counted from the event task
+static std::atomic<uint32_t> wifiEvents{0};
+
+static void onWifiEvent(WiFiEvent_t event) {
+    (void)event;
+    wifiEvents.fetch_add(1, std::memory_order_relaxed);
+}
 
 WebServer::WebServer(RestApi& restApi) :
     _restApi(restApi),
-    _server(new AsyncWebServer(80)) {}
+    _server(new AsyncWebServer(80)),
+    _ws(new AsyncWebSocket(WS_PATH)),
+    _events(new AsyncEventSource(EVENTS_PATH)) {}
 
 void WebServer::begin() {
-    // Initialize LittleFS
-    if (!LittleFS.begin()) {
+    // Initialize LittleFS (keyframe programs; UI only if not built into the firmware)
+    bool fsMounted = LittleFS.begin();
+    if (!fsMounted) {
         Serial.println("An Error has occurred while mounting LittleFS");
-        return;
     }
 
     // Register all API handlers
     _restApi.registerHandlers(*_server);
 
-    // Serve static files from the /ui_web directory
-    // The path on the server will be the root, e.g., /index.html
-    _server->serveStatic("/", LittleFS, "/ui_web/").setDefaultFile("index.html");
+    // Connection changes are pushed from the WiFi events, not polled
+    WiFi.onEvent(onWifiEvent);
+
+    // Live control channel
+    _ws->onEvent(std::bind(&WebServer::handleSocketEvent, this,
+        std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
+        std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+    _server->addHandler(_ws.get());
+
+    // Server-Sent Events for dashboards; a (re)connecting client gets the full state
+    _events->onConnect([this](AsyncEventSourceClient* client) {
+        char light[LIGHT_JSON_LEN];
+        lightJson(light, sizeof(light));
+        client->send(light, "light", millis());
+        char wifi[WIFI_JSON_LEN];
+        if (wifiStatusJson(wifi, sizeof(wifi))) {
+            client->send(wifi, "wifi", millis());
+        }
+    });
+    _server->addHandler(_events.get());
+
+    // Web UI: the gzip bundle linked into the firmware, or plain files
+    // from LittleFS when built without tools/compress_ui.py
+    if (uiAssetCount() > 0) {
+        _server->addHandler(new StaticUiHandler());
+    } else if (fsMounted) {
+        // Serve static files from the /ui_web directory
+        // The path on the server will be the root, e.g., /index.html
+        _server->serveStatic("/", LittleFS, "/ui_web/").setDefaultFile("index.html");
+    }
 
     // --- Captive Portal and Network Config Handlers ---
     // Android sends /generate_204 for captive portal detection.
@@ -53,3 +97,103 @@ void WebServer::begin() {
     _server->begin();
     Serial.println("Web server started.");
 }
+
+void WebServer::loop() {
+    unsigned long now = millis();
+    if (now - _lastCleanupMs >= WS_CLEANUP_MS) {
+        _lastCleanupMs = now;
+        _ws->cleanupClients();
+    }
+
+    // Each source counts its own changes; nothing is serialized until one moves
+    uint32_t lightChanges = ledDriver.colorChangeCount();
+    uint32_t scans = _restApi.wifiScan().completedCount();
+    uint32_t wifiChanges = wifiEvents.load(std::memory_order_relaxed);
+    bool lightChanged = lightChanges != _sentLightChanges;
+    bool scanChanged = scans != _sentScans;
+    bool wifiChanged = wifiChanges != _sentWifiEvents;
+    if (!lightChanged && !scanChanged && !wifiChanged) return;
+    _sentLightChanges = lightChanges;
+    _sentScans = scans;
+    _sentWifiEvents = wifiChanges;
+
+    if (_ws->count() == 0 && _events->count() == 0) {
+        _sentWifi[0] = '\0'; // New clients get the full state on connect
+        return;
+    }
+
+    if (lightChanged) {
+        sendLight(nullptr);
+        char json[LIGHT_JSON_LEN];
+        lightJson(json, sizeof(json));
+        _events->send(json, "light", now);
+    }
+
+    if (scanChanged) {
+        char results[SCAN_JSON_LEN];
+        _restApi.wifiScan().writeJson(results, sizeof(results));
+        _events->send(results, "scan", now);
+    }
+
+    if (wifiChanged) {
+        // Several events (start, connected, got IP) may leave the status as it was
+        char wifi[WIFI_JSON_LEN];
+        size_t len = wifiStatusJson(wifi, sizeof(wifi));
+        if (len && strcmp(wifi, _sentWifi) != 0) {
+            _ws->textAll(wifi, len);
+            _events->send(wifi, "wifi", now);
+            memcpy(_sentWifi, wifi, len + 1);
+        }
+    }
+}
+
+void WebServer::handleSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    if (type == WS_EVT_CONNECT) {
+        // New clients get the full state right away
+        sendLight(client);
+        char wifi[WIFI_JSON_LEN];
+        size_t wifiLen = wifiStatusJson(wifi, sizeof(wifi));
+        if (wifiLen) client->text(wifi, wifiLen);
+        return;
+    }
+    if (type != WS_EVT_DATA) return;
+
+    AwsFrameInfo* info = (AwsFrameInfo*)arg;
+    if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_BINARY || len != 5) {
+        return; // Only whole 5-byte binary frames are commands
+    }
+    if (data[3] > INT_MAX_PCT) return;
+
+    uint8_t flags = data[4];
+    _restApi.applyLight(data[0], data[1], data[2], data[3],
+                        (flags & WS_FLAG_FADE) ? WS_FADE_MS : 0,
+                        !(flags & WS_FLAG_PREVIEW));
+}
+
+void WebServer::sendLight(AsyncWebSocketClient* client) {
+    uint8_t frame[5];
+    ledDriver.getColor(frame[0], frame[1], frame[2], frame[3]);
+    frame[4] = 0;
+    if (client) {
+        client->binary(frame, sizeof(frame));
+    } else {
+        _ws->binaryAll(frame, sizeof(frame));
+    }
+}
+
+size_t WebServer::wifiStatusJson(char* buf, size_t len) {
+    JsonWriter json(buf, len);
+    _restApi.writeWifiStatus(json);
+    if (json.overflowed()) {
+        buf[0] = '\0'; // Never push truncated JSON
+        return 0;
+    }
+    return json.length();
+}
+
+void WebServer::lightJson(char* buf, size_t len) {
+    uint8_t r, g, b, intensity;
+    ledDriver.getColor(r, g, b, intensity);
+    snprintf(buf, len, "{\"r\":%u,\"g\":%u,\"b\":%u,\"intensity\":%u}",
+             (unsigned)r, (unsigned)g, (unsigned)b, (unsigned)intensity);
+}
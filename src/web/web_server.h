@@ -3,15 +3,45 @@
 #include <memory>
 #include "rest.h"
 
-// Forward declaration
+// Forward declarations
 class AsyncWebServer;
+class AsyncWebSocket;
+class AsyncWebSocketClient;
+class AsyncEventSource;
+
+// Flags byte of the 5-byte binary WebSocket frame (r, g, b, intensity, flags)
+#define WS_FLAG_FADE    0x01 // Fade over WS_FADE_MS instead of jumping
+#define WS_FLAG_PREVIEW 0x02 // Show but do not persist (e.g. slider still moving)
 
 class WebServer {
 public:
     WebServer(RestApi& restApi);
     void begin();
 
+    // Pushes light, WiFi and scan changes to WebSocket and event stream
+    // clients. Call from loop(); it only serializes anything when one of the
+    // change counters (LedDriver, WifiScanService, WiFi events) has moved.
+    void loop();
+
 private:
+    static constexpr size_t WIFI_JSON_LEN = 192;
+    static constexpr size_t SCAN_JSON_LEN = 1536; // Weakest networks are dropped beyond this
+
     RestApi& _restApi;
     std::unique_ptr<AsyncWebServer> _server;
-};
\ No newline at end of file
+    std::unique_ptr<AsyncWebSocket> _ws;
+    std::unique_ptr<AsyncEventSource> _events;
+
+    uint32_t _sentLightChanges = 0;
+    uint32_t _sentScans = 0;
+    uint32_t _sentWifiEvents = 0;
+    char _sentWifi[WIFI_JSON_LEN] = "";
+    unsigned long _lastCleanupMs = 0;
+
+    void handleSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    void sendLight(AsyncWebSocketClient* client);
+    size_t wifiStatusJson(char* buf, size_t len);
+
+    static constexpr size_t LIGHT_JSON_LEN = 64;
+    static void lightJson(char* buf, size_t len);
+};
@@ -0,0 +1,124 @@
+#include "wifi_scan.h"
+#include "json_writer.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string.h>
+
+bool ScanResults::insert(const ScanEntry& entry) {
+    if (entry.ssid[0] == '\0') return false; // Hidden network
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(entries[i].ssid, entry.ssid) == 0) {
+            if (entries[i].rssi >= entry.rssi) return false;
+            // Stronger access point of a known network: remove the old one
+            memmove(&entries[i], &entries[i + 1], (count - i - 1) * sizeof(ScanEntry));
+            count--;
+            break;
+        }
+    }
+
+    uint8_t pos = count;
+    while (pos > 0 && entries[pos - 1].rssi < entry.rssi) pos--;
+    if (pos >= WIFI_SCAN_MAX_RESULTS) return false;
+
+    uint8_t last = count < WIFI_SCAN_MAX_RESULTS ? count : WIFI_SCAN_MAX_RESULTS - 1;
+    memmove(&entries[pos + 1], &entries[pos], (last - pos) * sizeof(ScanEntry));
+    entries[pos] = entry;
+    if (count < WIFI_SCAN_MAX_RESULTS) count++;
+    return true;
+}
+
+void ScanResults::writeEntry(JsonWriter& json, const ScanEntry& entry) {
+    json.beginObject();
+    json.field("ssid", entry.ssid);
+    json.field("rssi", (int32_t)entry.rssi);
+    json.field("channel", (uint32_t)entry.channel);
+    json.field("secure", entry.secure);
+    json.endObject();
+}
+
+WifiScanService::WifiScanService(uint32_t ttlMs) :
+    _ttlMs(ttlMs) {}
+
+WifiScanService::Request WifiScanService::request(bool force) {
+    portENTER_CRITICAL(&_mux);
+    if (_running || _starting) {
+        portEXIT_CRITICAL(&_mux);
+        return Request::RUNNING;
+    }
+    if (!force && _completed > 0 && millis() - _completedAtMs < _ttlMs) {
+        portEXIT_CRITICAL(&_mux);
+        return Request::CACHED;
+    }
+    _starting = true;
+    portEXIT_CRITICAL(&_mux);
+
+    // Returns at once; loop() picks up the results
+    bool started = WiFi.scanNetworks(true) != WIFI_SCAN_FAILED;
+
+    portENTER_CRITICAL(&_mux);
+    _running = started;
+    _starting = false;
+    portEXIT_CRITICAL(&_mux);
+    return started ? Request::STARTED : Request::FAILED;
+}
+
+void WifiScanService::loop() {
+    if (!_running) return;
+
+    int16_t n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return;
+    if (n < 0) {
+        // Scan aborted by the driver; keep the previous results
+        _running = false;
+        return;
+    }
+
+    // Sorted outside the lock; readers keep seeing the previous results
+    ScanResults fresh = {};
+    for (int16_t i = 0; i < n; i++) {
+        ScanEntry entry;
+        strncpy(entry.ssid, WiFi.SSID(i).c_str(), sizeof(entry.ssid) - 1);
+        entry.ssid[sizeof(entry.ssid) - 1] = '\0';
+        entry.rssi = (int8_t)WiFi.RSSI(i);
+        entry.channel = (uint8_t)WiFi.channel(i);
+        entry.secure = WiFi.encryptionType(i) != WIFI_AUTH_OPEN;
+        fresh.insert(entry);
+    }
+    WiFi.scanDelete();
+    log_i("WiFi scan done: %d networks, %u kept", n, (unsigned)fresh.count);
+
+    portENTER_CRITICAL(&_mux);
+    memcpy(&_results, &fresh, sizeof(_results));
+    _completedAtMs = millis();
+    _completed++;
+    _running = false;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void WifiScanService::snapshot(ScanResults& out) {
+    portENTER_CRITICAL(&_mux);
+    memcpy(&out, &_results, sizeof(out));
+    portEXIT_CRITICAL(&_mux);
+}
+
+size_t WifiScanService::writeJson(char* buf, size_t len) {
+    ScanResults results;
+    snapshot(results);
+
+    // Whole entries only, so the array is always valid JSON
+    size_t used = snprintf(buf, len, "[");
+    for (uint8_t i = 0; i < results.count; i++) {
+        char entry[ScanResults::ENTRY_JSON_LEN];
+        JsonWriter json(entry, sizeof(entry));
+        ScanResults::writeEntry(json, results.entries[i]);
+        size_t needed = json.length() + (i > 0 ? 1 : 0) + 2; // comma, "]" and NUL
+        if (json.overflowed() || used + needed > len) break;
+        if (i > 0) buf[used++] = ',';
+        memcpy(buf + used, entry, json.length());
+        used += json.length();
+    }
+    buf[used++] = ']';
+    buf[used] = '\0';
+    return used;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include "../config.h"
+
+class JsonWriter;
+
+struct ScanEntry {
+    char ssid[33];
+    int8_t rssi;
+    uint8_t channel;
+    bool secure;
+};
+
+// Fixed-capacity list of scanned networks, strongest first. Duplicate SSIDs
+// (several access points of one network) keep only the strongest entry.
+struct ScanResults {
+    static constexpr size_t ENTRY_JSON_LEN = 256; // Longest escaped entry
+
+    uint8_t count;
+    ScanEntry entries[WIFI_SCAN_MAX_RESULTS];
+
+    void clear() { count = 0; }
+    // Inserts in RSSI order; returns false if it was dropped as a duplicate,
+    // hidden network or weaker than a full list.
+    bool insert(const ScanEntry& entry);
+    // Writes one entry as a JSON object.
+    static void writeEntry(JsonWriter& json, const ScanEntry& entry);
+};
+
+// Asynchronous WiFi scan with a TTL cache.
+//
+// request() may be called from any task, including web handlers: it starts
+// a non-blocking scan (or joins the one running) unless the cached results
+// are still fresh. loop() collects the results once the radio is done.
+class WifiScanService {
+public:
+    enum class Request { STARTED, RUNNING, CACHED, FAILED };
+
+    explicit WifiScanService(uint32_t ttlMs = WIFI_SCAN_TTL_MS);
+
+    Request request(bool force);
+    void loop();
+
+    bool isRunning() const { return _running; }
+    bool hasResults() const { return _completed > 0; }
+    // Completed scans since boot; changes whenever new results are ready.
+    uint32_t completedCount() const { return _completed; }
+
+    // Consistent copy of the latest results.
+    void snapshot(ScanResults& out);
+
+    // Writes the latest results as a JSON array into `buf`, dropping the
+    // weakest networks if they do not fit. Returns the length.
+    size_t writeJson(char* buf, size_t len);
+
+private:
+    uint32_t _ttlMs;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    ScanResults _results = {};
+    volatile bool _starting = false;
+    volatile bool _running = false;
+    volatile uint32_t _completed = 0;
+    uint32_t _completedAtMs = 0;
+};
@@ -0,0 +1,246 @@
+// Heap allocations of the JSON response path: pio test -e native
+//
+// malloc, calloc and realloc are interposed (operator new goes through
+// malloc in libstdc++) and counted while `tracking` is set. The response
+// object itself is allocated by the web server, as every AsyncWebServer
+// response is; what is measured is everything a request costs on top of
+// that. GET requests go through the real REST handlers with hostHandle(),
+// and are compared with a server that replays the same body from memory.
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include <WiFi.h>
+#include "../../src/web/rest.h"
+#include "../../src/web/json_response.h"
+#include "../../src/web/json_writer.h"
+#include "../../src/web/wifi_scan.h"
+
+extern RestApi restApi;
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static thread_local bool tracking = false;
+static thread_local uint32_t allocations = 0;
+
+extern "C" void* malloc(size_t size) {
+    if (tracking) allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    if (tracking) allocations++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (tracking) allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+static void startCounting() {
+    allocations = 0;
+    tracking = true;
+}
+
+static uint32_t stopCounting() {
+    tracking = false;
+    return allocations;
+}
+
+// What the web server's own response base costs: the content type String.
+struct BareResponse : public AsyncAbstractResponse {
+    BareResponse() {
+        _code = 200;
+        _contentType = "application/json";
+    }
+};
+
+static uint32_t baseResponseAllocations() {
+    alignas(BareResponse) static uint8_t storage[sizeof(BareResponse)];
+    startCounting();
+    BareResponse* response = new (storage) BareResponse();
+    uint32_t count = stopCounting();
+    response->~BareResponse();
+    return count;
+}
+
+// Serves a fixed body with the status, content type and length of a
+// JsonResponse: what the web server costs for a response that needs no work.
+class ReplayResponse : public AsyncAbstractResponse {
+public:
+    explicit ReplayResponse(const char* body) : _body(body) {
+        _code = 200;
+        _contentType = "application/json";
+        _contentLength = strlen(body);
+    }
+
+    bool _sourceValid() const override { return true; }
+    size_t _fillBuffer(uint8_t* buf, size_t maxLen) override {
+        size_t n = _contentLength - _sent;
+        if (n > maxLen) n = maxLen;
+        memcpy(buf, _body + _sent, n);
+        _sent += n;
+        return n;
+    }
+
+private:
+    const char* _body;
+    size_t _sent = 0;
+};
+
+// A server with the firmware's REST handlers, as bench/fixture.cpp sets up.
+static AsyncWebServer& apiServer() {
+    static AsyncWebServer* server = nullptr;
+    if (!server) {
+        server = new AsyncWebServer(80);
+        restApi.registerHandlers(*server);
+    }
+    return *server;
+}
+
+// Body of the last assertGetAddsNoAllocations() request
+static char body[JsonResponse::CAPACITY + 1];
+
+// Runs GET `url` through the REST handlers and checks it allocates no more
+// than replaying its body does.
+static void assertGetAddsNoAllocations(const char* url) {
+    // The first request may set up statics; its body is the one replayed
+    AsyncWebServerRequest first(HTTP_GET, url);
+    apiServer().hostHandle(first);
+    TEST_ASSERT_EQUAL_INT(200, first.hostResponseCode());
+    TEST_ASSERT_TRUE(first.hostResponseBody().length() < sizeof(body));
+    strcpy(body, first.hostResponseBody().c_str());
+
+    AsyncWebServer replay(80);
+    replay.on(url, HTTP_GET, [](AsyncWebServerRequest* request) { request->send(new ReplayResponse(body)); });
+    AsyncWebServerRequest replayed(HTTP_GET, url);
+    startCounting();
+    replay.hostHandle(replayed);
+    uint32_t base = stopCounting();
+
+    AsyncWebServerRequest request(HTTP_GET, url);
+    startCounting();
+    apiServer().hostHandle(request);
+    uint32_t count = stopCounting();
+
+    TEST_ASSERT_EQUAL_UINT32(base, count);
+    TEST_ASSERT_EQUAL_STRING(body, request.hostResponseBody().c_str());
+    TEST_ASSERT_EQUAL_STRING(body, replayed.hostResponseBody().c_str());
+}
+
+// Drains a response the way the TCP layer does, `chunk` bytes at a time.
+static size_t drain(AsyncAbstractResponse& response, char* out, size_t cap, size_t chunk) {
+    size_t len = 0;
+    while (len < cap) {
+        size_t n = response._fillBuffer((uint8_t*)out + len, chunk < cap - len ? chunk : cap - len);
+        if (n == 0) break;
+        len += n;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_writer_allocates_nothing() {
+    char buf[128];
+    startCounting();
+    JsonWriter json(buf, sizeof(buf));
+    json.beginObject();
+    json.field("ssid", "Nave \"2\"\\\n");
+    json.field("rssi", (int32_t)-61);
+    json.field("uptime", (uint32_t)4000000000u);
+    json.field("secure", true);
+    json.key("levels");
+    json.beginArray();
+    json.value((uint32_t)1);
+    json.value((uint32_t)2);
+    json.endArray();
+    json.endObject();
+    TEST_ASSERT_EQUAL_UINT32(0, stopCounting());
+    TEST_ASSERT_FALSE(json.overflowed());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"ssid\":\"Nave \\\"2\\\"\\\\\\u000a\",\"rssi\":-61,\"uptime\":4000000000,\"secure\":true,\"levels\":[1,2]}",
+        json.c_str());
+}
+
+static void test_writer_overflow_allocates_nothing() {
+    char buf[16];
+    startCounting();
+    JsonWriter json(buf, sizeof(buf));
+    json.beginObject();
+    json.field("ssid", "a network name that does not fit");
+    json.endObject();
+    TEST_ASSERT_EQUAL_UINT32(0, stopCounting());
+    TEST_ASSERT_TRUE(json.overflowed());
+    TEST_ASSERT_TRUE(json.length() < sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT32(json.length(), strlen(json.c_str()));
+}
+
+static void test_get_light_adds_no_allocations() {
+    restApi.applyLight(255, 128, 0, 80, 0, false);
+    assertGetAddsNoAllocations("/api/light");
+    TEST_ASSERT_EQUAL_STRING("{\"r\":255,\"g\":128,\"b\":0,\"intensity\":80}", body);
+}
+
+static void test_get_wifi_status_adds_no_allocations() {
+    static const HostNetwork NETWORKS[] = {
+        { "Laboratorio", -60, 6, WIFI_AUTH_WPA2_PSK },
+    };
+    WiFi.mode(WIFI_STA);
+    WiFi.hostSetNetworks(NETWORKS, 1);
+    TEST_ASSERT_TRUE(WiFi.begin("Laboratorio", "secreto") == WL_CONNECTED);
+    assertGetAddsNoAllocations("/api/wifi/status");
+    TEST_ASSERT_NOT_NULL(strstr(body, "\"status\":\"connected\""));
+    TEST_ASSERT_NOT_NULL(strstr(body, "\"ssid\":\"Laboratorio\""));
+}
+
+// GET /api/wifi/results: snapshot and stream the scan list
+static void test_scan_results_response_adds_no_allocations() {
+    static const HostNetwork NETWORKS[] = {
+        { "Invernadero \"Nave 1\"", -48, 1, WIFI_AUTH_WPA2_PSK },
+        { "Laboratorio", -60, 6, WIFI_AUTH_OPEN },
+        { "Almacen \\ 2.4GHz", -75, 11, WIFI_AUTH_WPA2_PSK },
+    };
+    WiFi.mode(WIFI_STA);
+    WiFi.hostSetNetworks(NETWORKS, 3);
+    WiFi.hostSetScanDuration(0);
+    static WifiScanService scan;
+    TEST_ASSERT_TRUE(scan.request(true) == WifiScanService::Request::STARTED);
+    while (!scan.hasResults()) {
+        scan.loop();
+        delay(1);
+    }
+    char expected[1536];
+    scan.writeJson(expected, sizeof(expected));
+
+    uint32_t base = baseResponseAllocations();
+
+    alignas(ScanResultsResponse) static uint8_t storage[sizeof(ScanResultsResponse)];
+    static char out[1536];
+    startCounting();
+    ScanResultsResponse* response = new (storage) ScanResultsResponse(scan);
+    drain(*response, out, sizeof(out) - 1, 64);
+    uint32_t count = stopCounting();
+    response->~ScanResultsResponse();
+
+    TEST_ASSERT_EQUAL_UINT32(base, count);
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_writer_allocates_nothing);
+    RUN_TEST(test_writer_overflow_allocates_nothing);
+    RUN_TEST(test_get_light_adds_no_allocations);
+    RUN_TEST(test_get_wifi_status_adds_no_allocations);
+    RUN_TEST(test_scan_results_response_adds_no_allocations);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+# PlatformIO pre-script that links the web UI into the firmware.
+#
+# Every file of data/ui_web is gzip-compressed and appended to one blob;
+# ui_bundle_data.h (generated in the build directory) holds that blob as a
+# const array plus an index of name, content type, strong ETag, offset and
+# length per asset. The ETag is a hash of the compressed bytes, i.e. of
+# exactly what the device sends. Output is deterministic (no timestamps),
+# so an unchanged UI neither changes ETags nor triggers a rebuild.
+#
+# Since the UI lives in flash, the filesystem image built by buildfs/uploadfs
+# no longer includes data/ui_web.
+
+Import("env")
+
+import gzip
+import hashlib
+import os
+import shutil
+
+FS_TARGETS = {"buildfs", "uploadfs", "uploadfsota"}
+UI_DIR = "ui_web"
+ETAG_LEN = 16
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+
+def bundle_source(ui_dir):
+    blob = bytearray()
+    index = []
+    raw_total = 0
+    for name in sorted(os.listdir(ui_dir)):
+        path = os.path.join(ui_dir, name)
+        if not os.path.isfile(path):
+            continue
+        with open(path, "rb") as f:
+            raw = f.read()
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        content_type = CONTENT_TYPES.get(os.path.splitext(name)[1], "application/octet-stream")
+        etag = hashlib.sha1(packed).hexdigest()[:ETAG_LEN]
+        index.append((name, content_type, etag, len(blob), len(packed)))
+        blob += packed
+        raw_total += len(raw)
+
+    lines = [
+        "// Generated by tools/compress_ui.py from data/%s. Do not edit." % UI_DIR,
+        "#pragma once",
+        "",
+        "static const uint8_t UI_BLOB[%d] = {" % max(len(blob), 1),
+    ]
+    for i in range(0, len(blob), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in blob[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("#define UI_ASSET_COUNT %d" % len(index))
+    lines.append("static const UiAsset UI_ASSETS[%d] = {" % max(len(index), 1))
+    for name, content_type, etag, offset, length in index:
+        lines.append('    { "%s", "%s", "\\"%s\\"", UI_BLOB + %d, %d },'
+                     % (name, content_type, etag, offset, length))
+    lines.append("};")
+    lines.append("")
+    print("compress_ui: %d assets, %d -> %d bytes" % (len(index), raw_total, len(blob)))
+    return "\n".join(lines)
+
+
+def write_if_changed(path, text):
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, "w") as f:
+        f.write(text)
+
+
+generated = os.path.join(env.subst("$BUILD_DIR"), "ui_bundle")
+os.makedirs(generated, exist_ok=True)
+write_if_changed(os.path.join(generated, "ui_bundle_data.h"),
+                 bundle_source(os.path.join(env.subst("$PROJECT_DATA_DIR"), UI_DIR)))
+env.Append(CPPPATH=[generated])
+
+if FS_TARGETS & set(COMMAND_LINE_TARGETS):
+    staged = os.path.join(env.subst("$BUILD_DIR"), "data")
+    shutil.rmtree(staged, ignore_errors=True)
+    shutil.copytree(env.subst("$PROJECT_DATA_DIR"), staged, ignore=shutil.ignore_patterns(UI_DIR))
+    env.Replace(PROJECT_DATA_DIR=staged)
@@ -0,0 +1,136 @@
+# Generates src/i18n_strings.h from the web UI translations.
+#
+# data/ui_web/<lang>.json is the single list of UI strings: the web UI
+# fetches the files as they are, and the firmware gets them as a TrKey enum
+# plus one constexpr table of C strings per language, so tr() is an array
+# index. Every language must define exactly the same keys; a key missing
+# from one file fails the build.
+#
+# The HD44780 LCD has no UTF-8, so the keys it prints (LCD_PREFIXES) are
+# reduced to ASCII in the tables: accents are dropped ("Español" becomes
+# "Espanol") and any other non-ASCII character fails the build.
+#
+# Runs as a PlatformIO pre-script and standalone (python tools/gen_i18n.py).
+# The header is committed and only rewritten when its content changes.
+
+import json
+import os
+import re
+import sys
+import unicodedata
+
+LANGS = ["es", "en"]  # File names; the first one is the default (Lang 0)
+UI_DIR = os.path.join("data", "ui_web")
+OUTPUT = os.path.join("src", "i18n_strings.h")
+LCD_PREFIXES = ("home.", "menu.", "lang.")
+
+
+def enum_name(key):
+    return "TR_" + re.sub(r"[^0-9A-Za-z]+", "_", key).upper()
+
+
+def lcd_text(value):
+    # Decomposes accented letters and drops the accents; None if anything
+    # non-ASCII is left
+    text = "".join(ch for ch in unicodedata.normalize("NFKD", value) if not unicodedata.combining(ch))
+    return text if all(ord(ch) < 0x80 for ch in text) else None
+
+
+def c_string(value):
+    out = ['"']
+    for ch in value.encode("utf-8"):
+        if ch in (0x22, 0x5C):
+            out.append("\\" + chr(ch))
+        elif ch < 0x20 or ch >= 0x7F:
+            out.append("\\%03o" % ch)  # Octal cannot run into the next character
+        else:
+            out.append(chr(ch))
+    out.append('"')
+    return "".join(out)
+
+
+def load(project_dir):
+    tables = {}
+    for lang in LANGS:
+        with open(os.path.join(project_dir, UI_DIR, lang + ".json"), encoding="utf-8") as f:
+            tables[lang] = json.load(f)
+
+    keys = sorted(tables[LANGS[0]])
+    errors = []
+    for lang in LANGS[1:]:
+        for key in sorted(set(keys) - set(tables[lang])):
+            errors.append("%s.json is missing \"%s\"" % (lang, key))
+        for key in sorted(set(tables[lang]) - set(keys)):
+            errors.append("%s.json is missing \"%s\"" % (LANGS[0], key))
+    for lang in LANGS:
+        for key in keys:
+            if not key.startswith(LCD_PREFIXES) or key not in tables[lang]:
+                continue
+            text = lcd_text(tables[lang][key])
+            if text is None:
+                errors.append("%s.json: \"%s\" is shown on the LCD and must be ASCII once accents are dropped"
+                              % (lang, key))
+            else:
+                tables[lang][key] = text
+    names = {}
+    for key in keys:
+        other = names.setdefault(enum_name(key), key)
+        if other != key:
+            errors.append("\"%s\" and \"%s\" map to the same enum name" % (other, key))
+    return keys, tables, errors
+
+
+def header_source(keys, tables):
+    lines = [
+        "// Generated by tools/gen_i18n.py from %s/{%s}.json. Do not edit."
+        % (UI_DIR.replace(os.sep, "/"), ",".join(LANGS)),
+        "#pragma once",
+        "",
+        "#include <stdint.h>",
+        "",
+        "enum Lang : uint8_t { %s };" % ", ".join(lang.upper() for lang in LANGS),
+        "#define LANG_COUNT %d" % len(LANGS),
+        "",
+        "enum TrKey : uint16_t {",
+    ]
+    lines += ["    %s," % enum_name(key) for key in keys]
+    lines += ["    TR_KEY_COUNT", "};", ""]
+    for lang in LANGS:
+        lines.append("static constexpr const char* TR_%s[TR_KEY_COUNT] = {" % lang.upper())
+        lines += ["    %s," % c_string(tables[lang][key]) for key in keys]
+        lines += ["};", ""]
+    lines.append("static constexpr const char* const* TR_TABLES[LANG_COUNT] = { %s };"
+                 % ", ".join("TR_" + lang.upper() for lang in LANGS))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def write_if_changed(path, text):
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == text:
+                return False
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+    return True
+
+
+def generate(project_dir):
+    keys, tables, errors = load(project_dir)
+    if errors:
+        for error in errors:
+            sys.stderr.write("gen_i18n: %s\n" % error)
+        sys.exit(1)
+    if write_if_changed(os.path.join(project_dir, OUTPUT), header_source(keys, tables)):
+        print("gen_i18n: %d keys, %d languages -> %s" % (len(keys), len(LANGS), OUTPUT))
+
+
+try:
+    Import("env")
+except NameError:  # Standalone
+    env = None
+
+if env is not None:
+    generate(env.subst("$PROJECT_DIR"))
+else:
+    generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
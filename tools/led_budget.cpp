@@ -0,0 +1,45 @@
+// Host-side check of LED frame budgets, no hardware needed.
+//
+//   g++ -std=c++11 -Isrc -DLED_OUTPUT_COUNT=4 tools/led_budget.cpp src/drivers/segment.cpp -o led_budget
+//   ./led_budget 0:150:0 150:150:1 300:200:2
+//
+// Each argument is start:length:output for one segment.
+#include <stdio.h>
+#include <stdlib.h>
+#include "drivers/led_timing.h"
+
+int main(int argc, char** argv) {
+    SegmentLayout layout = {};
+    for (int i = 1; i < argc && layout.count < MAX_SEGMENTS; i++) {
+        unsigned start, length, output = 0;
+        if (sscanf(argv[i], "%u:%u:%u", &start, &length, &output) < 2) {
+            fprintf(stderr, "bad segment '%s' (expected start:length[:output])\n", argv[i]);
+            return 2;
+        }
+        SegmentConfig& seg = layout.segments[layout.count++];
+        seg.start = start;
+        seg.length = length;
+        seg.output = output;
+    }
+    if (layout.count == 0) {
+        defaultLayout(layout);
+    }
+    if (!isValidLayout(layout)) {
+        fprintf(stderr, "invalid layout for %d output(s)\n", LED_OUTPUT_COUNT);
+        return 2;
+    }
+
+    OutputRange ranges[LED_OUTPUT_COUNT];
+    layoutOutputs(layout, ranges);
+    for (int i = 0; i < LED_OUTPUT_COUNT; i++) {
+        printf("output %d: %4u px @ %4u  %6lu us\n", i, ranges[i].count, ranges[i].offset,
+               (unsigned long)outputFrameUs(ranges[i].count));
+    }
+
+    unsigned long budget = frameBudgetUs(LED_FRAME_RATE_HZ);
+    unsigned long serial = serialFrameUs(layout);
+    unsigned long parallel = parallelFrameUs(layout);
+    printf("single pin: %6lu us\nparallel:   %6lu us\nbudget:     %6lu us (%d Hz)\n",
+           serial, parallel, budget, LED_FRAME_RATE_HZ);
+    return parallel <= budget ? 0 : 1;
+}